@@ -1,4 +1,6 @@
 #include"CoordinateConverter.h"
+#include "CoordinateConverterT.h"
+#include "smallmatrix.h"
 #include <QtDebug>
 #define KMS_PER_GEO_DEGREE 108.0
 
@@ -9,8 +11,11 @@ CoordinateConverter::CoordinateConverter(double lat, double lon, double alt )
 	refpt_alt = alt;
 
 	degorradians = 0;
+	geodeticsolver = GEODETIC_SOLVER_BOWRING;
 
-	esq = 0.00669437999013;     re  = 6378137.0;
+	esq = WGS84_ESQ;     re  = WGS84_RE;
+
+	computelp();
 }
 
 
@@ -21,6 +26,8 @@ void CoordinateConverter::setlp(double lat, double lon, double alt)
 	refpt_alt = alt;
 
 	degorradians = 0;
+
+	computelp();
 }
 
 int CoordinateConverter::getlp(double* lat, double* lon, double* alt)
@@ -32,6 +39,49 @@ int CoordinateConverter::getlp(double* lat, double* lon, double* alt)
 	return 0;
 }
 
+//-----------------------------------------------------------------------------
+/* Rebuilds the bound-origin terms for the current reference point (degrees).
+   Called once per setlp() so that the *_lp conversions avoid all trig. */
+void CoordinateConverter::computelp()
+{
+	double lat = degrees2rad(refpt_lat);
+	double lon = degrees2rad(refpt_lon);
+	double slat = sin(lat), clat = cos(lat);
+	double slon = sin(lon), clon = cos(lon);
+	double w = 1.0 - esq*slat*slat;
+
+	lp_rn = re/sqrt(w);
+	lp_rm = re*(1.0-esq)/(w*sqrt(w));
+
+	lp_ecef[0] = (lp_rn+refpt_alt)*clat*clon;
+	lp_ecef[1] = (lp_rn+refpt_alt)*clat*slon;
+	lp_ecef[2] = ((1.0-esq)*lp_rn+refpt_alt)*slat;
+
+	// Same terms as env_ecef(), columns are the East, North and Vertical unit vectors
+	lp_rot[0][0] = -slon;	lp_rot[0][1] = -slat*clon;	lp_rot[0][2] = clat*clon;
+	lp_rot[1][0] =  clon;	lp_rot[1][1] = -slat*slon;	lp_rot[1][2] = clat*slon;
+	lp_rot[2][0] =  0.0;	lp_rot[2][1] =  clat;		lp_rot[2][2] = slat;
+}
+
+void CoordinateConverter::env2ecef_lp(double x_env, double y_env, double z_env, double *x_ecef, double *y_ecef, double *z_ecef)
+{
+	*x_ecef = lp_ecef[0] + lp_rot[0][0]*x_env + lp_rot[0][1]*y_env + lp_rot[0][2]*z_env;
+	*y_ecef = lp_ecef[1] + lp_rot[1][0]*x_env + lp_rot[1][1]*y_env + lp_rot[1][2]*z_env;
+	*z_ecef = lp_ecef[2] + lp_rot[2][0]*x_env + lp_rot[2][1]*y_env + lp_rot[2][2]*z_env;
+}
+
+void CoordinateConverter::ecef2env_lp(double x_ecef, double y_ecef, double z_ecef, double *x_env, double *y_env, double *z_env)
+{
+	double x = x_ecef - lp_ecef[0];
+	double y = y_ecef - lp_ecef[1];
+	double z = z_ecef - lp_ecef[2];
+
+	// Transpose of the ENV -> ECEF rotation
+	*x_env = lp_rot[0][0]*x + lp_rot[1][0]*y + lp_rot[2][0]*z;
+	*y_env = lp_rot[0][1]*x + lp_rot[1][1]*y + lp_rot[2][1]*z;
+	*z_env = lp_rot[0][2]*x + lp_rot[1][2]*y + lp_rot[2][2]*z;
+}
+
 
 
 
@@ -94,18 +144,10 @@ bool CoordinateConverter::getEarthLocalRadius(double lat_in_rad , double &r)
    Y(NORTH) AND Z(VERTICAL))  in ECEF */
 void CoordinateConverter::env_ecef(double x_env,double y_env,double z_env,double *x_ecef,double *y_ecef,double *z_ecef,double lat_env,double lon_env, int angletype)
 {
-
-	if ( angletype == 0 )  // input lat , lon are in degrees. convert it to radians before proceeding
-	{
-		lat_env = degrees2rad(lat_env);
-		lon_env = degrees2rad(lon_env);
-	}
-
-	*x_ecef= cos(lat_env)*cos(lon_env)*z_env-sin(lon_env)*x_env-sin(lat_env)*cos(lon_env)*y_env;
-        *y_ecef= cos(lat_env)*sin(lon_env)*z_env+cos(lon_env)*x_env-sin(lat_env)*sin(lon_env)*y_env;
-	*z_ecef= sin(lat_env)*z_env+cos(lat_env)*y_env;
-
-    return;
+	if ( angletype == 0 )  // input lat , lon are in degrees
+		CoordConvDeg::env_ecef(x_env, y_env, z_env, x_ecef, y_ecef, z_ecef, lat_env, lon_env);
+	else
+		CoordConvRad::env_ecef(x_env, y_env, z_env, x_ecef, y_ecef, z_ecef, lat_env, lon_env);
 }/* end of env_ecef */
 
 
@@ -114,18 +156,10 @@ void CoordinateConverter::env_ecef(double x_env,double y_env,double z_env,double
 
 void CoordinateConverter::ecef_env(double *x_env,double *y_env,double *z_env,double x_ecef,double y_ecef,double z_ecef,double lat_env,double lon_env, int angletype)
 {
-
-	if ( angletype == 0 )  // input lat , lon are in degrees. convert it to radians before proceeding
-	{
-		lat_env = degrees2rad(lat_env);
-		lon_env = degrees2rad(lon_env);
-	}
-
-	*x_env= -sin(lon_env)*x_ecef+y_ecef*cos(lon_env);
-    *y_env= -sin(lat_env)*cos(lon_env)*x_ecef-sin(lat_env)*sin(lon_env)*y_ecef+z_ecef*cos(lat_env);
-	*z_env=  cos(lat_env)*cos(lon_env)*x_ecef+cos(lat_env)*sin(lon_env)*y_ecef+sin(lat_env)*z_ecef;
-
-    return;
+	if ( angletype == 0 )  // input lat , lon are in degrees
+		CoordConvDeg::ecef_env(x_env, y_env, z_env, x_ecef, y_ecef, z_ecef, lat_env, lon_env);
+	else
+		CoordConvRad::ecef_env(x_env, y_env, z_env, x_ecef, y_ecef, z_ecef, lat_env, lon_env);
 }/* end of ecef_env */
 
 //-----------------------------------------------------------------------------
@@ -144,53 +178,20 @@ void CoordinateConverter::ecef_env(double *x_env,double *y_env,double *z_env,dou
 
 int CoordinateConverter::ecef2env(double *x_env,double *y_env,double *z_env,double x_ecef,double y_ecef,double z_ecef,double lat_env,double lon_env,double h , int angletype)
 {
+	if ( angletype == 0 )  // input lat , lon are in degrees
+		CoordConvDeg::ecef2env(x_env, y_env, z_env, x_ecef, y_ecef, z_ecef, lat_env, lon_env, h);
+	else
+		CoordConvRad::ecef2env(x_env, y_env, z_env, x_ecef, y_ecef, z_ecef, lat_env, lon_env, h);
 
-
-/*
-
-	if ( angletype == 1 )  // input lat , lon are in degrees. convert it to radians before proceeding
-	{
-		lat_env = rad2degrees(lat_env);
-		lon_env = rad2degrees(lon_env);
-	}
-
- ecef2envspherical(x_ecef, y_ecef , z_ecef, lat_env,  lon_env,  x_env,  y_env,  z_env);
- *z_env = *z_env + h;
-*/
-
-
-//printf("inside function ecef2env     %lf  %lf   %lf   %lf   %lf   %lf  " , x_ecef , y_ecef , z_ecef , lat_env , lon_env , h);
-	double x,y,z,x_lp,y_lp,z_lp, r_lamda;
-
-//	double major_axis = 6378135.00 , minor_axis = 6356750.00 , f , ecc;
-
-	if ( angletype == 0 )  // input lat , lon are in degrees. convert it to radians before proceeding
-	{
-		lat_env = degrees2rad(lat_env);
-		lon_env = degrees2rad(lon_env);
-	}
-
-//printf("\ninside ecef to env function X = %20.10lf, Y=%20.10lf, Z = %20.10lf , \n lat = %20.10lf , lon = %20.10lf, alt = %lf \n" , x_ecef , y_ecef , z_ecef , lat_env , lon_env , h);
-	r_lamda=re/sqrt((1.0-esq*sin(lat_env)*sin(lat_env)));
-
-	//  convertion of lat long (in radians) to ecef(in meters)
-
-	x_lp=(r_lamda+h)*cos(lat_env)*cos(lon_env);
-	y_lp=(r_lamda+h)*cos(lat_env)*sin(lon_env);
-	z_lp=((1.0-esq)*r_lamda+h)*sin(lat_env);
-
-	x=x_ecef-x_lp;
-	y=y_ecef-y_lp;
-	z=z_ecef-z_lp;
-
-//printf("\nSending params : x=%lf , y=%lf , z = %lf , lat = %lf , lon = %lf " , x,y,z,lat_env,lon_env );
-	ecef_env(x_env,y_env,z_env,x,y,z,lat_env,lon_env , 1);
-
-
-//printf("\ninside fn: x = %lf, y = %lf, z = %lf " , *x_env , *y_env , *z_env );
 	return 1;
 }// end of ecef2env
 
+/* Single precision version, lat , lon in degrees */
+void CoordinateConverter::ecef2env(float *x_env, float *y_env, float *z_env, float x_ecef, float y_ecef, float z_ecef, float lat_env, float lon_env, float h )
+{
+	CoordConvDegF::ecef2env(x_env, y_env, z_env, x_ecef, y_ecef, z_ecef, lat_env, lon_env, h);
+}
+
 
 
 
@@ -255,36 +256,20 @@ void ecef2env(double *x_env,double *y_env,double *z_env,double x_ecef,double y_e
 
 int CoordinateConverter::env2ecef(double x_env,double y_env,double z_env,double *x_ecef,double *y_ecef,double *z_ecef,double lat_env,double lon_env,double h , int angletype)
 {
-	double x,y,z,x_lp,y_lp,z_lp;
-	double r_lamda;
-
-
-	if ( angletype == 0 )  // input lat , lon are in degrees. convert it to radians before proceeding
-	{
-		lat_env = degrees2rad(lat_env);
-		lon_env = degrees2rad(lon_env);
-	}
-
-//printf("\nx = %20.10lf , y = %20.10lf , z = %20.10lf , lat = %20.10lf , lon = %20.10lf \n", x_env,y_env,z_env ,  lat_env , lon_env );
-
-
-	/*   convertion of lat long in radians to x y z in ecef */
-	r_lamda=re/sqrt((1.0-esq*sin(lat_env)*sin(lat_env)));
-	x_lp=(r_lamda+h)*cos(lat_env)*cos(lon_env);y_lp=(r_lamda+h)*cos(lat_env)*sin(lon_env);z_lp=((1.0-esq)*r_lamda+h)*sin(lat_env);
-
-	env_ecef(x_env,y_env,z_env,&x,&y,&z,lat_env,lon_env , 1);
-
-//printf("\n Intermediate values x = %lf , y = %lf , z = %lf \n " , x , y , z );
-
-
-	*x_ecef= x+x_lp;
-	*y_ecef= y+y_lp;
-	*z_ecef= z+z_lp;
-
+	if ( angletype == 0 )  // input lat , lon are in degrees
+		CoordConvDeg::env2ecef(x_env, y_env, z_env, x_ecef, y_ecef, z_ecef, lat_env, lon_env, h);
+	else
+		CoordConvRad::env2ecef(x_env, y_env, z_env, x_ecef, y_ecef, z_ecef, lat_env, lon_env, h);
 
 	return 1;
 }  // end of env2ecef
 
+/* Single precision version, lat , lon in degrees */
+void CoordinateConverter::env2ecef(float x_env,float y_env,float z_env,float *x_ecef,float *y_ecef,float *z_ecef,float lat_env,float lon_env,float h )
+{
+	CoordConvDegF::env2ecef(x_env, y_env, z_env, x_ecef, y_ecef, z_ecef, lat_env, lon_env, h);
+}
+
 
 
 //-----------------------------------------------------------------------------
@@ -295,16 +280,8 @@ int CoordinateConverter::env2ecef(double x_env,double y_env,double z_env,double
 */
 int CoordinateConverter::env2polar(double *r,  double *azm, double *elv,  double x_env,double y_env,double z_env)
 {
-
-    *elv=0;     *azm = 0.0;   *r = 0.0;
-
-    *r = sqrt(x_env*x_env+y_env*y_env+z_env*z_env);
-    if (z_env!=0) *elv= atan2(z_env,sqrt(x_env*x_env+y_env*y_env));
-    *azm= atan2(x_env,y_env);/* x_env/y_env .. because azimuth is defined
-      from north */
-*azm = rad2degrees( *azm );
-if ( *azm < 0.0 ) *azm = *azm + 360.0;
-*elv = rad2degrees(*elv);
+    // azimuth is defined from north, output angles are in degrees
+    CoordConvDeg::env2polar(r, azm, elv, x_env, y_env, z_env);
 
     return 1;
 }/* end of env2polar */
@@ -317,17 +294,10 @@ if ( *azm < 0.0 ) *azm = *azm + 360.0;
 */
 int CoordinateConverter::polar2env(double r, double azm, double elv, double *x_env,double *y_env,double *z_env , int angletype)
 {
-//printf("\n R = %lf , theta = %lf , phi = %lf \n" , r , azm , elv );
-	if ( angletype == 0 )  // input lat , lon are in degrees. convert it to radians before proceeding
-	{
-		azm = degrees2rad(azm);
-		elv = degrees2rad(elv);
-	}
-
-	*x_env = r*cos(elv)*sin(azm);/* because azimuth is defined
-	                                from north(y axis) */
-	*y_env = r*cos(elv)*cos(azm);
-	*z_env = r*sin(elv);
+	if ( angletype == 0 )  // input azm , elv are in degrees
+		CoordConvDeg::polar2env(r, azm, elv, x_env, y_env, z_env);
+	else
+		CoordConvRad::polar2env(r, azm, elv, x_env, y_env, z_env);
 
 	return 1;
 }/* end of polar2env */
@@ -335,19 +305,10 @@ int CoordinateConverter::polar2env(double r, double azm, double elv, double *x_e
 //-----------------------------------------------------------------------------
 int CoordinateConverter::geodetic2ecef(double lat, double lon, double alt, double* x,double* y, double* z, int angletype)
 {
-
-        double r_lamda;
-
-	if ( angletype == 0 )  // input lat , lon are in degrees. convert it to radians before proceeding
-	{
-		lat = degrees2rad(lat);
-		lon = degrees2rad(lon);
-	}
-
-        r_lamda=re/sqrt((1.0-esq*sin(lat)*sin(lat)));
-        *x=(r_lamda+alt)*cos(lat)*cos(lon);
-        *y=(r_lamda+alt)*cos(lat)*sin(lon);
-	*z=(((1.0-esq)*r_lamda)+alt)*sin(lat);
+	if ( angletype == 0 )  // input lat , lon are in degrees
+		CoordConvDeg::geodetic2ecef(lat, lon, alt, x, y, z);
+	else
+		CoordConvRad::geodetic2ecef(lat, lon, alt, x, y, z);
 
 return 1;
 }
@@ -358,57 +319,41 @@ return 1;
 //-----------------------------------------------------------------------------
 int CoordinateConverter::geodetic2ecef(float lat, float lon, float alt, float* x,float* y, float* z, int angletype)
 {
-
-        float r_lamda;
-
-        if ( angletype == 0 )  // input lat , lon are in degrees. convert it to radians before proceeding
-        {
-                lat = degrees2rad(lat);
-                lon = degrees2rad(lon);
-        }
-
-        r_lamda=re/sqrt((1.0-esq*sin(lat)*sin(lat)));
-        *x=(r_lamda+alt)*cos(lat)*cos(lon);
-        *y=(r_lamda+alt)*cos(lat)*sin(lon);
-        *z=(((1.0-esq)*r_lamda)+alt)*sin(lat);
+	// Runs entirely in single precision
+	if ( angletype == 0 )  // input lat , lon are in degrees
+		CoordConvDegF::geodetic2ecef(lat, lon, alt, x, y, z);
+	else
+		CoordConvRadF::geodetic2ecef(lat, lon, alt, x, y, z);
 
 return 1;
 }
 
 //-----------------------------------------------------------------------------
 
-/*   GCS cartesian to geodetic (latitude, longitude) */
+/*   GCS cartesian to geodetic (latitude, longitude), output in degrees */
 int CoordinateConverter::ecef2geodetic(double x, double y, double z, double* lat, double* lon, double* alt )
 {
-double a = re;
-//double f = 298.257223563;
-double b = 6356752.3142;   // Polar Radius of Earth
-double e1 = esq;
-double e2 = 0.00673949674226;     // ????????????
-double rlamda,p,theta;
-double tan1,tan2,tan3;
+if ( geodeticsolver == GEODETIC_SOLVER_VERMEILLE )
+	return ecef2geodetic_vermeille( x, y, z, lat, lon, alt );
 
+return ecef2geodetic_bowring( x, y, z, lat, lon, alt );
+}
 
+/*   Bowring's single-step approximation. Longitude comes from atan(y/x), callers
+     such as env2geodetic() fix up the quadrant beyond +/-90 degrees */
+int CoordinateConverter::ecef2geodetic_bowring(double x, double y, double z, double* lat, double* lon, double* alt )
+{
+CoordConvDeg::ecef2geodetic_bowring( x, y, z, lat, lon, alt );
 
-p = sqrt((x*x) + (y*y));
-tan1 = (z*a)/(p*b);
-tan2 = (y/x);
-theta = atan(tan1);
-tan3 = (z + e2*b*sin(theta)*sin(theta)*sin(theta))/(p - e1*a*cos(theta)*cos(theta)*cos(theta));
-
-
-*lon = atan(tan2);
-*lat = atan(tan3);
-
-rlamda=a/sqrt((1.0-e1*sin(*lat)*sin(*lat)));
-*alt = (p/cos(*lat)) - rlamda;
-
-
-*lat = rad2degrees(*lat);
-*lon = rad2degrees(*lon);
+return 1;
+}
 
-//if (*lat < 0.0)          *lat += 180.0;
-//if (*lon < 0.0)          *lon += 180.0;
+/*   Exact closed-form solution (H. Vermeille, "Direct transformation from geocentric
+     coordinates to geodetic coordinates", J. Geodesy 2002). Fixed cost: one cbrt and
+     four sqrt, no iteration. Valid everywhere except within ~43 km of the earth's centre. */
+int CoordinateConverter::ecef2geodetic_vermeille(double x, double y, double z, double* lat, double* lon, double* alt )
+{
+CoordConvDeg::ecef2geodetic_vermeille( x, y, z, lat, lon, alt );
 
 return 1;
 }
@@ -428,23 +373,79 @@ env2ecef( x_env, y_env, z_env, &a, &b , &c , lat_env, lon_env, h , angletype);
 
 ecef2geodetic( a,  b, c , lat, lon, alt );
 
-if ( (lon_env + metersToDegrees(x_env) ) >= 90.0 )
+// Bowring's longitude comes from atan(y/x); Vermeille's atan2 is already in the right quadrant
+if ( geodeticsolver == GEODETIC_SOLVER_BOWRING )
 {
-    if ( *lon < 0 )
+    if ( (lon_env + metersToDegrees(x_env) ) >= 90.0 )
     {
-        *lon += 180.0;
+        if ( *lon < 0 )
+        {
+            *lon += 180.0;
+        }
+    }
+    else if ( (lon_env + metersToDegrees(x_env) ) <= -90.0 )
+    {
+        if ( *lon > 0 )
+        {
+            *lon = *lon - 180.0;
+        }
     }
 }
-else if ( (lon_env + metersToDegrees(x_env) ) <= -90.0 )
+
+return 1;
+
+}
+
+int CoordinateConverter::env2geodetic_lp(double x_env, double y_env, double z_env, double *lat, double *lon, double *alt)
+{
+double  a,b,c;
+
+env2ecef_lp( x_env, y_env, z_env, &a, &b, &c );
+
+ecef2geodetic( a, b, c, lat, lon, alt );
+
+// Same longitude quadrant correction as env2geodetic(), Bowring only
+if ( geodeticsolver == GEODETIC_SOLVER_BOWRING )
 {
-    if ( *lon > 0 )
+    if ( (refpt_lon + metersToDegrees(x_env) ) >= 90.0 )
     {
-        *lon = *lon - 180.0;
+        if ( *lon < 0 )
+        {
+            *lon += 180.0;
+        }
+    }
+    else if ( (refpt_lon + metersToDegrees(x_env) ) <= -90.0 )
+    {
+        if ( *lon > 0 )
+        {
+            *lon = *lon - 180.0;
+        }
     }
 }
 
 return 1;
+}
+
+int CoordinateConverter::geodetic2env_lp(double lat, double lon, double alt, double *x_env, double *y_env, double *z_env, int angletype)
+{
+double  x,y,z;
+
+geodetic2ecef( lat, lon, alt, &x, &y, &z, angletype );
+
+ecef2env_lp( x, y, z, x_env, y_env, z_env );
 
+return 1;
+}
+
+int CoordinateConverter::polar2geodetic_lp(double r, double azm, double elv, double *lat, double *lon, double *alt, int angletype)
+{
+double x,y,z;
+
+polar2env( r, azm, elv, &x, &y, &z, angletype );
+
+env2geodetic_lp( x, y, z, lat, lon, alt );
+
+return 1;
 }
 
 double CoordinateConverter::metersToDegrees( double meters )
@@ -695,68 +696,97 @@ return 1;
 
 void CoordinateConverter :: cov_pos_polar2env(double var_env[][3],double r,double ele,double azi,double var_plr[][3])
 {
-        Cmatrix mat;
-        int Row,Col;
-        double JT[MAXCOLS][MAXCOLS],temp[MAXCOLS][MAXCOLS];
-        //IV&V Bug No - 535,537
-        for(Row = 0;Row < MAXCOLS;Row++)
-        {
-                for(Col = 0;Col < MAXCOLS;Col++)
-                {
-                        JT[Row][Col]= 0.0;
-                        temp[Row][Col]= 0.0;
-                }
-        }
-        double J[MAXCOLS][MAXCOLS]={cos(ele)*sin(azi),-r*sin(ele)*sin(azi),r*cos(ele)*cos(azi),
-                                        cos(ele)*cos(azi),-r*sin(ele)*cos(azi),-r*cos(ele)*sin(azi),
-                                        sin(ele),r*cos(ele),0};
-        mat.mat_transpose(*J,*JT,3,3);
-        mat.mat_mul(*var_plr,*JT,*temp,3,3,3);
-        mat.mat_mul(*J,*temp,*var_env,3,3,3);
+        double sele = sin(ele), cele = cos(ele);
+        double sazi = sin(azi), cazi = cos(azi);
+
+        // Jacobian of polar2env with respect to (r, ele, azi)
+        Mat3d J = {{{cele*sazi, -r*sele*sazi,  r*cele*cazi},
+                    {cele*cazi, -r*sele*cazi, -r*cele*sazi},
+                    {sele,       r*cele,       0.0}}};
+
+        propagate(J, Mat3d::fromArray(*var_plr)).toArray(*var_env);
 }
 
 void  CoordinateConverter :: cov_pos_env2ecef(double var_ecef[][3],double lat_env,double lon_env,double var_ENV[][3])
 {
-        Cmatrix mat;
-        int Row,Col;/* ASP_IVV  01/12/16  12:00:00  */
+        double slat = sin(lat_env), clat = cos(lat_env);
+        double slon = sin(lon_env), clon = cos(lon_env);
 
-        Row = 3;
-        Col = 3;
-        double JT[MAXCOLS][MAXCOLS],temp[MAXCOLS][MAXCOLS];
-        //IV&V Bug No - 538 & 539
-        for(Row = 0;Row < MAXCOLS;Row++)
-        {
-                for(Col = 0;Col < MAXCOLS;Col++)
-                {
-                        JT[Row][Col]= 0.0;
-                        temp[Row][Col]= 0.0;
-                }
-        } 
+        // ENV -> ECEF rotation at (lat_env, lon_env) in radians
+        Mat3d J = {{{-slon, -slat*clon, clat*clon},
+                    { clon, -slat*slon, clat*slon},
+                    { 0.0,   clat,      slat}}};
 
-        double J[MAXCOLS][MAXCOLS]= {-sin(lon_env),-sin(lat_env)*cos(lon_env),cos(lat_env)*cos(lon_env),
-                                        cos(lon_env),-sin(lat_env)*sin(lon_env), cos(lat_env)*sin(lon_env),
-                                        0,cos(lat_env),sin(lat_env)};
-        mat.mat_transpose(*J,*JT,3,3);
-        mat.mat_mul(*var_ENV,*JT,*temp,3,3,3);
-        mat.mat_mul(*J,*temp,*var_ecef,3,3,3);
+        propagate(J, Mat3d::fromArray(*var_ENV)).toArray(*var_ecef);
 }
 
 void CoordinateConverter :: cov_pos_ecef2env(double latdeg,double londeg,double *cov_ecef,double *cov_env)
 {
-        Cmatrix mat;
         double latrad,lonrad;
         latrad = latdeg *(PI/180.0);
         lonrad = londeg *(PI/180.0);
+        double slat = sin(latrad), clat = cos(latrad);
+        double slon = sin(lonrad), clon = cos(lonrad);
 
-        double Jmatrix[3][3] = {-sin(lonrad),-sin(latrad)*cos(lonrad),cos(latrad)*cos(lonrad),
-                                cos(lonrad),-sin(latrad)*sin(lonrad),cos(latrad)*sin(lonrad),
-                                0,          cos(latrad),             sin(latrad)};
+        Mat3d J = {{{-slon, -slat*clon, clat*clon},
+                    { clon, -slat*slon, clat*slon},
+                    { 0.0,   clat,      slat}}};
 
+        propagateTransposed(J, Mat3d::fromArray(cov_ecef)).toArray(cov_env);
+}
 
-        double temp[3][3],Jtrans[3][3];
-        mat.mat_transpose(*Jmatrix,*Jtrans,3,3);
-        mat.mat_mul(*Jtrans,cov_ecef,*temp,3,3,3);      
-        mat.mat_mul(*temp,*Jmatrix,cov_env,3,3,3);
+/* Polar measurement noise (diagonal: var_r m^2, var_ele and var_azi rad^2) propagated to ENV
+   for n points at once. The Jacobian columns are rebuilt from the ENV position itself
+   (sin/cos of azimuth and elevation are ratios of x, y, z):
+     d/dr   = (x, y, z) / r
+     d/dele = (-z x / rh, -z y / rh, rh)
+     d/dazi = (y, -x, 0)                      with rh = sqrt(x^2 + y^2)
+   Only products of the columns are needed, so rh appears squared and the loop has no
+   trig, no sqrt and no branches, which lets the compiler vectorise it. */
+void CoordinateConverter :: cov_pos_polar2env_batch(int n, const double *x_env, const double *y_env, const double *z_env,
+                                                    double var_r, double var_ele, double var_azi, double *cov_env)
+{
+        for (int i = 0; i < n; i++)
+        {
+                double x = x_env[i], y = y_env[i], z = z_env[i];
+                double rh2 = x*x + y*y;
+                double r2 = rh2 + z*z;
+                double kr = var_r/(r2 > 1.0e-12 ? r2 : 1.0e-12);
+                double ke = var_ele*z*z/(rh2 > 1.0e-12 ? rh2 : 1.0e-12);
+                double *c = cov_env + 6*i;
+
+                c[0] = kr*x*x + ke*x*x + var_azi*y*y;
+                c[1] = kr*x*y + ke*x*y - var_azi*x*y;
+                c[2] = kr*x*z - var_ele*x*z;
+                c[3] = kr*y*y + ke*y*y + var_azi*x*x;
+                c[4] = kr*y*z - var_ele*y*z;
+                c[5] = kr*z*z + var_ele*rh2;
+        }
+}
+
+/* ENV position covariance to geodetic (longitude, latitude in degrees, altitude in meters)
+   around the bound reference point. Over a radar coverage the radii of curvature and the
+   latitude are those of the reference point, which keeps the kernel free of trig. */
+void CoordinateConverter :: cov_pos_env2geodetic_lp_batch(int n, const double *alt, const double *cov_env, double *cov_geo)
+{
+        double rad2deg = 180.0/PI;
+        double coslat = lp_rot[2][1];           // cos(refpt_lat)
+        double rn = lp_rn, rm = lp_rm;
+
+        for (int i = 0; i < n; i++)
+        {
+                double klon = rad2deg/((rn + alt[i])*coslat);
+                double klat = rad2deg/(rm + alt[i]);
+                const double *c = cov_env + 6*i;
+                double *g = cov_geo + 6*i;
+
+                g[0] = klon*klon*c[0];
+                g[1] = klon*klat*c[1];
+                g[2] = klon*c[2];
+                g[3] = klat*klat*c[3];
+                g[4] = klat*c[4];
+                g[5] = c[5];
+        }
 }
 
 
@@ -10,6 +10,20 @@
 #define PI (4.0*atan(1.0))
 #define MAXCOLS 3
 
+// WGS-84 terms, shared with TCoordinateConverter
+#define WGS84_RE  6378137.0          // equatorial radius (m)
+#define WGS84_ESQ 0.00669437999013   // first eccentricity squared
+#define WGS84_RB  6356752.3142       // polar radius (m)
+#define WGS84_EP2 0.00673949674226   // second eccentricity squared
+
+/**
+ * @brief Solver used by ecef2geodetic()
+ */
+enum eGeodeticSolver {
+    GEODETIC_SOLVER_BOWRING = 0,     //!< Single-step Bowring approximation (original)
+    GEODETIC_SOLVER_VERMEILLE = 1    //!< Exact closed-form solution (Vermeille, J. Geodesy 2002)
+};
+
 class CoordinateConverter
 {
 
@@ -17,6 +31,14 @@ class CoordinateConverter
  	double esq ,re ;
 	double refpt_lat, refpt_lon, refpt_alt;
 	int degorradians;
+	int geodeticsolver;
+
+	// Bound-origin terms, rebuilt by setlp() so per-point conversions are a 3x3 multiply-add
+	double lp_rot[3][3];		// ENV -> ECEF rotation at the reference point (rows: x,y,z ECEF)
+	double lp_ecef[3];		// reference point in ECEF (meters)
+	double lp_rn, lp_rm;		// prime vertical / meridian radius of curvature at the reference point
+
+	void computelp();
 
 
 	  void alt_to_z(double x,double y,double* z,double lp_lat,double alt);
@@ -35,7 +57,9 @@ public:
 	{
 		refpt_lat =  refpt_lon = refpt_alt = 0.0;
 		degorradians = 0;
-		esq = 0.00669437999013;     re  = 6378137.0;
+		geodeticsolver = GEODETIC_SOLVER_BOWRING;
+		esq = WGS84_ESQ;     re  = WGS84_RE;
+		computelp();
     }
 
 	CoordinateConverter(double, double, double )    ;
@@ -62,6 +86,10 @@ int polar2env(double r, double azm, double elv, double *x_env,double *y_env,doub
  int geodetic2ecef(float lat, float lon, float alt, float* x,float* y, float* z, int angletype=0);
 
 int ecef2geodetic(double x, double y, double z, double* lat, double* lon, double* alt );
+int ecef2geodetic_bowring(double x, double y, double z, double* lat, double* lon, double* alt );
+int ecef2geodetic_vermeille(double x, double y, double z, double* lat, double* lon, double* alt );
+void setGeodeticSolver(int solver) { geodeticsolver = solver; }
+int getGeodeticSolver() const { return geodeticsolver; }
 int env2geodetic(double x_env,double y_env,double z_env, double lat_env,double lon_env,double h, double *lat, double *lon, double *alt , int angletype=0);
 int ecef2polar(double x_ecef,double y_ecef,double z_ecef, double lat_env,double lon_env,double h, double *r, double *azm , double *elv , int angletype=0 );
 int polar2ecef(double r, double azm, double elv, double lat_env,double lon_env,double h , double *x_ecef, double *y_ecef, double *z_ecef , int angletype=0);
@@ -85,6 +113,15 @@ int geodetic2drcral(double lat, double lon, double alt, double az, double lat_en
 void ecef_env(double *x_env,double *y_env,double *z_env,double x_ecef,double y_ecef,double z_ecef,double lat_env,double lon_env, int angletype);
 void env_ecef(double x_env,double y_env,double z_env,double *x_ecef,double *y_ecef,double *z_ecef,double lat_env,double lon_env, int angletype);
 
+// Bound-origin conversions: the origin is the reference point set by setlp() (degrees)
+void env2ecef_lp(double x_env, double y_env, double z_env, double *x_ecef, double *y_ecef, double *z_ecef);
+void ecef2env_lp(double x_ecef, double y_ecef, double z_ecef, double *x_env, double *y_env, double *z_env);
+int env2geodetic_lp(double x_env, double y_env, double z_env, double *lat, double *lon, double *alt);
+int geodetic2env_lp(double lat, double lon, double alt, double *x_env, double *y_env, double *z_env, int angletype=0);
+int polar2geodetic_lp(double r, double azm, double elv, double *lat, double *lon, double *alt, int angletype=0);
+double getlpRadiusPrimeVertical() const { return lp_rn; }
+double getlpRadiusMeridian() const { return lp_rm; }
+
         double atod(char* a);
    void substr(char* str, int start, int end , char *msg);
 //Added by Kanan - 28/03/2017
@@ -92,6 +129,12 @@ void cov_pos_polar2env(double var_env[][3],double r,double ele,double azi,double
 void cov_pos_env2ecef(double var_ecef[][3],double lat_env,double lon_env,double var_ENV[][3]);
 void cov_pos_ecef2env(double latdeg,double londeg,double *cov_ecef,double *cov_env);
 
+// Batch covariance kernels. Each covariance is 6 consecutive values (6*i + k), the
+// upper triangle in order (0,0) (0,1) (0,2) (1,1) (1,2) (2,2)
+void cov_pos_polar2env_batch(int n, const double *x_env, const double *y_env, const double *z_env,
+                             double var_r, double var_ele, double var_azi, double *cov_env);
+void cov_pos_env2geodetic_lp_batch(int n, const double *alt, const double *cov_env, double *cov_geo);
+
         ~CoordinateConverter() {   }
 
 
@@ -0,0 +1,178 @@
+#ifndef COORD_CONV_T_H_INCLUDED
+#define COORD_CONV_T_H_INCLUDED
+
+#include <cmath>
+#include "CoordinateConverter.h"
+
+/*
+ * Compile-time specialised coordinate conversions.
+ *
+ * TCoordinateConverter<T, AngleUnit> carries the scalar type and the angle unit of
+ * every angular input/output in its type, so the degrees/radians dispatch that
+ * CoordinateConverter does at runtime through 'angletype' folds away, and the float
+ * instantiation really computes in float. CoordinateConverter keeps its original
+ * API as thin wrappers over these.
+ *
+ * Conventions are the same as CoordinateConverter: ENV is X(EAST), Y(NORTH),
+ * Z(VERTICAL); azimuth is measured from local North; distances are in meters.
+ */
+
+/** @brief Angle unit tag: angles are given and returned in degrees */
+struct AngleDegrees
+{
+    template<typename T> static inline T toRad(T a) { return a * T(3.14159265358979323846 / 180.0); }
+    template<typename T> static inline T fromRad(T a) { return a * T(180.0 / 3.14159265358979323846); }
+    template<typename T> static inline T fullCircle() { return T(360.0); }
+};
+
+/** @brief Angle unit tag: angles are given and returned in radians */
+struct AngleRadians
+{
+    template<typename T> static inline T toRad(T a) { return a; }
+    template<typename T> static inline T fromRad(T a) { return a; }
+    template<typename T> static inline T fullCircle() { return T(2.0 * 3.14159265358979323846); }
+};
+
+template<typename T, typename AngleUnit>
+class TCoordinateConverter
+{
+public:
+    // WGS-84 terms from CoordinateConverter.h
+    static inline T re()  { return T(WGS84_RE); }
+    static inline T esq() { return T(WGS84_ESQ); }
+    static inline T rb()  { return T(WGS84_RB); }
+    static inline T ep2() { return T(WGS84_EP2); }
+
+    /* The following function resolves a vector defined in ENV in ECEF */
+    static inline void env_ecef(T x_env, T y_env, T z_env, T *x_ecef, T *y_ecef, T *z_ecef, T lat_env, T lon_env)
+    {
+        T lat = AngleUnit::toRad(lat_env), lon = AngleUnit::toRad(lon_env);
+        T slat = std::sin(lat), clat = std::cos(lat);
+        T slon = std::sin(lon), clon = std::cos(lon);
+
+        *x_ecef = clat*clon*z_env - slon*x_env - slat*clon*y_env;
+        *y_ecef = clat*slon*z_env + clon*x_env - slat*slon*y_env;
+        *z_ecef = slat*z_env + clat*y_env;
+    }
+
+    /* The following function resolves a vector defined in ECEF in ENV */
+    static inline void ecef_env(T *x_env, T *y_env, T *z_env, T x_ecef, T y_ecef, T z_ecef, T lat_env, T lon_env)
+    {
+        T lat = AngleUnit::toRad(lat_env), lon = AngleUnit::toRad(lon_env);
+        T slat = std::sin(lat), clat = std::cos(lat);
+        T slon = std::sin(lon), clon = std::cos(lon);
+
+        *x_env = -slon*x_ecef + clon*y_ecef;
+        *y_env = -slat*clon*x_ecef - slat*slon*y_ecef + clat*z_ecef;
+        *z_env =  clat*clon*x_ecef + clat*slon*y_ecef + slat*z_ecef;
+    }
+
+    static inline void geodetic2ecef(T lat, T lon, T alt, T *x, T *y, T *z)
+    {
+        lat = AngleUnit::toRad(lat);
+        lon = AngleUnit::toRad(lon);
+        T slat = std::sin(lat), clat = std::cos(lat);
+        T r_lamda = re() / std::sqrt(T(1) - esq()*slat*slat);
+
+        *x = (r_lamda + alt)*clat*std::cos(lon);
+        *y = (r_lamda + alt)*clat*std::sin(lon);
+        *z = ((T(1) - esq())*r_lamda + alt)*slat;
+    }
+
+    static inline void ecef2env(T *x_env, T *y_env, T *z_env, T x_ecef, T y_ecef, T z_ecef, T lat_env, T lon_env, T h)
+    {
+        T lat = AngleUnit::toRad(lat_env), lon = AngleUnit::toRad(lon_env);
+        T slat = std::sin(lat), clat = std::cos(lat);
+        T slon = std::sin(lon), clon = std::cos(lon);
+        T r_lamda = re() / std::sqrt(T(1) - esq()*slat*slat);
+
+        T x = x_ecef - (r_lamda + h)*clat*clon;
+        T y = y_ecef - (r_lamda + h)*clat*slon;
+        T z = z_ecef - ((T(1) - esq())*r_lamda + h)*slat;
+
+        *x_env = -slon*x + clon*y;
+        *y_env = -slat*clon*x - slat*slon*y + clat*z;
+        *z_env =  clat*clon*x + clat*slon*y + slat*z;
+    }
+
+    static inline void env2ecef(T x_env, T y_env, T z_env, T *x_ecef, T *y_ecef, T *z_ecef, T lat_env, T lon_env, T h)
+    {
+        T lat = AngleUnit::toRad(lat_env), lon = AngleUnit::toRad(lon_env);
+        T slat = std::sin(lat), clat = std::cos(lat);
+        T slon = std::sin(lon), clon = std::cos(lon);
+        T r_lamda = re() / std::sqrt(T(1) - esq()*slat*slat);
+
+        // Rotated vector first, then the origin, in the order of the original implementation
+        *x_ecef = (clat*clon*z_env - slon*x_env - slat*clon*y_env) + (r_lamda + h)*clat*clon;
+        *y_ecef = (clat*slon*z_env + clon*x_env - slat*slon*y_env) + (r_lamda + h)*clat*slon;
+        *z_ecef = (slat*z_env + clat*y_env) + ((T(1) - esq())*r_lamda + h)*slat;
+    }
+
+    static inline void polar2env(T r, T azm, T elv, T *x_env, T *y_env, T *z_env)
+    {
+        azm = AngleUnit::toRad(azm);
+        elv = AngleUnit::toRad(elv);
+        T celv = std::cos(elv);
+
+        *x_env = r*celv*std::sin(azm);
+        *y_env = r*celv*std::cos(azm);
+        *z_env = r*std::sin(elv);
+    }
+
+    /* Azimuth is returned in [0, full circle) */
+    static inline void env2polar(T *r, T *azm, T *elv, T x_env, T y_env, T z_env)
+    {
+        T rh2 = x_env*x_env + y_env*y_env;
+
+        *r = std::sqrt(rh2 + z_env*z_env);
+        *elv = AngleUnit::fromRad(std::atan2(z_env, std::sqrt(rh2)));
+        *azm = AngleUnit::fromRad(std::atan2(x_env, y_env));
+        if (*azm < T(0)) *azm += AngleUnit::template fullCircle<T>();
+    }
+
+    /* Bowring's single-step approximation, longitude from atan(y/x) as in the original */
+    static inline void ecef2geodetic_bowring(T x, T y, T z, T *lat, T *lon, T *alt)
+    {
+        T p = std::sqrt(x*x + y*y);
+        T theta = std::atan((z*re()) / (p*rb()));
+        T st = std::sin(theta), ct = std::cos(theta);
+        T la = std::atan((z + ep2()*rb()*st*st*st) / (p - esq()*re()*ct*ct*ct));
+        T sla = std::sin(la);
+
+        *alt = p/std::cos(la) - re()/std::sqrt(T(1) - esq()*sla*sla);
+        *lat = AngleUnit::fromRad(la);
+        *lon = AngleUnit::fromRad(std::atan(y/x));
+    }
+
+    /* Exact closed-form solution (Vermeille), see CoordinateConverter::ecef2geodetic_vermeille */
+    static inline void ecef2geodetic_vermeille(T x, T y, T z, T *lat, T *lon, T *alt)
+    {
+        T e2 = esq(), e4 = e2*e2;
+        T a2 = re()*re();
+        T pxy2 = x*x + y*y;
+        T pxy = std::sqrt(pxy2);
+
+        T p = pxy2/a2;
+        T q = ((T(1) - e2)/a2)*z*z;
+        T r = (p + q - e4)/T(6);
+        T s = e4*p*q/(T(4)*r*r*r);
+        T t = std::cbrt(T(1) + s + std::sqrt(s*(T(2) + s)));
+        T u = r*(T(1) + t + T(1)/t);
+        T v = std::sqrt(u*u + e4*q);
+        T w = e2*(u + v - q)/(T(2)*v);
+        T k = std::sqrt(u + v + w*w) - w;
+        T d = k*pxy/(k + e2);
+        T dz = std::sqrt(d*d + z*z);
+
+        *lat = AngleUnit::fromRad(T(2)*std::atan2(z, d + dz));
+        *lon = AngleUnit::fromRad(std::atan2(y, x));
+        *alt = ((k + e2 - T(1))/k)*dz;
+    }
+};
+
+typedef TCoordinateConverter<double, AngleDegrees> CoordConvDeg;
+typedef TCoordinateConverter<double, AngleRadians> CoordConvRad;
+typedef TCoordinateConverter<float, AngleDegrees>  CoordConvDegF;
+typedef TCoordinateConverter<float, AngleRadians>  CoordConvRadF;
+
+#endif
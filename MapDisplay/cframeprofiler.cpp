@@ -0,0 +1,354 @@
+#include "cframeprofiler.h"
+#include "cframescheduler.h"
+#include <qgsmapcanvas.h>
+#include <QDateTime>
+#include <QEvent>
+#include <QDebug>
+#include <algorithm>
+
+namespace {
+
+// Upper edges of the histogram bins in ms, the last bin is open
+const double kBinEdgesMs[CFrameProfiler::kHistogramBins - 1] = { 1, 2, 4, 8, 16, 33, 66 };
+
+// Frames further apart than this had an idle gap between them, not a slow frame
+const double kIdleGapMs = 250.0;
+
+// A frame later than this share of the animation interval dropped the ones in between
+const double kDroppedFrameFactor = 1.5;
+
+int histogramBin(double ms)
+{
+    int bin = 0;
+    while (bin < CFrameProfiler::kHistogramBins - 1 && ms >= kBinEdgesMs[bin]) {
+        bin++;
+    }
+    return bin;
+}
+
+} // namespace
+
+CFrameProfiler *CFrameProfiler::forCanvas(QgsMapCanvas *pCanvas)
+{
+    CFrameProfiler *pProfiler = pCanvas->findChild<CFrameProfiler *>(QString(), Qt::FindDirectChildrenOnly);
+    if (!pProfiler) {
+        pProfiler = new CFrameProfiler(pCanvas);
+    }
+    return pProfiler;
+}
+
+CFrameProfiler::CFrameProfiler(QgsMapCanvas *pCanvas)
+    : QObject(pCanvas), m_pCanvas(pCanvas), m_pScheduler(CFrameScheduler::forCanvas(pCanvas)),
+      m_bEnabled(false), m_bFrameOpen(false), m_nFrameStartMs(-1), m_dFrameIntervalMs(-1.0),
+      m_nFrameCount(0), m_nDroppedFrames(0)
+{
+    m_clock.start();
+    m_intervalSeries.name = QStringLiteral("Frame interval");
+    m_intervalSeries.head = 0;
+    m_intervalSeries.count = 0;
+    m_intervalSeries.last = 0.0;
+
+    m_commitTimer.setSingleShot(true);
+    m_commitTimer.setInterval(0);
+    connect(&m_commitTimer, &QTimer::timeout, this, &CFrameProfiler::commitFrame);
+
+    connect(m_pCanvas, &QgsMapCanvas::renderStarting, this, &CFrameProfiler::onRenderStarting);
+    connect(m_pCanvas, &QgsMapCanvas::mapCanvasRefreshed, this, &CFrameProfiler::onMapCanvasRefreshed);
+    m_pCanvas->viewport()->installEventFilter(this);
+}
+
+CFrameProfiler::~CFrameProfiler()
+{
+    stopCapture();
+}
+
+void CFrameProfiler::setEnabled(bool enabled)
+{
+    if (enabled == m_bEnabled) {
+        return;
+    }
+    m_bEnabled = enabled;
+    if (enabled) {
+        reset();
+    } else {
+        stopCapture();
+        m_commitTimer.stop();
+        m_bFrameOpen = false;
+    }
+}
+
+void CFrameProfiler::addPaintTime(const QString &layer, double ms)
+{
+    if (!m_bEnabled) {
+        return;
+    }
+
+    QHash<QString, int>::const_iterator it = m_hashPaintSeries.constFind(layer);
+    if (it == m_hashPaintSeries.constEnd()) {
+        stSeries series;
+        series.name = layer;
+        series.head = 0;
+        series.count = 0;
+        series.last = 0.0;
+        m_vecPaintSeries.append(series);
+        it = m_hashPaintSeries.insert(layer, m_vecPaintSeries.size() - 1);
+    }
+    addSample(&m_vecPaintSeries[it.value()], ms);
+    m_listFramePaint.append(qMakePair(layer, ms));
+}
+
+void CFrameProfiler::setCounter(const QString &name, qint64 value)
+{
+    if (m_bEnabled) {
+        m_mapCounters.insert(name, value);
+    }
+}
+
+void CFrameProfiler::reportCache(const QString &name, quint64 hits, quint64 misses)
+{
+    if (!m_bEnabled) {
+        return;
+    }
+
+    QMap<QString, stCacheCounts>::iterator it = m_mapCaches.find(name);
+    if (it == m_mapCaches.end() || hits < it.value().baseHits || misses < it.value().baseMisses) {
+        // First report, or the cache reset its own counters
+        stCacheCounts counts = { hits, misses, hits, misses };
+        m_mapCaches.insert(name, counts);
+        return;
+    }
+    it.value().hits = hits;
+    it.value().misses = misses;
+}
+
+QList<stProfileStats> CFrameProfiler::paintStats() const
+{
+    QList<stProfileStats> listStats;
+    for (const stSeries &series : m_vecPaintSeries) {
+        listStats.append(seriesStats(series));
+    }
+    return listStats;
+}
+
+stProfileStats CFrameProfiler::frameIntervalStats() const
+{
+    return seriesStats(m_intervalSeries);
+}
+
+QList<stProfileCacheStats> CFrameProfiler::cacheStats() const
+{
+    QList<stProfileCacheStats> listStats;
+    for (QMap<QString, stCacheCounts>::const_iterator it = m_mapCaches.constBegin(); it != m_mapCaches.constEnd(); ++it) {
+        stProfileCacheStats stats;
+        stats.name = it.key();
+        stats.hits = it.value().hits - it.value().baseHits;
+        stats.misses = it.value().misses - it.value().baseMisses;
+        listStats.append(stats);
+    }
+    return listStats;
+}
+
+void CFrameProfiler::reset()
+{
+    m_vecPaintSeries.clear();
+    m_hashPaintSeries.clear();
+    m_intervalSeries.samples.clear();
+    m_intervalSeries.head = 0;
+    m_intervalSeries.count = 0;
+    m_intervalSeries.last = 0.0;
+    m_mapCounters.clear();
+    m_mapCaches.clear();
+    m_listFramePaint.clear();
+    m_nFrameStartMs = -1;
+    m_nFrameCount = 0;
+    m_nDroppedFrames = 0;
+}
+
+bool CFrameProfiler::startCapture(const QString &filePath)
+{
+    stopCapture();
+
+    m_captureFile.setFileName(filePath);
+    if (!m_captureFile.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Text)) {
+        qWarning() << "Frame profiler: cannot open capture file" << filePath << m_captureFile.errorString();
+        return false;
+    }
+    setEnabled(true);
+
+    m_captureStream.setDevice(&m_captureFile);
+    m_captureStream << "# Frame profile capture, " << QDateTime::currentDateTime().toString(Qt::ISODate) << "\n";
+    m_captureStream << "frame,time_ms,kind,name,value\n";
+    return true;
+}
+
+void CFrameProfiler::stopCapture()
+{
+    if (!m_captureFile.isOpen()) {
+        return;
+    }
+
+    const QStringList lines = summaryText().split('\n');
+    for (const QString &line : lines) {
+        if (!line.isEmpty()) {
+            m_captureStream << "# " << line << "\n";
+        }
+    }
+    m_captureStream.flush();
+    m_captureStream.setDevice(nullptr);
+    m_captureFile.close();
+}
+
+QString CFrameProfiler::summaryText() const
+{
+    QString text;
+    auto appendStats = [&text](const stProfileStats &stats) {
+        text += QString("%1: last %2 ms, mean %3, p50 %4, p95 %5, max %6 (%7 samples) [")
+                .arg(stats.name).arg(stats.lastMs, 0, 'f', 2).arg(stats.meanMs, 0, 'f', 2)
+                .arg(stats.p50Ms, 0, 'f', 2).arg(stats.p95Ms, 0, 'f', 2).arg(stats.maxMs, 0, 'f', 2)
+                .arg(stats.samples);
+        for (int bin = 0; bin < stats.histogram.size(); ++bin) {
+            text += QString("%1%2: %3").arg(bin ? ", " : "").arg(histogramBinLabel(bin)).arg(stats.histogram[bin]);
+        }
+        text += "]\n";
+    };
+
+    text += QString("Frames: %1, dropped %2\n").arg(m_nFrameCount).arg(m_nDroppedFrames);
+    appendStats(frameIntervalStats());
+    for (const stProfileStats &stats : paintStats()) {
+        appendStats(stats);
+    }
+    for (QMap<QString, qint64>::const_iterator it = m_mapCounters.constBegin(); it != m_mapCounters.constEnd(); ++it) {
+        text += QString("%1: %2\n").arg(it.key()).arg(it.value());
+    }
+    for (const stProfileCacheStats &stats : cacheStats()) {
+        text += QString("%1 cache: %2% hits (%3 hits, %4 misses)\n")
+                .arg(stats.name).arg(stats.hitRate() * 100.0, 0, 'f', 1).arg(stats.hits).arg(stats.misses);
+    }
+    return text;
+}
+
+QString CFrameProfiler::histogramBinLabel(int bin)
+{
+    if (bin <= 0) {
+        return QString("<%1 ms").arg(kBinEdgesMs[0]);
+    }
+    if (bin >= kHistogramBins - 1) {
+        return QString(">=%1 ms").arg(kBinEdgesMs[kHistogramBins - 2]);
+    }
+    return QString("%1-%2 ms").arg(kBinEdgesMs[bin - 1]).arg(kBinEdgesMs[bin]);
+}
+
+bool CFrameProfiler::eventFilter(QObject *obj, QEvent *event)
+{
+    // Seen before the view paints its items, whose scopes then land in this frame
+    if (m_bEnabled && event->type() == QEvent::Paint && obj == m_pCanvas->viewport()) {
+        beginFrame();
+    }
+    return QObject::eventFilter(obj, event);
+}
+
+void CFrameProfiler::onRenderStarting()
+{
+    if (m_bEnabled) {
+        m_baseMapTimer.start();
+    }
+}
+
+void CFrameProfiler::onMapCanvasRefreshed()
+{
+    if (m_bEnabled && m_baseMapTimer.isValid()) {
+        addPaintTime(QStringLiteral("Base map"), m_baseMapTimer.nsecsElapsed() / 1.0e6);
+        m_baseMapTimer.invalidate();
+    }
+}
+
+void CFrameProfiler::beginFrame()
+{
+    if (m_bFrameOpen) {
+        commitFrame();
+    }
+
+    const qint64 nowMs = m_clock.elapsed();
+    m_dFrameIntervalMs = -1.0;
+    if (m_nFrameStartMs >= 0 && nowMs - m_nFrameStartMs < kIdleGapMs) {
+        m_dFrameIntervalMs = double(nowMs - m_nFrameStartMs);
+        addSample(&m_intervalSeries, m_dFrameIntervalMs);
+
+        const int animationIntervalMs = m_pScheduler->animationIntervalMs();
+        if (animationIntervalMs > 0 && m_dFrameIntervalMs > kDroppedFrameFactor * animationIntervalMs) {
+            m_nDroppedFrames += quint64(qRound(m_dFrameIntervalMs / animationIntervalMs) - 1);
+        }
+    }
+    m_nFrameStartMs = nowMs;
+    m_bFrameOpen = true;
+    m_commitTimer.start();
+}
+
+void CFrameProfiler::commitFrame()
+{
+    if (!m_bFrameOpen) {
+        return;
+    }
+    m_bFrameOpen = false;
+    m_nFrameCount++;
+
+    if (m_captureFile.isOpen()) {
+        if (m_dFrameIntervalMs >= 0.0) {
+            writeCaptureRow(QStringLiteral("interval"), QString(), m_dFrameIntervalMs);
+        }
+        for (const QPair<QString, double> &sample : m_listFramePaint) {
+            writeCaptureRow(QStringLiteral("paint"), sample.first, sample.second);
+        }
+        for (QMap<QString, qint64>::const_iterator it = m_mapCounters.constBegin(); it != m_mapCounters.constEnd(); ++it) {
+            writeCaptureRow(QStringLiteral("counter"), it.key(), double(it.value()));
+        }
+        for (const stProfileCacheStats &stats : cacheStats()) {
+            writeCaptureRow(QStringLiteral("cache"), stats.name, stats.hitRate());
+        }
+    }
+    m_listFramePaint.clear();
+}
+
+void CFrameProfiler::addSample(stSeries *pSeries, double value)
+{
+    if (pSeries->samples.size() != kHistoryFrames) {
+        pSeries->samples.resize(kHistoryFrames);
+    }
+    pSeries->samples[pSeries->head] = float(value);
+    pSeries->head = (pSeries->head + 1) % kHistoryFrames;
+    pSeries->count = qMin(pSeries->count + 1, kHistoryFrames);
+    pSeries->last = value;
+}
+
+stProfileStats CFrameProfiler::seriesStats(const stSeries &series)
+{
+    stProfileStats stats;
+    stats.name = series.name;
+    stats.samples = series.count;
+    stats.lastMs = series.last;
+    stats.meanMs = stats.p50Ms = stats.p95Ms = stats.maxMs = 0.0;
+    stats.histogram.fill(0, kHistogramBins);
+    if (series.count == 0) {
+        return stats;
+    }
+
+    // The window is the first count slots until the ring has wrapped, then all of it
+    QVector<float> sorted = series.samples.mid(0, series.count);
+    double sum = 0.0;
+    for (float sample : sorted) {
+        sum += sample;
+        stats.histogram[histogramBin(sample)]++;
+    }
+    std::sort(sorted.begin(), sorted.end());
+    stats.meanMs = sum / series.count;
+    stats.p50Ms = sorted[(series.count - 1) / 2];
+    stats.p95Ms = sorted[qMin(series.count - 1, int(series.count * 0.95))];
+    stats.maxMs = sorted.last();
+    return stats;
+}
+
+void CFrameProfiler::writeCaptureRow(const QString &kind, const QString &name, double value)
+{
+    m_captureStream << m_nFrameCount << ',' << m_nFrameStartMs << ',' << kind << ',' << name << ','
+                    << QString::number(value, 'f', 3) << '\n';
+}
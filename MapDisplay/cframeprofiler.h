@@ -0,0 +1,226 @@
+#ifndef CFRAMEPROFILER_H
+#define CFRAMEPROFILER_H
+
+#include <QObject>
+#include <QTimer>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QTextStream>
+#include <QHash>
+#include <QMap>
+#include <QList>
+#include <QPair>
+#include <QVector>
+
+class QgsMapCanvas;
+class CFrameScheduler;
+
+/**
+ * @brief Rolling figures of one timed series: a layer's paint time or the frame interval
+ */
+struct stProfileStats {
+    QString name;
+    int samples;                //!< Samples in the window, at most CFrameProfiler::kHistoryFrames
+    double lastMs;
+    double meanMs;
+    double p50Ms;
+    double p95Ms;
+    double maxMs;
+    QVector<int> histogram;     //!< Samples per bin, see CFrameProfiler::histogramBinLabel()
+};
+
+/**
+ * @brief Hit rate of one cache since the profiler was enabled or reset
+ */
+struct stProfileCacheStats {
+    QString name;
+    quint64 hits;
+    quint64 misses;
+
+    double hitRate() const { return (hits + misses) ? double(hits) / double(hits + misses) : 0.0; }
+};
+
+/**
+ * @brief CFrameProfiler - Paint time, frame pacing and cache figures of one canvas
+ *
+ * Canvas items time their paint() with CProfileScope and report counters and cache hit
+ * counts; the profiler keeps the last kHistoryFrames samples of every series and answers
+ * percentiles and log-scale histograms over that window. The base map is timed from the
+ * canvas' render start to its refresh, the QGIS job runs off the GUI thread.
+ *
+ * A frame is one paint of the canvas viewport. The interval between frames is only
+ * recorded while frames follow each other closely, an idle console is not a slow one; a
+ * frame counts as dropped when it comes later than 1.5 times the interval the running
+ * animations asked the CFrameScheduler for.
+ *
+ * Disabled, a scope costs one branch. startCapture() writes every frame's samples to a
+ * CSV file and the rolling summary at its end, for attaching to a bug report.
+ */
+class CFrameProfiler : public QObject
+{
+    Q_OBJECT
+
+public:
+    /**
+     * @brief Samples kept per series, about five seconds at 60 frames per second
+     */
+    static const int kHistoryFrames = 300;
+
+    /**
+     * @brief Histogram bins, powers of two in milliseconds from below 1 ms up
+     */
+    static const int kHistogramBins = 8;
+
+    /**
+     * @brief Profiler shared by all items of a canvas, created on first use as its child
+     */
+    static CFrameProfiler *forCanvas(QgsMapCanvas *pCanvas);
+
+    explicit CFrameProfiler(QgsMapCanvas *pCanvas);
+    ~CFrameProfiler();
+
+    void setEnabled(bool enabled);
+    bool isEnabled() const { return m_bEnabled; }
+
+    /**
+     * @brief Adds a paint time sample to a layer's series
+     * @param layer Series name, e.g. the canvas item's class
+     * @param ms Time spent, in milliseconds
+     */
+    void addPaintTime(const QString &layer, double ms);
+
+    /**
+     * @brief Sets the latest value of a counter, e.g. tracks drawn in the last frame
+     */
+    void setCounter(const QString &name, qint64 value);
+
+    /**
+     * @brief Reports a cache's cumulative hit and miss counts
+     *
+     * The first report after enabling or reset() is the baseline the hit rate starts from.
+     */
+    void reportCache(const QString &name, quint64 hits, quint64 misses);
+
+    QList<stProfileStats> paintStats() const;
+    stProfileStats frameIntervalStats() const;
+    QMap<QString, qint64> counters() const { return m_mapCounters; }
+    QList<stProfileCacheStats> cacheStats() const;
+
+    quint64 frameCount() const { return m_nFrameCount; }
+    quint64 droppedFrames() const { return m_nDroppedFrames; }
+
+    /**
+     * @brief Clears all series, counters and cache baselines
+     */
+    void reset();
+
+    /**
+     * @brief Writes every following frame to a CSV file until stopCapture()
+     *
+     * Enables the profiler. Rows are frame, time_ms, kind, name, value with kind one of
+     * interval, paint, counter or cache.
+     * @return false if the file could not be opened
+     */
+    bool startCapture(const QString &filePath);
+
+    /**
+     * @brief Appends the summary as comment lines and closes the capture file
+     */
+    void stopCapture();
+    bool isCapturing() const { return m_captureFile.isOpen(); }
+
+    /**
+     * @brief Rolling figures of all series as plain text, one line per series
+     */
+    QString summaryText() const;
+
+    /**
+     * @brief Range of a histogram bin, e.g. "4-8 ms"
+     */
+    static QString histogramBinLabel(int bin);
+
+protected:
+    bool eventFilter(QObject *obj, QEvent *event) override;
+
+private slots:
+    void onRenderStarting();
+    void onMapCanvasRefreshed();
+    void commitFrame();
+
+private:
+    struct stSeries {
+        QString name;
+        QVector<float> samples;     //!< Ring buffer of kHistoryFrames
+        int head;                   //!< Next slot to write
+        int count;
+        double last;
+    };
+
+    struct stCacheCounts {
+        quint64 hits;
+        quint64 misses;
+        quint64 baseHits;           //!< Counts at the first report after enabling
+        quint64 baseMisses;
+    };
+
+    QgsMapCanvas *m_pCanvas;
+    CFrameScheduler *m_pScheduler;
+    bool m_bEnabled;
+    QElapsedTimer m_clock;
+
+    QVector<stSeries> m_vecPaintSeries;
+    QHash<QString, int> m_hashPaintSeries;      //!< Index into m_vecPaintSeries by name
+    stSeries m_intervalSeries;
+    QMap<QString, qint64> m_mapCounters;
+    QMap<QString, stCacheCounts> m_mapCaches;
+
+    // Frame in progress, committed once the viewport paint has returned
+    QTimer m_commitTimer;
+    bool m_bFrameOpen;
+    qint64 m_nFrameStartMs;
+    double m_dFrameIntervalMs;                  //!< Interval that opened the frame, -1 if idle before
+    QList<QPair<QString, double>> m_listFramePaint;
+    quint64 m_nFrameCount;
+    quint64 m_nDroppedFrames;
+
+    QElapsedTimer m_baseMapTimer;               //!< Running while QGIS renders the base map
+
+    QFile m_captureFile;
+    QTextStream m_captureStream;
+
+    void beginFrame();
+    static void addSample(stSeries *pSeries, double value);
+    static stProfileStats seriesStats(const stSeries &series);
+    void writeCaptureRow(const QString &kind, const QString &name, double value);
+};
+
+/**
+ * @brief Times a paint() into a CFrameProfiler series from construction to scope exit
+ */
+class CProfileScope
+{
+public:
+    CProfileScope(CFrameProfiler *pProfiler, const QString &layer)
+        : m_pProfiler((pProfiler && pProfiler->isEnabled()) ? pProfiler : nullptr), m_layer(layer)
+    {
+        if (m_pProfiler) {
+            m_timer.start();
+        }
+    }
+
+    ~CProfileScope()
+    {
+        if (m_pProfiler) {
+            m_pProfiler->addPaintTime(m_layer, m_timer.nsecsElapsed() / 1.0e6);
+        }
+    }
+
+private:
+    CFrameProfiler *m_pProfiler;
+    QString m_layer;
+    QElapsedTimer m_timer;
+
+    Q_DISABLE_COPY(CProfileScope)
+};
+
+#endif // CFRAMEPROFILER_H
@@ -0,0 +1,172 @@
+#include "cframeprofileroverlay.h"
+#include <QPainter>
+#include <QFontMetrics>
+
+namespace {
+
+// Panel refresh, slow enough that the overlay hardly shows up in what it measures
+const int kRefreshMs = 500;
+
+// Panel layout
+const double kPanelLeftPx = 10.0;
+const double kPanelTopPx = 10.0;
+const double kPanelWidthPx = 480.0;
+const double kPaddingPx = 8.0;
+const double kRowPx = 16.0;
+const double kNameWidthPx = 160.0;
+const double kFiguresWidthPx = 190.0;
+const double kBinWidthPx = 10.0;
+
+} // namespace
+
+CFrameProfilerOverlay::CFrameProfilerOverlay(QgsMapCanvas *pCanvas)
+    : QgsMapCanvasItem(pCanvas), m_pProfiler(CFrameProfiler::forCanvas(pCanvas)),
+      m_pScheduler(CFrameScheduler::forCanvas(pCanvas)), m_bActive(false), m_nNextRefreshMs(0)
+{
+    setZValue(1000); // Above every layer it measures
+    hide();
+
+    connect(m_pScheduler, &CFrameScheduler::signalFrame, this, [this](qint64 nowMs) {
+        onFrame(nowMs);
+    });
+}
+
+void CFrameProfilerOverlay::setActive(bool active)
+{
+    if (active == m_bActive) {
+        return;
+    }
+    m_bActive = active;
+
+    if (active) {
+        m_pProfiler->setEnabled(true);
+        refresh();
+        show();
+        m_pScheduler->startAnimation(this, kRefreshMs);
+    } else {
+        // A capture started through the API keeps running without the panel
+        if (!m_pProfiler->isCapturing()) {
+            m_pProfiler->setEnabled(false);
+        }
+        m_pScheduler->stopAnimation(this);
+        hide();
+    }
+}
+
+QRectF CFrameProfilerOverlay::boundingRect() const
+{
+    return m_rectPanel;
+}
+
+void CFrameProfilerOverlay::onFrame(qint64 nowMs)
+{
+    if (!m_bActive || nowMs < m_nNextRefreshMs) {
+        return;
+    }
+    m_nNextRefreshMs = nowMs + kRefreshMs;
+
+    refresh();
+}
+
+void CFrameProfilerOverlay::refresh()
+{
+    // Sorting the windows for the percentiles is the expensive part, once per refresh
+    m_intervalStats = m_pProfiler->frameIntervalStats();
+    m_listPaint = m_pProfiler->paintStats();
+    m_mapCounters = m_pProfiler->counters();
+    m_listCaches = m_pProfiler->cacheStats();
+
+    m_title = QString("FRAME PROFILER  %1 frames, %2 dropped")
+              .arg(m_pProfiler->frameCount()).arg(m_pProfiler->droppedFrames());
+    if (m_pProfiler->isCapturing()) {
+        m_title += "  ● REC";
+    }
+
+    // Rows come and go with the series; the scene repaints the old area on a geometry change
+    int nRows = 3 + m_listPaint.size() + m_mapCounters.size() + m_listCaches.size();
+    QRectF rectPanel(kPanelLeftPx, kPanelTopPx, kPanelWidthPx, nRows * kRowPx + 2 * kPaddingPx);
+    if (rectPanel != m_rectPanel) {
+        prepareGeometryChange();
+        m_rectPanel = rectPanel;
+    }
+    update();
+}
+
+void CFrameProfilerOverlay::paint(QPainter *pPainter)
+{
+    if (!m_bActive) {
+        return;
+    }
+
+    const QRectF &rectPanel = m_rectPanel;
+
+    pPainter->setRenderHint(QPainter::Antialiasing, false);
+    pPainter->setPen(QPen(QColor(100, 200, 255), 1));
+    pPainter->setBrush(QColor(15, 20, 30, 220));
+    pPainter->drawRect(rectPanel);
+
+    QFont font("Consolas", 8);
+    pPainter->setFont(font);
+    QFontMetrics fm(font);
+
+    double y = rectPanel.top() + kPaddingPx;
+    const double x = rectPanel.left() + kPaddingPx;
+
+    // Title row
+    pPainter->setPen(QColor(100, 200, 255));
+    pPainter->drawText(QPointF(x, y + fm.ascent()), m_title);
+    y += kRowPx;
+
+    // Column headings, times in ms
+    pPainter->setPen(QColor(150, 150, 170));
+    pPainter->drawText(QPointF(x + kNameWidthPx, y + fm.ascent()),
+                       QString("%1 %2 %3 %4").arg("last", 6).arg("p50", 6).arg("p95", 6).arg("max", 6));
+    pPainter->drawText(QPointF(x + kNameWidthPx + kFiguresWidthPx, y + fm.ascent()),
+                       QString("%1 .. %2").arg(CFrameProfiler::histogramBinLabel(0))
+                       .arg(CFrameProfiler::histogramBinLabel(CFrameProfiler::kHistogramBins - 1)));
+    y += kRowPx;
+
+    // Timed series: figures and a histogram scaled to its fullest bin
+    auto drawSeries = [&](const stProfileStats &stats, const QColor &color) {
+        pPainter->setPen(color);
+        pPainter->drawText(QPointF(x, y + fm.ascent()), fm.elidedText(stats.name, Qt::ElideRight, int(kNameWidthPx) - 4));
+        pPainter->setPen(QColor(220, 220, 230));
+        pPainter->drawText(QPointF(x + kNameWidthPx, y + fm.ascent()),
+                           QString("%1 %2 %3 %4").arg(stats.lastMs, 6, 'f', 2).arg(stats.p50Ms, 6, 'f', 2)
+                           .arg(stats.p95Ms, 6, 'f', 2).arg(stats.maxMs, 6, 'f', 2));
+
+        int fullest = 1;
+        for (int count : stats.histogram) {
+            fullest = qMax(fullest, count);
+        }
+        const double barLeft = x + kNameWidthPx + kFiguresWidthPx;
+        const double barBottom = y + kRowPx - 3;
+        const double barMaxHeight = kRowPx - 4;
+        pPainter->setPen(Qt::NoPen);
+        for (int bin = 0; bin < stats.histogram.size(); ++bin) {
+            // Green up to one display refresh, amber to two, red beyond
+            QColor binColor = (bin < 5) ? QColor(46, 204, 113) : (bin < 6) ? QColor(241, 196, 15) : QColor(231, 76, 60);
+            double height = qMax(stats.histogram[bin] > 0 ? 1.0 : 0.0, barMaxHeight * stats.histogram[bin] / fullest);
+            pPainter->setBrush(binColor);
+            pPainter->drawRect(QRectF(barLeft + bin * kBinWidthPx, barBottom - height, kBinWidthPx - 2, height));
+        }
+        y += kRowPx;
+    };
+
+    drawSeries(m_intervalStats, QColor(150, 180, 255));
+    for (const stProfileStats &stats : m_listPaint) {
+        drawSeries(stats, QColor(200, 200, 210));
+    }
+
+    pPainter->setPen(QColor(200, 200, 210));
+    for (QMap<QString, qint64>::const_iterator it = m_mapCounters.constBegin(); it != m_mapCounters.constEnd(); ++it) {
+        pPainter->drawText(QPointF(x, y + fm.ascent()), QString("%1: %2").arg(it.key()).arg(it.value()));
+        y += kRowPx;
+    }
+    for (const stProfileCacheStats &stats : m_listCaches) {
+        pPainter->drawText(QPointF(x, y + fm.ascent()),
+                           QString("%1 cache: %2% hits of %3").arg(stats.name)
+                           .arg(stats.hitRate() * 100.0, 0, 'f', 1).arg(stats.hits + stats.misses));
+        y += kRowPx;
+    }
+}
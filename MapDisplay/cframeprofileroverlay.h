@@ -0,0 +1,61 @@
+#ifndef CFRAMEPROFILEROVERLAY_H
+#define CFRAMEPROFILEROVERLAY_H
+
+#include <QObject>
+#include <qgsmapcanvas.h>
+#include <qgsmapcanvasitem.h>
+#include "cframeprofiler.h"
+#include "cframescheduler.h"
+
+/**
+ * @brief CFrameProfilerOverlay - Corner panel showing the canvas' CFrameProfiler figures
+ *
+ * One row per timed series with its last, median, 95th percentile and worst time and a
+ * histogram of the rolling window, then the counters and cache hit rates. Shown, it enables
+ * the profiler and refreshes a few times per second on the canvas' frame clock; the
+ * figures are taken once per refresh and only the panel area is repainted, so its own
+ * repaints show up in the frame interval as a low steady rate, nothing else.
+ */
+class CFrameProfilerOverlay : public QObject, public QgsMapCanvasItem
+{
+    Q_OBJECT
+
+public:
+    explicit CFrameProfilerOverlay(QgsMapCanvas *pCanvas);
+
+    /**
+     * @brief Shows the panel and enables profiling, or hides it and stops both
+     *
+     * Profiling stays on while a capture runs.
+     */
+    void setActive(bool active);
+    bool isActive() const { return m_bActive; }
+
+    CFrameProfiler *profiler() const { return m_pProfiler; }
+
+    void paint(QPainter *pPainter) override;
+    QRectF boundingRect() const override;
+
+private:
+    CFrameProfiler *m_pProfiler;
+    CFrameScheduler *m_pScheduler;
+    bool m_bActive;
+    qint64 m_nNextRefreshMs;        //!< Frame time of the next refresh, faster ticks are skipped
+
+    // Figures of the last refresh, paint() only draws them
+    QRectF m_rectPanel;             //!< Panel area, also the bounding rectangle
+    QString m_title;
+    stProfileStats m_intervalStats;
+    QList<stProfileStats> m_listPaint;
+    QMap<QString, qint64> m_mapCounters;
+    QList<stProfileCacheStats> m_listCaches;
+
+    void onFrame(qint64 nowMs);
+
+    /**
+     * @brief Takes the profiler's figures once and repaints the panel with them
+     */
+    void refresh();
+};
+
+#endif // CFRAMEPROFILEROVERLAY_H
@@ -0,0 +1,84 @@
+#include "cframescheduler.h"
+#include <qgsmapcanvas.h>
+
+CFrameScheduler *CFrameScheduler::forCanvas(QgsMapCanvas *pCanvas)
+{
+    CFrameScheduler *pScheduler = pCanvas->findChild<CFrameScheduler *>(QString(), Qt::FindDirectChildrenOnly);
+    if (!pScheduler) {
+        pScheduler = new CFrameScheduler(pCanvas);
+    }
+    return pScheduler;
+}
+
+CFrameScheduler::CFrameScheduler(QObject *pParent)
+    : QObject(pParent), m_nLastTickMs(-1), m_nDueMs(-1), m_nFrameCount(0)
+{
+    m_clock.start();
+    m_timer.setSingleShot(true);
+    m_timer.setTimerType(Qt::PreciseTimer);
+    connect(&m_timer, &QTimer::timeout, this, &CFrameScheduler::onTick);
+}
+
+void CFrameScheduler::requestFrame(int delayMs)
+{
+    const qint64 now = nowMs();
+    qint64 dueMs = now + qMax(0, delayMs);
+    if (m_nLastTickMs >= 0) {
+        dueMs = qMax(dueMs, m_nLastTickMs + kFrameIntervalMs);
+    }
+
+    // An earlier pending tick serves this request as well
+    if (m_nDueMs >= 0 && m_nDueMs <= dueMs) {
+        return;
+    }
+    m_nDueMs = dueMs;
+    m_timer.start(int(dueMs - now));
+}
+
+void CFrameScheduler::startAnimation(QObject *pClient, int intervalMs)
+{
+    if (!pClient) {
+        return;
+    }
+    if (!m_hashAnimations.contains(pClient)) {
+        connect(pClient, &QObject::destroyed, this, &CFrameScheduler::onClientDestroyed, Qt::UniqueConnection);
+        requestFrame();
+    }
+    m_hashAnimations.insert(pClient, qMax(kFrameIntervalMs, intervalMs));
+}
+
+void CFrameScheduler::stopAnimation(QObject *pClient)
+{
+    m_hashAnimations.remove(pClient);
+}
+
+int CFrameScheduler::animationIntervalMs() const
+{
+    if (m_hashAnimations.isEmpty()) {
+        return 0;
+    }
+    int intervalMs = m_hashAnimations.constBegin().value();
+    for (int clientInterval : m_hashAnimations) {
+        intervalMs = qMin(intervalMs, clientInterval);
+    }
+    return intervalMs;
+}
+
+void CFrameScheduler::onTick()
+{
+    m_nDueMs = -1;
+    m_nLastTickMs = nowMs();
+    m_nFrameCount++;
+
+    emit signalFrame(m_nLastTickMs);
+
+    // Clients may have started or stopped animations while handling the tick
+    if (!m_hashAnimations.isEmpty()) {
+        requestFrame(animationIntervalMs());
+    }
+}
+
+void CFrameScheduler::onClientDestroyed(QObject *pClient)
+{
+    m_hashAnimations.remove(pClient);
+}
@@ -0,0 +1,105 @@
+#ifndef CFRAMESCHEDULER_H
+#define CFRAMESCHEDULER_H
+
+#include <QObject>
+#include <QTimer>
+#include <QElapsedTimer>
+#include <QHash>
+
+class QgsMapCanvas;
+
+/**
+ * @brief CFrameScheduler - Frame tick and animation clock of one canvas
+ *
+ * Canvas items no longer repaint from their own free-running timers. They call
+ * requestFrame() when new data was applied or a view or display setting changed, and
+ * do their work in signalFrame(). Every request made before a tick is served by that
+ * one tick, and ticks are at least kFrameIntervalMs apart, so the items' update() calls
+ * land in the same scene repaint.
+ *
+ * Animations register with startAnimation() and keep the ticks coming at the shortest
+ * interval any of them needs until they stop. All items of a tick see the same frame
+ * time and derive their animation phase from it, so a late or dropped tick does not
+ * slow an animation down. With no request and no running animation the timer stays
+ * stopped and an idle console does not wake up.
+ */
+class CFrameScheduler : public QObject
+{
+    Q_OBJECT
+
+public:
+    /**
+     * @brief Shortest time between two ticks, about one display refresh
+     */
+    static const int kFrameIntervalMs = 16;
+
+    /**
+     * @brief Scheduler shared by all items of a canvas, created on first use as its child
+     */
+    static CFrameScheduler *forCanvas(QgsMapCanvas *pCanvas);
+
+    explicit CFrameScheduler(QObject *pParent = nullptr);
+
+    /**
+     * @brief Asks for a tick
+     * @param delayMs Earliest useful time from now, e.g. an animation's next step; the
+     *        tick may come sooner if another request wants one
+     */
+    void requestFrame(int delayMs = 0);
+
+    /**
+     * @brief Registers a running animation, or changes its interval
+     * @param pClient Owner of the animation, unregistered when it is destroyed
+     * @param intervalMs Tick spacing the animation needs
+     */
+    void startAnimation(QObject *pClient, int intervalMs = kFrameIntervalMs);
+
+    /**
+     * @brief Unregisters an animation; the ticks stop with the last one
+     */
+    void stopAnimation(QObject *pClient);
+
+    bool isAnimationRunning(QObject *pClient) const { return m_hashAnimations.contains(pClient); }
+    int animationCount() const { return m_hashAnimations.size(); }
+
+    /**
+     * @brief Tick spacing the running animations ask for, 0 when none runs
+     */
+    int animationIntervalMs() const;
+
+    /**
+     * @brief Milliseconds on the scheduler's monotonic clock, the timebase of signalFrame()
+     */
+    qint64 nowMs() const { return m_clock.elapsed(); }
+
+    /**
+     * @brief Time of the latest tick on the nowMs() clock, shared by everything drawn for it
+     */
+    qint64 frameTimeMs() const { return m_nLastTickMs; }
+
+    /**
+     * @brief Ticks run since construction
+     */
+    quint64 frameCount() const { return m_nFrameCount; }
+
+signals:
+    /**
+     * @brief A tick; clients check their own pending work and due times
+     * @param nowMs Frame time on the nowMs() clock, the same for every client
+     */
+    void signalFrame(qint64 nowMs);
+
+private slots:
+    void onTick();
+    void onClientDestroyed(QObject *pClient);
+
+private:
+    QTimer m_timer;
+    QHash<QObject *, int> m_hashAnimations;     //!< Running animations and their tick interval
+    QElapsedTimer m_clock;
+    qint64 m_nLastTickMs;       //!< Time of the last tick, -1 before the first
+    qint64 m_nDueMs;            //!< Time the pending tick is scheduled for, -1 if none
+    quint64 m_nFrameCount;
+};
+
+#endif // CFRAMESCHEDULER_H
@@ -1,4 +1,5 @@
 #include "cgismapcontroller.h"
+#include "cframescheduler.h"
 
 
 CGISMapController::CGISMapController(QQuickItem *parent) : QQuickPaintedItem(parent)
@@ -22,11 +23,15 @@ CGISMapController::CGISMapController(QQuickItem *parent) : QQuickPaintedItem(par
     connect( this, &QQuickPaintedItem::widthChanged, this, &CGISMapController::updateMapCanvasSize );
     connect( this, &QQuickPaintedItem::heightChanged, this, &CGISMapController::updateMapCanvasSize );
 
-    connect(&_animationTimer, &QTimer::timeout, this, [this]() {
-        //_frame++;
+    // Mirror the canvas on its own repaint requests only: a tick of the canvas clock, which
+    // every item asks for when it changed, or a finished base map render. Nothing else
+    // watches the scene, and nothing is repainted while the console is idle
+    connect(CFrameScheduler::forCanvas(_m_pObjMapCanvas), &CFrameScheduler::signalFrame, this, [this]() {
         update();  // Trigger paint()
     });
-    _animationTimer.start(16); // ~60 FPS
+    connect(_m_pObjMapCanvas, &QgsMapCanvas::mapCanvasRefreshed, this, [this]() {
+        update();
+    });
 
 }
 
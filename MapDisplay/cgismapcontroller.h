@@ -35,8 +35,6 @@ private:
     QPointer<CMapCanvas> _m_pObjMapCanvas;
     CMapDisplay *displ;
 
-    QTimer _animationTimer;
-
     void routeMouseEvents(QMouseEvent *event);
     void routeWheelEvents(QWheelEvent *event);
 };
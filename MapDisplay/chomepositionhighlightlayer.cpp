@@ -6,7 +6,8 @@
 CHomePositionHighlightLayer::CHomePositionHighlightLayer(QgsMapCanvas *canvas)
     : QgsMapCanvasItem(canvas)
     , m_canvas(canvas)
-    , m_animationTimer(new QTimer(this))
+    , m_pScheduler(CFrameScheduler::forCanvas(canvas))
+    , m_pProfiler(CFrameProfiler::forCanvas(canvas))
     , m_isAnimating(false)
     , m_animationDuration(3000)
     , m_animationStartTime(0)
@@ -14,8 +15,8 @@ CHomePositionHighlightLayer::CHomePositionHighlightLayer(QgsMapCanvas *canvas)
     setZValue(150); // Higher than PPI layer (100) to appear on top
     hide(); // Initially hidden
 
-    // Setup animation timer
-    connect(m_animationTimer, &QTimer::timeout, this, &CHomePositionHighlightLayer::updateAnimation);
+    // Animation frames come from the canvas clock
+    connect(m_pScheduler, &CFrameScheduler::signalFrame, this, &CHomePositionHighlightLayer::updateAnimation);
 }
 
 CHomePositionHighlightLayer::~CHomePositionHighlightLayer()
@@ -36,14 +37,14 @@ void CHomePositionHighlightLayer::startAnimation(int durationMs)
     }
 
     m_animationDuration = durationMs;
-    m_animationStartTime = QDateTime::currentMSecsSinceEpoch();
+    m_animationStartTime = m_pScheduler->nowMs();
     m_isAnimating = true;
 
     createCircles();
     show();
 
-    // Start animation timer at target FPS
-    m_animationTimer->start(1000 / ANIMATION_FPS);
+    // Ticks at target FPS while the animation runs
+    m_pScheduler->startAnimation(this, 1000 / ANIMATION_FPS);
 
     qDebug() << "Home position highlight animation started for" << durationMs << "ms";
 }
@@ -52,11 +53,12 @@ void CHomePositionHighlightLayer::stopAnimation()
 {
     if (!m_isAnimating) return;
 
-    m_animationTimer->stop();
+    m_pScheduler->stopAnimation(this);
     m_isAnimating = false;
     clearCircles();
     hide();
     update();
+    m_pScheduler->requestFrame();
 
     qDebug() << "Home position highlight animation stopped";
 }
@@ -80,12 +82,11 @@ void CHomePositionHighlightLayer::clearCircles()
     m_circles.clear();
 }
 
-void CHomePositionHighlightLayer::updateAnimation()
+void CHomePositionHighlightLayer::updateAnimation(qint64 nowMs)
 {
     if (!m_isAnimating) return;
 
-    qint64 currentTime = QDateTime::currentMSecsSinceEpoch();
-    qint64 elapsed = currentTime - m_animationStartTime;
+    qint64 elapsed = nowMs - m_animationStartTime;
     double progress = static_cast<double>(elapsed) / m_animationDuration;
 
     // Check if animation should end
@@ -159,6 +160,8 @@ void CHomePositionHighlightLayer::paint(QPainter *painter)
         return;
     }
 
+    CProfileScope profileScope(m_pProfiler, QStringLiteral("CHomePositionHighlightLayer"));
+
     painter->setRenderHint(QPainter::Antialiasing, true);
 
     // Calculate meters to pixels conversion
@@ -190,7 +193,7 @@ void CHomePositionHighlightLayer::paint(QPainter *painter)
     }
 
     // Draw center marker (pulsing effect)
-    double pulseScale = 1.0 + 0.3 * qSin(QDateTime::currentMSecsSinceEpoch() * 0.01);
+    double pulseScale = 1.0 + 0.3 * qSin(m_pScheduler->frameTimeMs() * 0.01);
     double markerRadius = 8.0 * pulseScale;
     
     QColor markerColor(255, 0, 0); // Red center marker
@@ -3,8 +3,9 @@
 
 #include <qgsmapcanvas.h>
 #include <qgsmapcanvasitem.h>
-#include <QTimer>
 #include <QList>
+#include "cframescheduler.h"
+#include "cframeprofiler.h"
 
 /**
  * @brief Animated expanding circles overlay to highlight home position
@@ -49,7 +50,7 @@ protected:
     void updatePosition() override;
 
 private slots:
-    void updateAnimation();
+    void updateAnimation(qint64 nowMs);
 
 private:
     struct Circle {
@@ -62,12 +63,13 @@ private:
     QgsPointXY m_center;              // Center position in map coordinates
     QPointF m_centerScreen;           // Center position in screen coordinates
     
-    QTimer *m_animationTimer;
+    CFrameScheduler *m_pScheduler;    // Canvas animation clock
+    CFrameProfiler *m_pProfiler;      // Canvas profiler
     QList<Circle> m_circles;
     
     bool m_isAnimating;
     int m_animationDuration;          // Total animation duration in ms
-    qint64 m_animationStartTime;      // Animation start timestamp
+    qint64 m_animationStartTime;      // Animation start on the clock's timebase
     
     // Animation parameters
     static constexpr int NUM_CIRCLES = 3;         // Number of expanding circles
@@ -0,0 +1,171 @@
+#ifndef CLRUCACHE_H
+#define CLRUCACHE_H
+
+#include <QHash>
+#include <QtGlobal>
+
+/**
+ * @brief CLruCache - Least-recently-used cache with integer keys and a byte budget
+ *
+ * Keys are 64-bit integers, usually packed with makeKey(), so a per-frame lookup is
+ * one hash of a quint64 instead of building and hashing a QString. Every entry
+ * carries a cost in bytes given at insert; inserting past the budget evicts from the
+ * least recently used end one entry at a time instead of dropping the whole cache.
+ * Hit, miss and eviction counters show whether the budget fits the working set.
+ *
+ * Entries are kept in a doubly linked recency list threaded through heap nodes, so
+ * find, insert and evict are O(1). Not thread-safe.
+ */
+template<typename T>
+class CLruCache
+{
+public:
+    /**
+     * @param maxBytes Budget for the summed entry costs
+     */
+    explicit CLruCache(qint64 maxBytes)
+        : m_pHead(nullptr), m_pTail(nullptr), m_nMaxBytes(maxBytes), m_nTotalBytes(0),
+          m_nHits(0), m_nMisses(0), m_nEvictions(0)
+    {
+    }
+
+    ~CLruCache() { clear(); }
+
+    /**
+     * @brief Packs up to three small fields into one key
+     * @param a Upper 32 bits, e.g. a track ID
+     * @param b Next 16 bits, e.g. a size
+     * @param c Lower 16 bits, e.g. a heading step
+     */
+    static quint64 makeKey(quint32 a, quint16 b = 0, quint16 c = 0)
+    {
+        return (quint64(a) << 32) | (quint64(b) << 16) | quint64(c);
+    }
+
+    /**
+     * @brief Looks up an entry and marks it most recently used
+     * @return The cached value, nullptr on a miss. Valid until the next insert or remove.
+     */
+    const T *find(quint64 key)
+    {
+        typename QHash<quint64, stNode*>::const_iterator it = m_hashNodes.constFind(key);
+        if (it == m_hashNodes.constEnd()) {
+            m_nMisses++;
+            return nullptr;
+        }
+        m_nHits++;
+        stNode *pNode = it.value();
+        unlink(pNode);
+        pushFront(pNode);
+        return &pNode->value;
+    }
+
+    bool contains(quint64 key) const { return m_hashNodes.contains(key); }
+
+    /**
+     * @brief Inserts or replaces an entry as most recently used, then evicts to the budget
+     * @param cost Bytes charged against the budget; an entry over the whole budget is not kept
+     */
+    void insert(quint64 key, const T &value, qint64 cost)
+    {
+        remove(key);
+        if (cost > m_nMaxBytes) {
+            return;
+        }
+
+        stNode *pNode = new stNode(key, value, cost);
+        pushFront(pNode);
+        m_hashNodes.insert(key, pNode);
+        m_nTotalBytes += cost;
+        trim();
+    }
+
+    void remove(quint64 key)
+    {
+        stNode *pNode = m_hashNodes.take(key);
+        if (pNode) {
+            unlink(pNode);
+            m_nTotalBytes -= pNode->cost;
+            delete pNode;
+        }
+    }
+
+    void clear()
+    {
+        while (m_pHead) {
+            stNode *pNext = m_pHead->pNext;
+            delete m_pHead;
+            m_pHead = pNext;
+        }
+        m_pTail = nullptr;
+        m_hashNodes.clear();
+        m_nTotalBytes = 0;
+    }
+
+    void setMaxBytes(qint64 maxBytes)
+    {
+        m_nMaxBytes = maxBytes;
+        trim();
+    }
+
+    qint64 maxBytes() const { return m_nMaxBytes; }
+    qint64 totalBytes() const { return m_nTotalBytes; }
+    int count() const { return m_hashNodes.size(); }
+
+    quint64 hits() const { return m_nHits; }
+    quint64 misses() const { return m_nMisses; }
+    quint64 evictions() const { return m_nEvictions; }
+    void resetStats() { m_nHits = m_nMisses = m_nEvictions = 0; }
+
+private:
+    struct stNode {
+        stNode(quint64 k, const T &v, qint64 c) : key(k), value(v), cost(c), pPrev(nullptr), pNext(nullptr) {}
+        quint64 key;
+        T value;
+        qint64 cost;
+        stNode *pPrev;      //!< Towards the most recently used end
+        stNode *pNext;      //!< Towards the least recently used end
+    };
+
+    QHash<quint64, stNode*> m_hashNodes;
+    stNode *m_pHead;        //!< Most recently used
+    stNode *m_pTail;        //!< Least recently used, evicted first
+    qint64 m_nMaxBytes;
+    qint64 m_nTotalBytes;
+    quint64 m_nHits;
+    quint64 m_nMisses;
+    quint64 m_nEvictions;
+
+    void unlink(stNode *pNode)
+    {
+        if (pNode->pPrev) pNode->pPrev->pNext = pNode->pNext;
+        else m_pHead = pNode->pNext;
+        if (pNode->pNext) pNode->pNext->pPrev = pNode->pPrev;
+        else m_pTail = pNode->pPrev;
+        pNode->pPrev = pNode->pNext = nullptr;
+    }
+
+    void pushFront(stNode *pNode)
+    {
+        pNode->pNext = m_pHead;
+        if (m_pHead) m_pHead->pPrev = pNode;
+        m_pHead = pNode;
+        if (!m_pTail) m_pTail = pNode;
+    }
+
+    void trim()
+    {
+        while (m_nTotalBytes > m_nMaxBytes && m_pTail) {
+            stNode *pNode = m_pTail;
+            unlink(pNode);
+            m_hashNodes.remove(pNode->key);
+            m_nTotalBytes -= pNode->cost;
+            delete pNode;
+            m_nEvictions++;
+        }
+    }
+
+    Q_DISABLE_COPY(CLruCache)
+};
+
+#endif // CLRUCACHE_H
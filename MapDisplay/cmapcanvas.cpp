@@ -21,7 +21,7 @@
 #include  <QProcess>
 
 CMapCanvas::CMapCanvas(QWidget *parent) : QgsMapCanvas(parent),
-    _m_ppiLayer(nullptr),_m_trackLayer(nullptr), m_mapLayersVisible(true)
+    _m_ppiLayer(nullptr),_m_trackLayer(nullptr), _m_profilerOverlay(nullptr), m_mapLayersVisible(true)
 {
     QgsRectangle fixedWorldExtent(-180.0, -90.0, 180.0, 90.0);
 
@@ -294,6 +294,47 @@ void CMapCanvas::setMapLayersVisible(bool visible)
     qDebug() << "Map layers visibility set to:" << visible;
 }
 
+void CMapCanvas::setTrackUncertaintyEllipses(int nSigma)
+{
+    if (_m_trackLayer) _m_trackLayer->setUncertaintyEllipseSigma(nSigma);
+}
+
+void CMapCanvas::setTrackDeadReckoning(bool enabled, int maxExtrapolationMs)
+{
+    if (_m_trackLayer) _m_trackLayer->setDeadReckoning(enabled, maxExtrapolationMs);
+}
+
+void CMapCanvas::setTrackThreadedRendering(bool enabled)
+{
+    if (_m_trackLayer) _m_trackLayer->setThreadedRendering(enabled);
+}
+
+void CMapCanvas::setTrackClustering(bool enabled)
+{
+    if (_m_trackLayer) _m_trackLayer->setClustering(enabled);
+}
+
+QList<stRenderCacheStats> CMapCanvas::renderCacheStats() const
+{
+    QList<stRenderCacheStats> listStats;
+    if (_m_ppiLayer) listStats.append(_m_ppiLayer->renderCacheStats());
+    return listStats;
+}
+
+void CMapCanvas::setFrameProfilerVisible(bool visible)
+{
+    if (!_m_profilerOverlay) {
+        if (!visible) return;
+        _m_profilerOverlay = new CFrameProfilerOverlay(this);
+    }
+    _m_profilerOverlay->setActive(visible);
+}
+
+bool CMapCanvas::isFrameProfilerVisible() const
+{
+    return _m_profilerOverlay && _m_profilerOverlay->isActive();
+}
+
 void CMapCanvas::loadShapeFile(const QString &shpPath)
 {
     QgsVectorLayer *layer = new QgsVectorLayer(shpPath, QFileInfo(shpPath).baseName(), "ogr");
@@ -513,6 +554,9 @@ void CMapCanvas::keyPressEvent(QKeyEvent *event)
     case Qt::Key_Minus:
         zoomBy(1.1);      // Zoom out
         break;
+    case Qt::Key_F12:
+        setFrameProfilerVisible(!isFrameProfilerVisible());
+        break;
     default:
         QgsMapCanvas::keyPressEvent(event); // Default handling
         break;
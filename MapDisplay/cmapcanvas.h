@@ -7,6 +7,7 @@
 #include <QPoint>
 #include "cppilayer.h"
 #include "ctracklayer.h"
+#include "cframeprofileroverlay.h"
 #include "qgsrasterlayer.h"
 #include <QProcess>
 #include <QProgressDialog>
@@ -33,6 +34,46 @@ public:
     void importRasterMap(QString inputPath);
     void setMapLayersVisible(bool visible);
     bool areMapLayersVisible() const { return m_mapLayersVisible; }
+
+    /**
+     * @brief Shows track position uncertainty ellipses
+     * @param nSigma 0 hides them, 1 or 2 selects the 1-sigma or 2-sigma ellipse
+     */
+    void setTrackUncertaintyEllipses(int nSigma);
+    /**
+     * @brief Moves track symbols along their velocity between radar reports
+     * @param maxExtrapolationMs Longest extrapolation before a track is held in place
+     */
+    void setTrackDeadReckoning(bool enabled, int maxExtrapolationMs = 3000);
+    /**
+     * @brief Renders the track overlay on a worker thread, the GUI thread only blits it
+     */
+    void setTrackThreadedRendering(bool enabled);
+    /**
+     * @brief Draws dense groups of tracks as one count glyph while zoomed out
+     */
+    void setTrackClustering(bool enabled);
+
+    /**
+     * @brief Hit statistics of the cached static overlays, one entry per cached layer
+     *
+     * The base map itself is cached by the QGIS renderer; canvas item repaints from the
+     * track and beam timers do not re-render it.
+     */
+    QList<stRenderCacheStats> renderCacheStats() const;
+
+    /**
+     * @brief Shows the frame profiler panel and profiles while it is shown; F12 toggles it
+     */
+    void setFrameProfilerVisible(bool visible);
+    bool isFrameProfilerVisible() const;
+
+    /**
+     * @brief Per-layer paint times, frame pacing, track counts and cache hit rates
+     *
+     * Usable without the panel: enable it, read the figures or capture them to a file.
+     */
+    CFrameProfiler *frameProfiler() { return CFrameProfiler::forCanvas(this); }
 private:
 
     QProcess* m_translateProcess = nullptr;
@@ -54,6 +95,7 @@ private:
 
     CPPILayer *_m_ppiLayer;
     CTrackLayer *_m_trackLayer;
+    CFrameProfilerOverlay *_m_profilerOverlay;
     bool m_mapLayersVisible;
     QList<QgsMapLayer*> m_mapLayers; // Store map layers separately from PPI/track layers
     void _loadLayers();
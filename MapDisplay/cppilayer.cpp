@@ -3,7 +3,8 @@
 #include "globalmacros.h"
 
 CPPILayer::CPPILayer(QgsMapCanvas *canvas) : QgsMapCanvasItem(canvas),
-    _m_canvas(canvas), _m_searchbeamLayer(nullptr)
+    _m_canvas(canvas), _m_searchbeamLayer(nullptr), m_staticCache("PPI overlay"),
+    m_pProfiler(CFrameProfiler::forCanvas(canvas)), m_pScheduler(CFrameScheduler::forCanvas(canvas))
 {
     setZValue(100);
 
@@ -30,18 +31,21 @@ void CPPILayer::setMaxRange(double rangeMeters)
     }
     m_maxRange = rangeMeters;
     update();
+    m_pScheduler->requestFrame();
 }
 
 void CPPILayer::setRangeRingCount(int count)
 {
     m_ringCount = count;
     update();
+    m_pScheduler->requestFrame();
 }
 
 void CPPILayer::setAzimuthStep(int degrees)
 {
     m_azimuthStep = degrees;
     update();
+    m_pScheduler->requestFrame();
 }
 
 void CPPILayer::updatePosition()
@@ -50,6 +54,7 @@ void CPPILayer::updatePosition()
     m_centerScreen = mapToPixel.transform(m_center).toQPointF();
     //qDebug()<<m_centerScreen.x()<<m_centerScreen.y();
     update();
+    m_pScheduler->requestFrame();
 }
 
 QRectF CPPILayer::boundingRect() const
@@ -86,18 +91,42 @@ void CPPILayer::paint(QPainter *painter)
 {
     if (!canvas()) return;
 
-    double metersPerDegreeLat = 111132.0; // avg for latitude
-    double metersPerDegreeLon = 111320.0 * std::cos(qDegreesToRadians(m_center.y())); // depends on latitude
-
+    CProfileScope profileScope(m_pProfiler, QStringLiteral("CPPILayer"));
 
-    painter->setRenderHint(QPainter::Antialiasing, true);
-    double radiusStep = m_maxRange / m_ringCount;
     double pixelPerDegree = 1.0 / canvas()->mapUnitsPerPixel();
-
     if ( pixelPerDegree < PPI_VISIBLE_THRESHOLD) {
         return;
     }
 
+    painter->setRenderHint(QPainter::Antialiasing, true);
+
+    // The overlay only changes with the view and the PPI settings; the timers that
+    // repaint tracks and the beam get the cached image
+    quint64 fingerprint = CRenderCache::hashMapSettings(canvas()->mapSettings());
+    fingerprint = CRenderCache::hashCombine(fingerprint, m_center.x());
+    fingerprint = CRenderCache::hashCombine(fingerprint, m_center.y());
+    fingerprint = CRenderCache::hashCombine(fingerprint, m_maxRange);
+    fingerprint = CRenderCache::hashCombine(fingerprint, m_ringCount);
+    fingerprint = CRenderCache::hashCombine(fingerprint, m_azimuthStep);
+    fingerprint = CRenderCache::hashCombine(fingerprint, m_centerScreen.x());
+    fingerprint = CRenderCache::hashCombine(fingerprint, m_centerScreen.y());
+
+    // Azimuth labels sit just outside the outer ring
+    QRectF rect = boundingRect().adjusted(-40, -40, 40, 40).intersected(QRectF(canvas()->rect()));
+    m_staticCache.draw(painter, rect, fingerprint, [this](QPainter *p) { paintStatic(p); });
+
+    const stRenderCacheStats &stats = m_staticCache.stats();
+    m_pProfiler->reportCache(stats.name, stats.hits, stats.renders);
+}
+
+void CPPILayer::paintStatic(QPainter *painter)
+{
+    double metersPerDegreeLat = 111132.0; // avg for latitude
+    double metersPerDegreeLon = 111320.0 * std::cos(qDegreesToRadians(m_center.y())); // depends on latitude
+
+    double radiusStep = m_maxRange / m_ringCount;
+    double pixelPerDegree = 1.0 / canvas()->mapUnitsPerPixel();
+
     double pixelPerMeterX = pixelPerDegree / metersPerDegreeLon;
     double pixelPerMeterY = pixelPerDegree / metersPerDegreeLat;
 
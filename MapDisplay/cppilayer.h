@@ -4,6 +4,9 @@
 #include <qgsmapcanvas.h>
 #include <qgsmapcanvasitem.h>
 #include "csearchbeamlayer.h"
+#include "crendercache.h"
+#include "cframeprofiler.h"
+#include "cframescheduler.h"
 
 class CPPILayer : public QObject,public QgsMapCanvasItem
 {
@@ -20,6 +23,11 @@ public:
 
     QgsRectangle boundingRectWorld() const;
 
+    /**
+     * @brief Hit and render figures of the cached rings, azimuth lines and labels
+     */
+    const stRenderCacheStats &renderCacheStats() const { return m_staticCache.stats(); }
+
 protected:
     QRectF boundingRect() const override;
 
@@ -39,6 +47,15 @@ private:
 
     QPointF m_centerScreen;  // canvas pixel coordinates
     QgsMapCanvas *canvas();
+
+    CRenderCache m_staticCache;  //!< Rings, azimuth lines and labels, re-rendered on view changes
+    CFrameProfiler *m_pProfiler; //!< Canvas profiler, owned by the canvas
+    CFrameScheduler *m_pScheduler; //!< Canvas clock, asked for a tick on every change
+
+    /**
+     * @brief Paints the range rings, azimuth lines and their labels
+     */
+    void paintStatic(QPainter *painter);
 };
 
 #endif // CPPILAYER_H
@@ -0,0 +1,97 @@
+#include "crendercache.h"
+#include <qgsmapsettings.h>
+#include <QElapsedTimer>
+#include <QPainter>
+#include <QtMath>
+#include <cstring>
+
+CRenderCache::CRenderCache(const QString &name)
+    : m_nFingerprint(0), m_dDevicePixelRatio(1.0), m_bValid(false)
+{
+    m_stats = stRenderCacheStats();
+    m_stats.name = name;
+}
+
+void CRenderCache::draw(QPainter *pPainter, const QRectF &rect, quint64 fingerprint,
+                        const std::function<void(QPainter *)> &render)
+{
+    const QRect target = rect.toAlignedRect();
+    if (target.isEmpty()) {
+        return;
+    }
+    const qreal dpr = pPainter->device() ? pPainter->device()->devicePixelRatioF() : 1.0;
+
+    if (!m_bValid || fingerprint != m_nFingerprint || QRectF(target) != m_rect || dpr != m_dDevicePixelRatio) {
+        QElapsedTimer timer;
+        timer.start();
+
+        QSize pixelSize(qCeil(target.width() * dpr), qCeil(target.height() * dpr));
+        if (m_image.size() != pixelSize) {
+            m_image = QImage(pixelSize, QImage::Format_ARGB32_Premultiplied);
+        }
+        m_image.setDevicePixelRatio(dpr);
+        m_image.fill(Qt::transparent);
+
+        // Same coordinates and hints the item painter would give the overlay
+        QPainter imagePainter(&m_image);
+        imagePainter.setRenderHints(pPainter->renderHints());
+        imagePainter.setFont(pPainter->font());
+        imagePainter.translate(-target.topLeft());
+        render(&imagePainter);
+        imagePainter.end();
+
+        m_rect = QRectF(target);
+        m_nFingerprint = fingerprint;
+        m_dDevicePixelRatio = dpr;
+        m_bValid = true;
+
+        m_stats.renders++;
+        m_stats.lastRenderMs = timer.nsecsElapsed() / 1.0e6;
+        m_stats.totalRenderMs += m_stats.lastRenderMs;
+        m_stats.memoryBytes = m_image.sizeInBytes();
+    } else {
+        m_stats.hits++;
+    }
+
+    pPainter->drawImage(m_rect.topLeft(), m_image);
+}
+
+void CRenderCache::invalidate()
+{
+    m_bValid = false;
+}
+
+void CRenderCache::resetStats()
+{
+    QString name = m_stats.name;
+    qint64 memoryBytes = m_stats.memoryBytes;
+    m_stats = stRenderCacheStats();
+    m_stats.name = name;
+    m_stats.memoryBytes = memoryBytes;
+}
+
+quint64 CRenderCache::hashCombine(quint64 hash, double value)
+{
+    // FNV-1a over the bytes of the value
+    unsigned char bytes[sizeof(double)];
+    std::memcpy(bytes, &value, sizeof(double));
+    for (unsigned char b : bytes) {
+        hash = (hash ^ b) * 1099511628211ull;
+    }
+    return hash;
+}
+
+quint64 CRenderCache::hashMapSettings(const QgsMapSettings &settings)
+{
+    const QgsRectangle extent = settings.visibleExtent();
+    quint64 hash = 1469598103934665603ull;
+    hash = hashCombine(hash, extent.xMinimum());
+    hash = hashCombine(hash, extent.yMinimum());
+    hash = hashCombine(hash, extent.xMaximum());
+    hash = hashCombine(hash, extent.yMaximum());
+    hash = hashCombine(hash, settings.outputSize().width());
+    hash = hashCombine(hash, settings.outputSize().height());
+    hash = hashCombine(hash, settings.rotation());
+    hash = hashCombine(hash, settings.outputDpi());
+    return hash;
+}
@@ -0,0 +1,72 @@
+#ifndef CRENDERCACHE_H
+#define CRENDERCACHE_H
+
+#include <QImage>
+#include <QRectF>
+#include <QString>
+#include <functional>
+
+class QPainter;
+class QgsMapSettings;
+
+/**
+ * @brief Hit and render figures of one CRenderCache
+ */
+struct stRenderCacheStats {
+    QString name;               //!< Layer the cache belongs to
+    quint64 hits;               //!< Frames served from the cached image
+    quint64 renders;            //!< Frames that re-rendered the layer
+    double lastRenderMs;        //!< Time of the last re-render
+    double totalRenderMs;       //!< Time spent re-rendering since the last reset
+    qint64 memoryBytes;         //!< Size of the cached image
+};
+
+/**
+ * @brief CRenderCache - Static canvas overlay rendered once into an image
+ *
+ * Overlays that only depend on the view (range rings, azimuth lines, their labels)
+ * are painted into a QImage and blitted on every later frame. The caller passes a
+ * fingerprint of everything the overlay depends on, normally hashMapSettings() mixed
+ * with the layer's own parameters through hashCombine(); the overlay is re-rendered
+ * only when the fingerprint, the target rectangle or the device pixel ratio changes.
+ */
+class CRenderCache
+{
+public:
+    explicit CRenderCache(const QString &name);
+
+    /**
+     * @brief Draws the overlay from the cache, re-rendering it first when stale
+     * @param pPainter Painter of the canvas item
+     * @param rect Item area the overlay covers, the image is this size
+     * @param fingerprint Hash of everything the overlay depends on
+     * @param render Paints the overlay in item coordinates
+     */
+    void draw(QPainter *pPainter, const QRectF &rect, quint64 fingerprint,
+              const std::function<void(QPainter *)> &render);
+
+    /**
+     * @brief Forces a re-render on the next draw()
+     */
+    void invalidate();
+
+    const stRenderCacheStats &stats() const { return m_stats; }
+    void resetStats();
+
+    /**
+     * @brief Fingerprint of the map view: extent, output size, rotation and DPI
+     */
+    static quint64 hashMapSettings(const QgsMapSettings &settings);
+
+    static quint64 hashCombine(quint64 hash, double value);
+
+private:
+    QImage m_image;
+    QRectF m_rect;
+    quint64 m_nFingerprint;
+    qreal m_dDevicePixelRatio;
+    bool m_bValid;
+    stRenderCacheStats m_stats;
+};
+
+#endif // CRENDERCACHE_H
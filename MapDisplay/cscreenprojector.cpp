@@ -0,0 +1,68 @@
+#include "cscreenprojector.h"
+#include <qgsmaptopixel.h>
+#include <qgspointxy.h>
+
+CScreenProjector::CScreenProjector()
+    : m_bValid(false), m_dAnchorX(0), m_dAnchorY(0),
+      m_dA(1), m_dB(0), m_dC(0), m_dD(0), m_dE(1), m_dF(0)
+{
+}
+
+bool CScreenProjector::setMapToPixel(const QgsMapToPixel &mapToPixel, const QgsPointXY &anchor)
+{
+    // Three samples fix an affine map exactly, unit steps keep them well conditioned
+    QgsPointXY p0 = mapToPixel.transform(anchor);
+    QgsPointXY px = mapToPixel.transform(QgsPointXY(anchor.x() + 1.0, anchor.y()));
+    QgsPointXY py = mapToPixel.transform(QgsPointXY(anchor.x(), anchor.y() + 1.0));
+
+    double a = px.x() - p0.x(), b = py.x() - p0.x();
+    double d = px.y() - p0.y(), e = py.y() - p0.y();
+
+    bool changed = !m_bValid ||
+            anchor.x() != m_dAnchorX || anchor.y() != m_dAnchorY ||
+            a != m_dA || b != m_dB || p0.x() != m_dC ||
+            d != m_dD || e != m_dE || p0.y() != m_dF;
+
+    m_dAnchorX = anchor.x();
+    m_dAnchorY = anchor.y();
+    m_dA = a; m_dB = b; m_dC = p0.x();
+    m_dD = d; m_dE = e; m_dF = p0.y();
+    m_bValid = true;
+
+    return changed;
+}
+
+void CScreenProjector::project(int n, const double *pX, const double *pY, double *pScreenX, double *pScreenY) const
+{
+    // Coefficients in locals so the compiler does not reload them through 'this'
+    const double x0 = m_dAnchorX, y0 = m_dAnchorY;
+    const double a = m_dA, b = m_dB, c = m_dC;
+    const double d = m_dD, e = m_dE, f = m_dF;
+
+    for (int i = 0; i < n; ++i) {
+        double dx = pX[i] - x0;
+        double dy = pY[i] - y0;
+        pScreenX[i] = a * dx + b * dy + c;
+        pScreenY[i] = d * dx + e * dy + f;
+    }
+}
+
+void CScreenProjector::projectExtrapolated(int n, const double *__restrict pX, const double *__restrict pY,
+                                           const double *__restrict pRateX, const double *__restrict pRateY,
+                                           const double *__restrict pTime,
+                                           double *__restrict pScreenX, double *__restrict pScreenY) const
+{
+    // Seven streams are too many for the compiler's runtime alias checks, restrict
+    // lets the loop vectorise
+    const double x0 = m_dAnchorX, y0 = m_dAnchorY;
+    const double a = m_dA, b = m_dB, c = m_dC;
+    const double d = m_dD, e = m_dE, f = m_dF;
+
+    for (int i = 0; i < n; ++i) {
+        double t = pTime[i];
+        double dx = pX[i] + pRateX[i] * t - x0;
+        double dy = pY[i] + pRateY[i] * t - y0;
+        pScreenX[i] = a * dx + b * dy + c;
+        pScreenY[i] = d * dx + e * dy + f;
+    }
+}
@@ -0,0 +1,73 @@
+#ifndef CSCREENPROJECTOR_H
+#define CSCREENPROJECTOR_H
+
+#include <QPointF>
+
+class QgsMapToPixel;
+class QgsPointXY;
+
+/**
+ * @brief CScreenProjector - Map to screen projection for whole coordinate arrays
+ *
+ * QgsMapToPixel is an affine map (scale, rotation, offset). The projector samples it
+ * once per frame and keeps the six coefficients, relative to an anchor near the view
+ * so the offsets stay small, and projects arrays with a branch-free loop:
+ *
+ *   sx = a * (x - x0) + b * (y - y0) + c
+ *   sy = d * (x - x0) + e * (y - y0) + f
+ */
+class CScreenProjector
+{
+public:
+    CScreenProjector();
+
+    /**
+     * @brief Samples the affine coefficients of a map to pixel transform
+     * @param mapToPixel Current canvas transform
+     * @param anchor Map point near the view, usually the extent centre
+     * @return true if the coefficients changed since the previous call
+     */
+    bool setMapToPixel(const QgsMapToPixel &mapToPixel, const QgsPointXY &anchor);
+
+    /**
+     * @brief Projects n map points to screen, outputs may not alias inputs
+     * @param n Number of points
+     * @param pX Map X (longitude) array
+     * @param pY Map Y (latitude) array
+     * @param pScreenX Screen X output array
+     * @param pScreenY Screen Y output array
+     */
+    void project(int n, const double *pX, const double *pY, double *pScreenX, double *pScreenY) const;
+
+    /**
+     * @brief Projects n map points moved along their rates, outputs may not alias inputs
+     *
+     * Each point is first advanced to x + rateX * t, y + rateY * t (one multiply-add per
+     * axis) and then projected, all in the same pass.
+     * @param pRateX Map X rate array (units per second)
+     * @param pRateY Map Y rate array (units per second)
+     * @param pTime Extrapolation time per point (seconds)
+     */
+    void projectExtrapolated(int n, const double *pX, const double *pY,
+                             const double *pRateX, const double *pRateY, const double *pTime,
+                             double *pScreenX, double *pScreenY) const;
+
+    /**
+     * @brief Projects a single map point
+     */
+    inline QPointF project(double x, double y) const
+    {
+        double dx = x - m_dAnchorX, dy = y - m_dAnchorY;
+        return QPointF(m_dA * dx + m_dB * dy + m_dC, m_dD * dx + m_dE * dy + m_dF);
+    }
+
+    bool isValid() const { return m_bValid; }
+
+private:
+    bool m_bValid;
+    double m_dAnchorX, m_dAnchorY;      //!< Map point the coefficients are relative to
+    double m_dA, m_dB, m_dC;            //!< Screen X row
+    double m_dD, m_dE, m_dF;            //!< Screen Y row
+};
+
+#endif // CSCREENPROJECTOR_H
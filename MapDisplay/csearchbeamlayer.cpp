@@ -5,17 +5,46 @@
 #include <QtMath>
 #include "globalmacros.h"
 
+namespace {
+
+// 60 RPM, redrawn at 20 FPS
+const double kSweepPeriodMs = 1000.0;
+const int kSweepFrameMs = 50;
+
+} // namespace
+
 CSearchBeamLayer::CSearchBeamLayer(QgsMapCanvas *canvas)
-    : QgsMapCanvasItem(canvas), _m_canvas(canvas)
+    : QgsMapCanvasItem(canvas), _m_canvas(canvas), m_pScheduler(CFrameScheduler::forCanvas(canvas)),
+      m_pProfiler(CFrameProfiler::forCanvas(canvas))
 {
     setZValue(102);
 
-    connect(&_animationTimer, &QTimer::timeout, this, [this]() {
-           _sweepAngle += 18.0;  // 60 RPM: 360 degrees/sec at 20 FPS = 18 degrees/update
-           if (_sweepAngle >= 360.0) _sweepAngle = 0.0;
-           update();  // Trigger repaint
-       });
-       _animationTimer.start(50);  // 20 FPS - reduced from 100 FPS for better performance
+    connect(m_pScheduler, &CFrameScheduler::signalFrame, this, [this](qint64 nowMs) {
+        onFrame(nowMs);
+    });
+    updateAnimationState();
+}
+
+void CSearchBeamLayer::onFrame(qint64 nowMs)
+{
+    if (!m_pScheduler->isAnimationRunning(this)) {
+        return;
+    }
+
+    // From the clock, not the tick count, so late ticks do not slow the sweep
+    _sweepAngle = std::fmod(double(nowMs), kSweepPeriodMs) * 360.0 / kSweepPeriodMs;
+    update();  // Trigger repaint
+    updateAnimationState();
+}
+
+void CSearchBeamLayer::updateAnimationState()
+{
+    // paint() draws nothing below the PPI scale
+    if (isVisible() && 1.0 / _m_canvas->mapUnitsPerPixel() >= PPI_VISIBLE_THRESHOLD) {
+        m_pScheduler->startAnimation(this, kSweepFrameMs);
+    } else {
+        m_pScheduler->stopAnimation(this);
+    }
 }
 
 QgsMapCanvas *CSearchBeamLayer::canvas() {
@@ -32,6 +61,7 @@ void CSearchBeamLayer::setMaxRange(double rangeMeters)
 {
     m_maxRange = rangeMeters;
     update();
+    m_pScheduler->requestFrame();
 }
 
 void CSearchBeamLayer::updatePosition()
@@ -40,6 +70,10 @@ void CSearchBeamLayer::updatePosition()
     m_centerScreen = mapToPixel.transform(m_center).toQPointF();
     //qDebug()<<m_centerScreen.x()<<m_centerScreen.y();
     update();
+    m_pScheduler->requestFrame();
+
+    // Zooming back in restarts the sweep
+    updateAnimationState();
 }
 
 QRectF CSearchBeamLayer::boundingRect() const
@@ -56,6 +90,8 @@ void CSearchBeamLayer::paint(QPainter *painter)
 {
     if (!canvas()) return;
 
+    CProfileScope profileScope(m_pProfiler, QStringLiteral("CSearchBeamLayer"));
+
     double metersPerDegreeLat = 111132.0; // avg for latitude
     double metersPerDegreeLon = 111320.0 * std::cos(qDegreesToRadians(m_center.y())); // depends on latitude
 
@@ -5,12 +5,13 @@
 
 #include <qgsmapcanvas.h>
 #include <qgsmapcanvasitem.h>
-#include <QTimer>
 #include <QPainter>
 #include <QPen>
 #include <QBrush>
 #include <QFont>
 #include <cmath>
+#include "cframescheduler.h"
+#include "cframeprofiler.h"
 
 class CSearchBeamLayer : public QObject,public QgsMapCanvasItem
 {
@@ -29,9 +30,22 @@ protected:
     QgsPointXY m_center;
     double m_maxRange = 5000; // meters
 
-    QTimer _animationTimer;
+    CFrameScheduler *m_pScheduler;  //!< Canvas animation clock, the sweep runs on it while it is drawn
+    CFrameProfiler *m_pProfiler;    //!< Canvas profiler, owned by the canvas
     double _sweepAngle = 0.0;
 
+    /**
+     * @brief Sets the sweep angle from the frame time
+     */
+    void onFrame(qint64 nowMs);
+
+    /**
+     * @brief Runs the sweep animation only while the beam is visible at this scale
+     *
+     * A hidden or zoomed-out beam costs nothing; a view change starts it again.
+     */
+    void updateAnimationState();
+
     void updatePosition() override;  // call this when center or canvas changes
 
     QPointF m_centerScreen;  // canvas pixel coordinates
@@ -0,0 +1,155 @@
+#include "ctrackclusterer.h"
+#include <QtMath>
+#include <cmath>
+
+namespace {
+
+// Cell edge at level 0, about 110 m of latitude
+const double kBaseCellDeg = 1.0 / 1024.0;
+
+// Top level cells are 64 degrees, enough for a theatre-wide view
+const int kMaxLevel = 16;
+
+} // namespace
+
+int stTrackClusterCell::dominantIdentity() const
+{
+    // Slot order unknown, friend, hostile, other; hostile wins ties, then unknown
+    static const int kTieOrder[CTrackSymbolAtlas::kIdentityCount] = { 2, 0, 1, 3 };
+    int best = kTieOrder[0];
+    for (int i = 1; i < CTrackSymbolAtlas::kIdentityCount; ++i) {
+        if (identityCounts[kTieOrder[i]] > identityCounts[best]) {
+            best = kTieOrder[i];
+        }
+    }
+    return best;
+}
+
+CTrackClusterer::CTrackClusterer()
+    : m_nLevel(-1), m_nGeneration(0)
+{
+}
+
+int CTrackClusterer::levelForScale(double pixelPerDegree, double cellPx)
+{
+    if (pixelPerDegree <= 0.0) {
+        return kMaxLevel;
+    }
+    double cellDeg = cellPx / pixelPerDegree;
+    int level = int(std::ceil(std::log2(cellDeg / kBaseCellDeg)));
+    return qBound(0, level, kMaxLevel);
+}
+
+double CTrackClusterer::cellDegrees(int level)
+{
+    return std::ldexp(kBaseCellDeg, level);
+}
+
+quint64 CTrackClusterer::cellKey(double lon, double lat) const
+{
+    const double cellDeg = cellDegrees(m_nLevel);
+    qint32 cx = qint32(std::floor(lon / cellDeg));
+    qint32 cy = qint32(std::floor(lat / cellDeg));
+    return (quint64(quint32(cx)) << 32) | quint32(cy);
+}
+
+void CTrackClusterer::addToCell(quint64 cell, double lon, double lat, int identity)
+{
+    QHash<quint64, stTrackClusterCell>::iterator it = m_hashCells.find(cell);
+    if (it == m_hashCells.end()) {
+        stTrackClusterCell empty = {};
+        it = m_hashCells.insert(cell, empty);
+    }
+    stTrackClusterCell &cellData = it.value();
+    cellData.count++;
+    cellData.identityCounts[identity]++;
+    cellData.sumLon += lon;
+    cellData.sumLat += lat;
+}
+
+void CTrackClusterer::removeFromCell(quint64 cell, double lon, double lat, int identity)
+{
+    QHash<quint64, stTrackClusterCell>::iterator it = m_hashCells.find(cell);
+    if (it == m_hashCells.end()) {
+        return;
+    }
+    stTrackClusterCell &cellData = it.value();
+    if (--cellData.count <= 0) {
+        m_hashCells.erase(it);
+        return;
+    }
+    cellData.identityCounts[identity]--;
+    cellData.sumLon -= lon;
+    cellData.sumLat -= lat;
+}
+
+int CTrackClusterer::update(const QList<stTrackDisplayInfo> &tracks, int level)
+{
+    if (level != m_nLevel) {
+        clear();
+        m_nLevel = level;
+    }
+
+    const int nTracks = tracks.size();
+    m_vecTrackCells.resize(nTracks);
+    m_nGeneration++;
+    int nMoved = 0;
+
+    for (int i = 0; i < nTracks; ++i) {
+        const stTrackDisplayInfo &track = tracks[i];
+        const int identity = CTrackSymbolAtlas::identityIndex(track.nTrackIden);
+        const quint64 cell = cellKey(track.lon, track.lat);
+        m_vecTrackCells[i] = cell;
+
+        QHash<int, stMember>::iterator it = m_hashMembers.find(track.nTrkId);
+        if (it == m_hashMembers.end()) {
+            stMember member = { cell, track.lon, track.lat, identity, m_nGeneration };
+            m_hashMembers.insert(track.nTrkId, member);
+            addToCell(cell, track.lon, track.lat, identity);
+            nMoved++;
+            continue;
+        }
+
+        stMember &member = it.value();
+        if (member.cell == cell && member.identity == identity) {
+            // Same cell, only the centroid sums move
+            stTrackClusterCell &cellData = m_hashCells[cell];
+            cellData.sumLon += track.lon - member.lon;
+            cellData.sumLat += track.lat - member.lat;
+        } else {
+            removeFromCell(member.cell, member.lon, member.lat, member.identity);
+            addToCell(cell, track.lon, track.lat, identity);
+            member.cell = cell;
+            member.identity = identity;
+            nMoved++;
+        }
+        member.lon = track.lon;
+        member.lat = track.lat;
+        member.generation = m_nGeneration;
+    }
+
+    // Tracks that are gone
+    if (m_hashMembers.size() > nTracks) {
+        QHash<int, stMember>::iterator it = m_hashMembers.begin();
+        while (it != m_hashMembers.end()) {
+            if (it.value().generation != m_nGeneration) {
+                const stMember &member = it.value();
+                removeFromCell(member.cell, member.lon, member.lat, member.identity);
+                it = m_hashMembers.erase(it);
+                nMoved++;
+            } else {
+                ++it;
+            }
+        }
+    }
+
+    return nMoved;
+}
+
+void CTrackClusterer::clear()
+{
+    m_hashMembers.clear();
+    m_hashCells.clear();
+    m_vecTrackCells.resize(0);
+    m_nLevel = -1;
+}
@@ -0,0 +1,100 @@
+#ifndef CTRACKCLUSTERER_H
+#define CTRACKCLUSTERER_H
+
+#include <QHash>
+#include <QList>
+#include <QPointF>
+#include <QVector>
+#include "ctracksymbolatlas.h"
+#include "../globalstructs.h"
+
+/**
+ * @brief Tracks aggregated into one grid cell
+ */
+struct stTrackClusterCell {
+    int count;
+    int identityCounts[CTrackSymbolAtlas::kIdentityCount];  //!< By CTrackSymbolAtlas::identityIndex()
+    double sumLon;              //!< Centroid is sum / count
+    double sumLat;
+
+    /**
+     * @brief Identity slot with the most members, ties to the more threatening slot
+     */
+    int dominantIdentity() const;
+};
+
+/**
+ * @brief Cluster glyph of one frame, projected and culled
+ */
+struct stTrackCluster {
+    quint64 cell;               //!< CTrackClusterer cell key
+    QPointF screenPos;          //!< Centroid on screen
+    int count;
+    int identity;               //!< Dominant identity slot
+    bool mixed;                 //!< Members of more than one identity
+};
+
+/**
+ * @brief CTrackClusterer - Geographic grid of the tracks for level-of-detail clustering
+ *
+ * Tracks are binned into square cells whose edge doubles per level; the level is picked
+ * from the map scale so a cell stays about the same size on screen. Each cell keeps its
+ * member count, identity histogram and coordinate sums. update() with a new track list
+ * at the same level only moves the tracks whose cell changed and adjusts the sums of the
+ * rest, so a data refresh costs one hash lookup per track; a zoom that changes the level
+ * rebuilds the grid once.
+ */
+class CTrackClusterer
+{
+public:
+    CTrackClusterer();
+
+    /**
+     * @brief Grid level whose cells are about cellPx wide at a map scale
+     */
+    static int levelForScale(double pixelPerDegree, double cellPx);
+
+    /**
+     * @brief Cell edge of a level in degrees
+     */
+    static double cellDegrees(int level);
+
+    /**
+     * @brief Brings the grid up to date with a track list
+     * @param tracks Current tracks; trackCells() follows this order afterwards
+     * @param level Grid level, a different level than last time rebuilds
+     * @return Tracks that changed cell, or all of them on a rebuild
+     */
+    int update(const QList<stTrackDisplayInfo> &tracks, int level);
+
+    int level() const { return m_nLevel; }
+    const QHash<quint64, stTrackClusterCell> &cells() const { return m_hashCells; }
+
+    /**
+     * @brief Cell key of each track of the last update(), same order
+     */
+    const QVector<quint64> &trackCells() const { return m_vecTrackCells; }
+
+    void clear();
+
+private:
+    struct stMember {
+        quint64 cell;
+        double lon;
+        double lat;
+        int identity;
+        quint32 generation;     //!< Last update() that listed the track
+    };
+
+    QHash<int, stMember> m_hashMembers;                 //!< Key: track ID
+    QHash<quint64, stTrackClusterCell> m_hashCells;
+    QVector<quint64> m_vecTrackCells;
+    int m_nLevel;
+    quint32 m_nGeneration;
+
+    quint64 cellKey(double lon, double lat) const;
+    void addToCell(quint64 cell, double lon, double lat, int identity);
+    void removeFromCell(quint64 cell, double lon, double lat, int identity);
+};
+
+#endif // CTRACKCLUSTERER_H
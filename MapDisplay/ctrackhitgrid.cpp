@@ -0,0 +1,101 @@
+#include "ctrackhitgrid.h"
+#include <QtMath>
+#include <cmath>
+
+CTrackHitGrid::CTrackHitGrid()
+    : m_dLeft(0.0), m_dTop(0.0), m_dInvCellPx(1.0), m_nCols(0), m_nRows(0)
+{
+}
+
+int CTrackHitGrid::column(double x) const
+{
+    // Clamped in floating point first, far off-screen positions do not fit an int
+    double col = std::floor((x - m_dLeft) * m_dInvCellPx);
+    return int(qBound(0.0, col, double(m_nCols - 1)));
+}
+
+int CTrackHitGrid::row(double y) const
+{
+    double r = std::floor((y - m_dTop) * m_dInvCellPx);
+    return int(qBound(0.0, r, double(m_nRows - 1)));
+}
+
+void CTrackHitGrid::build(const QRectF &rect, double cellPx, const QVector<int> &indices,
+                          const double *pScreenX, const double *pScreenY)
+{
+    cellPx = qMax(1.0, cellPx);
+    m_dLeft = rect.left();
+    m_dTop = rect.top();
+    m_dInvCellPx = 1.0 / cellPx;
+    m_nCols = qMax(1, qCeil(rect.width() * m_dInvCellPx));
+    m_nRows = qMax(1, qCeil(rect.height() * m_dInvCellPx));
+
+    // Counting sort by cell: count, prefix sum, scatter
+    const int nCells = m_nCols * m_nRows;
+    const int nEntries = indices.size();
+    m_vecCellStart.fill(0, nCells + 1);
+    m_vecEntryCell.resize(nEntries);
+    for (int k = 0; k < nEntries; ++k) {
+        const int i = indices[k];
+        const int cell = row(pScreenY[i]) * m_nCols + column(pScreenX[i]);
+        m_vecEntryCell[k] = cell;
+        m_vecCellStart[cell + 1]++;
+    }
+    for (int c = 0; c < nCells; ++c) {
+        m_vecCellStart[c + 1] += m_vecCellStart[c];
+    }
+
+    m_vecEntries.resize(nEntries);
+    m_vecX.resize(nEntries);
+    m_vecY.resize(nEntries);
+    // Scatter from the back so each cell keeps the input order; the end of cell c,
+    // start[c + 1], is its cursor and ends up on the cell's start
+    for (int k = nEntries - 1; k >= 0; --k) {
+        const int slot = --m_vecCellStart[m_vecEntryCell[k] + 1];
+        const int i = indices[k];
+        m_vecEntries[slot] = i;
+        m_vecX[slot] = pScreenX[i];
+        m_vecY[slot] = pScreenY[i];
+    }
+    for (int c = 0; c < nCells; ++c) {
+        m_vecCellStart[c] = m_vecCellStart[c + 1];
+    }
+    m_vecCellStart[nCells] = nEntries;
+}
+
+int CTrackHitGrid::nearest(const QPointF &pos, double radius) const
+{
+    if (m_vecEntries.isEmpty()) {
+        return -1;
+    }
+
+    const int col0 = column(pos.x() - radius), col1 = column(pos.x() + radius);
+    const int row0 = row(pos.y() - radius), row1 = row(pos.y() + radius);
+
+    int best = -1;
+    double bestDistanceSq = radius * radius;
+    for (int r = row0; r <= row1; ++r) {
+        const int first = m_vecCellStart[r * m_nCols + col0];
+        const int last = m_vecCellStart[r * m_nCols + col1 + 1];
+        // Cells of one row are adjacent in the entry arrays
+        for (int e = first; e < last; ++e) {
+            const double dx = pos.x() - m_vecX[e], dy = pos.y() - m_vecY[e];
+            const double distanceSq = dx * dx + dy * dy;
+            if (distanceSq < bestDistanceSq || (distanceSq == bestDistanceSq && best >= 0 && m_vecEntries[e] < best)) {
+                bestDistanceSq = distanceSq;
+                best = m_vecEntries[e];
+            }
+        }
+    }
+    return best;
+}
+
+void CTrackHitGrid::clear()
+{
+    m_vecCellStart.resize(0);
+    m_vecEntries.resize(0);
+    m_vecX.resize(0);
+    m_vecY.resize(0);
+    m_nCols = 0;
+    m_nRows = 0;
+}
@@ -0,0 +1,63 @@
+#ifndef CTRACKHITGRID_H
+#define CTRACKHITGRID_H
+
+#include <QPointF>
+#include <QRectF>
+#include <QVector>
+
+/**
+ * @brief CTrackHitGrid - Screen-space bins of the drawn tracks for pointer hit testing
+ *
+ * Built once per frame from the projected positions of the culled tracks, so hover,
+ * click and context menu lookups no longer copy the track list or reproject it. The
+ * grid covers the culling rectangle with square cells as large as the detection radius;
+ * a lookup only visits the 3 x 3 cells around the pointer, so it costs about the same
+ * at 10k tracks as at 100. Positions outside the grid land in its border cells.
+ *
+ * Entries are sorted by cell in one counting pass and stored contiguously with their
+ * coordinates, no per-cell containers are allocated.
+ */
+class CTrackHitGrid
+{
+public:
+    CTrackHitGrid();
+
+    /**
+     * @brief Rebins the tracks of a frame
+     * @param rect Screen area the cells cover
+     * @param cellPx Cell edge, at least the radius later passed to nearest()
+     * @param indices Track indices to bin, e.g. the visible tracks in paint order
+     * @param pScreenX Screen X by track index
+     * @param pScreenY Screen Y by track index
+     */
+    void build(const QRectF &rect, double cellPx, const QVector<int> &indices,
+               const double *pScreenX, const double *pScreenY);
+
+    /**
+     * @brief Closest binned track to a screen position
+     * @param pos Screen position
+     * @param radius Largest distance that counts as a hit, at most the cell edge
+     * @return Track index, the lower index on a tie, or -1 if none is within radius
+     */
+    int nearest(const QPointF &pos, double radius) const;
+
+    int size() const { return m_vecEntries.size(); }
+    void clear();
+
+private:
+    double m_dLeft;
+    double m_dTop;
+    double m_dInvCellPx;
+    int m_nCols;
+    int m_nRows;
+    QVector<int> m_vecCellStart;    //!< Entries of cell c are [start[c], start[c+1])
+    QVector<int> m_vecEntries;      //!< Track indices sorted by cell
+    QVector<double> m_vecX;         //!< Screen position of each entry
+    QVector<double> m_vecY;
+    QVector<int> m_vecEntryCell;    //!< Scratch: cell of each input index
+
+    int column(double x) const;
+    int row(double y) const;
+};
+
+#endif // CTRACKHITGRID_H
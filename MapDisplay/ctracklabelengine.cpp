@@ -0,0 +1,171 @@
+#include "ctracklabelengine.h"
+#include <QElapsedTimer>
+#include <QFontMetricsF>
+#include <QtMath>
+#include <algorithm>
+
+namespace {
+
+// Occupancy grid cell edge; labels are about 30 x 16 px
+const int kGridCellPx = 8;
+
+// Gap between the symbol centre and the label
+const qreal kLabelOffsetPx = 6.0;
+
+// Placements tried around the symbol: right-above, left-above, right-below, left-below
+const int kSlotCount = 4;
+
+// Shaped labels kept, charged at a nominal cost each
+const qint64 kShapedLabelBytes = 256;
+const qint64 kShapedLabelBudget = 4096 * kShapedLabelBytes;
+
+} // namespace
+
+CTrackLabelEngine::CTrackLabelEngine()
+    : m_dAscent(0.0), m_shapedLabels(kShapedLabelBudget), m_nGridColumns(0), m_nGridRows(0),
+      m_nMaxLabels(300), m_dLayoutMs(0.0)
+{
+    setFont(QFont("century", 11, 80, true));
+}
+
+void CTrackLabelEngine::setFont(const QFont &font)
+{
+    m_font = font;
+    m_dAscent = QFontMetricsF(m_font).ascent();
+    m_shapedLabels.clear();
+}
+
+void CTrackLabelEngine::setMaxLabels(int nMaxLabels)
+{
+    m_nMaxLabels = qMax(0, nMaxLabels);
+}
+
+void CTrackLabelEngine::begin(const QSize &viewSize)
+{
+    m_vecCandidates.resize(0);
+    m_vecPlaced.resize(0);
+
+    m_nGridColumns = (viewSize.width() + kGridCellPx - 1) / kGridCellPx;
+    m_nGridRows = (viewSize.height() + kGridCellPx - 1) / kGridCellPx;
+    m_vecGrid.fill(0, qMax(0, m_nGridColumns * m_nGridRows));
+}
+
+int CTrackLabelEngine::addLabel(int trackId, const QPointF &anchor, int priority)
+{
+    stCandidate candidate;
+    candidate.trackId = trackId;
+    candidate.anchor = anchor;
+    candidate.priority = priority;
+    candidate.slot = -1;
+    m_vecCandidates.append(candidate);
+    return m_vecCandidates.size() - 1;
+}
+
+double CTrackLabelEngine::layout()
+{
+    QElapsedTimer timer;
+    timer.start();
+
+    // Highest priority first, paint order within a priority
+    const int nCandidates = m_vecCandidates.size();
+    m_vecOrder.resize(nCandidates);
+    for (int i = 0; i < nCandidates; ++i) {
+        m_vecOrder[i] = i;
+    }
+    const QVector<stCandidate> &vecCandidates = m_vecCandidates;
+    std::stable_sort(m_vecOrder.begin(), m_vecOrder.end(), [&vecCandidates](int a, int b) {
+        return vecCandidates[a].priority > vecCandidates[b].priority;
+    });
+
+    for (int nCandidate : m_vecOrder) {
+        if (m_vecPlaced.size() >= m_nMaxLabels) {
+            break;
+        }
+
+        stCandidate &candidate = m_vecCandidates[nCandidate];
+        stShapedLabel label = shapedLabel(candidate.trackId);
+        const qreal w = label.size.width();
+        const qreal h = label.size.height();
+        const qreal x = candidate.anchor.x(), y = candidate.anchor.y();
+
+        // The first slot is where labels always went, baseline at the offset above the symbol
+        const QPointF topLefts[kSlotCount] = {
+            QPointF(x + kLabelOffsetPx, y - kLabelOffsetPx - m_dAscent),
+            QPointF(x - kLabelOffsetPx - w, y - kLabelOffsetPx - m_dAscent),
+            QPointF(x + kLabelOffsetPx, y + kLabelOffsetPx),
+            QPointF(x - kLabelOffsetPx - w, y + kLabelOffsetPx)
+        };
+
+        for (int slot = 0; slot < kSlotCount; ++slot) {
+            if (occupy(QRectF(topLefts[slot], QSizeF(w, h)))) {
+                candidate.slot = slot;
+                stPlacedLabel placed;
+                placed.text = label.text;
+                placed.topLeft = topLefts[slot];
+                m_vecPlaced.append(placed);
+                break;
+            }
+        }
+    }
+
+    m_dLayoutMs = timer.nsecsElapsed() / 1.0e6;
+    return m_dLayoutMs;
+}
+
+void CTrackLabelEngine::draw(QPainter *pPainter, const QColor &color)
+{
+    if (m_vecPlaced.isEmpty()) {
+        return;
+    }
+
+    pPainter->setFont(m_font);
+    pPainter->setPen(color);
+    for (const stPlacedLabel &placed : m_vecPlaced) {
+        pPainter->drawStaticText(placed.topLeft, placed.text);
+    }
+}
+
+CTrackLabelEngine::stShapedLabel CTrackLabelEngine::shapedLabel(int trackId)
+{
+    const quint64 key = CLruCache<stShapedLabel>::makeKey(quint32(trackId));
+    if (const stShapedLabel *pCached = m_shapedLabels.find(key)) {
+        return *pCached;
+    }
+
+    // Shaped once; later frames only blit the glyph run
+    stShapedLabel label;
+    label.text.setText(QString::number(trackId));
+    label.text.setTextFormat(Qt::PlainText);
+    label.text.setPerformanceHint(QStaticText::AggressiveCaching);
+    label.text.prepare(QTransform(), m_font);
+    label.size = label.text.size();
+    m_shapedLabels.insert(key, label, kShapedLabelBytes);
+    return label;
+}
+
+bool CTrackLabelEngine::occupy(const QRectF &rect)
+{
+    const int left = qFloor(rect.left()) / kGridCellPx;
+    const int top = qFloor(rect.top()) / kGridCellPx;
+    const int right = qFloor(rect.right()) / kGridCellPx;
+    const int bottom = qFloor(rect.bottom()) / kGridCellPx;
+    if (rect.left() < 0 || rect.top() < 0 || right >= m_nGridColumns || bottom >= m_nGridRows) {
+        return false;
+    }
+
+    for (int row = top; row <= bottom; ++row) {
+        const quint8 *pRow = m_vecGrid.constData() + row * m_nGridColumns;
+        for (int col = left; col <= right; ++col) {
+            if (pRow[col]) {
+                return false;
+            }
+        }
+    }
+    for (int row = top; row <= bottom; ++row) {
+        quint8 *pRow = m_vecGrid.data() + row * m_nGridColumns;
+        for (int col = left; col <= right; ++col) {
+            pRow[col] = 1;
+        }
+    }
+    return true;
+}
@@ -0,0 +1,115 @@
+#ifndef CTRACKLABELENGINE_H
+#define CTRACKLABELENGINE_H
+
+#include <QFont>
+#include <QPainter>
+#include <QStaticText>
+#include <QVector>
+#include "clrucache.h"
+
+/**
+ * @brief CTrackLabelEngine - Places and draws track number labels without overlaps
+ *
+ * Labels are shaped once per track into a QStaticText and kept in an LRU cache for the
+ * current font. Each frame the candidates are placed by priority, first free spot out
+ * of four around the symbol, against a screen-space occupancy grid; labels that find
+ * no room, or come after the label budget is spent, are dropped for that frame.
+ *
+ * Usage per frame: begin(), addLabel() per track, layout(), draw(). Not thread-safe,
+ * but usable on any one thread.
+ */
+class CTrackLabelEngine
+{
+public:
+    CTrackLabelEngine();
+
+    /**
+     * @brief Label font; changing it drops the shaped labels
+     */
+    void setFont(const QFont &font);
+    const QFont &font() const { return m_font; }
+
+    /**
+     * @brief Most labels drawn per frame, the highest priorities win
+     */
+    void setMaxLabels(int nMaxLabels);
+    int maxLabels() const { return m_nMaxLabels; }
+
+    /**
+     * @brief Starts a frame, clearing the candidates and the occupancy grid
+     * @param viewSize Canvas size; labels outside it are dropped
+     */
+    void begin(const QSize &viewSize);
+
+    /**
+     * @brief Adds a label candidate
+     * @param trackId Track number shown by the label
+     * @param anchor Screen position of the track symbol
+     * @param priority Higher is placed first
+     * @return Candidate index, for placement()
+     */
+    int addLabel(int trackId, const QPointF &anchor, int priority);
+
+    /**
+     * @brief Places the candidates
+     * @return Layout time in milliseconds
+     */
+    double layout();
+
+    /**
+     * @brief Position a candidate got from layout(), -1 when it was dropped
+     */
+    int placement(int nCandidate) const { return m_vecCandidates[nCandidate].slot; }
+
+    /**
+     * @brief Draws the placed labels
+     */
+    void draw(QPainter *pPainter, const QColor &color);
+
+    int placedCount() const { return m_vecPlaced.size(); }
+    int droppedCount() const { return m_vecCandidates.size() - m_vecPlaced.size(); }
+    double lastLayoutMs() const { return m_dLayoutMs; }
+
+private:
+    struct stCandidate {
+        int trackId;
+        QPointF anchor;
+        int priority;
+        int slot;               //!< Placement around the anchor, -1 if dropped
+    };
+
+    struct stShapedLabel {
+        QStaticText text;
+        QSizeF size;
+    };
+
+    struct stPlacedLabel {
+        QStaticText text;       //!< Implicitly shared with the cache entry
+        QPointF topLeft;
+    };
+
+    QFont m_font;
+    qreal m_dAscent;
+    CLruCache<stShapedLabel> m_shapedLabels;    //!< Key: track ID
+    QVector<stCandidate> m_vecCandidates;
+    QVector<int> m_vecOrder;                     //!< Candidate indices, placement order
+    QVector<stPlacedLabel> m_vecPlaced;
+    QVector<quint8> m_vecGrid;                   //!< Occupied cells, row-major
+    int m_nGridColumns;
+    int m_nGridRows;
+    int m_nMaxLabels;
+    double m_dLayoutMs;
+
+    /**
+     * @brief Shaped label of a track, from the cache or shaped now
+     */
+    stShapedLabel shapedLabel(int trackId);
+
+    /**
+     * @brief Marks the rectangle's cells occupied if none of them is
+     * @return false if the rectangle collides or lies outside the view
+     */
+    bool occupy(const QRectF &rect);
+};
+
+#endif // CTRACKLABELENGINE_H
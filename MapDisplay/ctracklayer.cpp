@@ -121,6 +121,7 @@
 #include <QPixmap>
 #include <QTransform>
 #include <QPainterPath>
+#include <QtConcurrent>
 
 #ifndef M_PI
 #define M_PI 3.14159265358979323846
@@ -128,17 +129,64 @@
 
 int nAnimFrame = 0;
 
+namespace {
+
+// Screen margin around the view for culling: covers symbols, highlight rings,
+// speed vectors and labels of tracks just outside the edge
+const double kCullMarginPx = 64.0;
+
+// Level of detail: screen size of a cluster cell, the scale (px per degree) above which
+// nothing clusters, and the members a cell needs to cluster between that and symbol scale
+const double kClusterCellPx = 48.0;
+const double kClusterFullDetailScale = 4 * PPI_VISIBLE_THRESHOLD;
+const int kDenseClusterCount = 8;
+
+// Blip phase and dead reckoning advance at this cadence, not with every frame tick;
+// the blip cycles through ten phases every two seconds
+const int kAnimationStepMs = 200;
+const int kBlipPeriodMs = 2000;
+
+// Pointer distance to a track symbol that still counts as a hit, also the hit grid cell
+const double kHitRadiusPx = 20.0;
+
+// Changed areas beyond this share of the canvas, or this many rectangles, repaint it all
+const double kFullRepaintCoverage = 0.5;
+const int kMaxDirtyRects = 64;
+
+inline void appendFootprint(QVector<QRectF> *pDirty, const stTrackFootprint &footprint)
+{
+    pDirty->append(footprint.rect);
+    if (!footprint.rectTrail.isNull()) {
+        pDirty->append(footprint.rectTrail);
+    }
+}
+
+} // namespace
+
 /**
  * @brief CTrackLayer constructor
  * @param pCanvas Pointer to the QgsMapCanvas
  */
 CTrackLayer::CTrackLayer(QgsMapCanvas *canvas)
-    : QgsMapCanvasItem(canvas), m_canvas(canvas), m_hoveredTrackId(-1), m_rightClickedTrackId(-1), 
-      m_contextMenu(nullptr), m_focusedTrackId(-1), m_hasPendingMouseMove(false)
+    : QgsMapCanvasItem(canvas), m_canvas(canvas), m_pScheduler(CFrameScheduler::forCanvas(canvas)),
+      m_pProfiler(CFrameProfiler::forCanvas(canvas)),
+      m_hoveredTrackId(-1), m_rightClickedTrackId(-1),
+      m_contextMenu(nullptr), m_focusedTrackId(-1),
+      m_bFrameQueued(false), m_bRenderInFlight(false), m_bFrameRequested(true), m_bImagesChanged(false),
+      m_bFullRepaint(true), m_bRenderFullRepaint(false), m_bThreadedRendering(true),
+      m_hasPendingMouseMove(false), m_nEllipseSigma(0),
+      m_bDeadReckoning(true), m_nMaxExtrapolationMs(3000), m_bClustering(true),
+      m_bFrameValid(false), m_nFrameDataVersion(0), m_nNewestUpdateMs(0),
+      m_bBlipsVisible(false)
 {
     setZValue(101); // Ensure drawing order: above base map, below UI overlays
-    QObject::connect(&m_timer, &QTimer::timeout, this, &CTrackLayer::_UpdateAnimation);
-    m_timer.start(200); // Reduced from 150ms to 200ms for better performance
+    QObject::connect(&m_renderWatcher, &QFutureWatcher<void>::finished, this, &CTrackLayer::onRenderFinished);
+
+    // Frames are drawn on the canvas tick, and only when new data, a display change or
+    // a running animation asked for one
+    QObject::connect(m_pScheduler, &CFrameScheduler::signalFrame, this, &CTrackLayer::onFrame);
+    QObject::connect(CDataWarehouse::getInstance(), &CDataWarehouse::signalDataChanged,
+                     this, &CTrackLayer::requestFrame);
 
     // Enable mouse tracking on the canvas
     m_canvas->viewport()->setMouseTracking(true);
@@ -152,7 +200,7 @@ CTrackLayer::CTrackLayer(QgsMapCanvas *canvas)
             int trackId = getTrackAtPosition(m_pendingMousePos);
             if (trackId != m_hoveredTrackId) {
                 m_hoveredTrackId = trackId;
-                update();
+                requestFrame();
             }
             m_hasPendingMouseMove = false;
         }
@@ -161,6 +209,9 @@ CTrackLayer::CTrackLayer(QgsMapCanvas *canvas)
     // Create context menu
     createContextMenu();
     
+    // Symbol atlas, before any frame can reach the worker
+    m_renderer.build();
+
     // Load default drone icon
     m_droneIcon = QPixmap(":/images/resources/drone_icon.png");
     if (m_droneIcon.isNull()) {
@@ -172,6 +223,9 @@ CTrackLayer::CTrackLayer(QgsMapCanvas *canvas)
 
 CTrackLayer::~CTrackLayer()
 {
+    // The worker draws with m_renderer and into m_backImage
+    m_renderWatcher.waitForFinished();
+
     if (m_canvas && m_canvas->viewport()) {
         m_canvas->viewport()->removeEventFilter(this);
     }
@@ -186,10 +240,35 @@ QRectF CTrackLayer::boundingRect() const
     return m_canvas->rect();
 }
 
-void CTrackLayer::_UpdateAnimation()
+void CTrackLayer::onFrame(qint64 nowMs)
 {
-    nAnimFrame = (nAnimFrame + 2) % 20; // Loop from 0–19
-    update(); // Redraw
+    if (m_pScheduler->isAnimationRunning(this)) {
+        // Phase from the clock, even steps 0-18 as before; a new step is a new frame
+        int animFrame = int(nowMs % kBlipPeriodMs) / kAnimationStepMs * 2;
+        if (animFrame != nAnimFrame) {
+            nAnimFrame = animFrame;
+            m_bFrameRequested = true;
+        }
+    }
+    if (!m_bFrameRequested) {
+        return;
+    }
+
+    if (m_bThreadedRendering) {
+        submitFrame();
+    } else {
+        update();
+    }
+}
+
+bool CTrackLayer::isAnimating() const
+{
+    if (m_bBlipsVisible) {
+        return true;
+    }
+    // Symbols keep moving until the newest report is past the extrapolation cutoff
+    return m_bDeadReckoning && !m_vecTrackUpdateMs.isEmpty() &&
+           QDateTime::currentMSecsSinceEpoch() - m_nNewestUpdateMs < m_nMaxExtrapolationMs;
 }
 
 /**
@@ -220,7 +299,7 @@ bool CTrackLayer::eventFilter(QObject *obj, QEvent *event)
             if (m_hoveredTrackId != -1) {
                 m_hoveredTrackId = -1;
                 m_canvas->unsetCursor();
-                update();
+                requestFrame();
             }
         } else if (event->type() == QEvent::MouseButtonPress) {
             QMouseEvent *mouseEvent = static_cast<QMouseEvent*>(event);
@@ -323,7 +402,7 @@ void CTrackLayer::onFocusTrack()
         }
     }
     
-    update(); // Redraw to show focus changes
+    requestFrame(); // Redraw to show focus changes
 }
 
 void CTrackLayer::onDeleteTrack()
@@ -340,7 +419,7 @@ void CTrackLayer::onDeleteTrack()
     CDataWarehouse::getInstance()->deleteTrack(m_rightClickedTrackId);
     qDebug() << "Track" << m_rightClickedTrackId << "deleted";
     
-    update(); // Redraw to reflect changes
+    requestFrame(); // Redraw to reflect changes
 }
 
 void CTrackLayer::onLoadTrackImage()
@@ -360,10 +439,12 @@ void CTrackLayer::onLoadTrackImage()
         // Cache pixmap
         QPixmap pix(imagePath);
         if (!pix.isNull()) {
-            m_trackPixmaps.insert(m_rightClickedTrackId, pix);
+            // The renderer loads it from the path and drops its cached rotations
+            m_bImagesChanged = true;
+            m_bFullRepaint = true;
             // Persist path in data warehouse so it survives refresh
             CDataWarehouse::getInstance()->setTrackImagePath(m_rightClickedTrackId, imagePath);
-            update();
+            requestFrame();
         } else {
             QMessageBox::warning(nullptr, "Invalid Image", "Failed to load the selected image.");
         QPixmap customImage(imagePath);
@@ -385,7 +466,7 @@ void CTrackLayer::onLoadTrackImage()
                 .arg(customImage.height()));
             
             // Force redraw to show the new image
-            update();
+            requestFrame();
         }
     }
 }
@@ -399,7 +480,7 @@ void CTrackLayer::onToggleTrackHistory()
     qDebug() << "Toggle history for track" << m_rightClickedTrackId;
     
     // Force redraw to show/hide history
-    update();
+    requestFrame();
 }
 
 void CTrackLayer::onHighlightTrack()
@@ -414,7 +495,7 @@ void CTrackLayer::onHighlightTrack()
         qDebug() << "Highlighted track" << m_rightClickedTrackId;
     }
     
-    update(); // Redraw to show highlight changes
+    requestFrame(); // Redraw to show highlight changes
 }
 
 /**
@@ -424,517 +505,285 @@ void CTrackLayer::onHighlightTrack()
  */
 int CTrackLayer::getTrackAtPosition(const QPointF &pos)
 {
-    const QgsMapToPixel &mapToPixel = m_canvas->mapSettings().mapToPixel();
-    QList<stTrackDisplayInfo> listTracks = CDataWarehouse::getInstance()->getTrackList();
-
-    // Detection radius in pixels
-    const double detectionRadius = 20.0;
-    const double detectionRadiusSq = detectionRadius * detectionRadius;  // Avoid sqrt
-
-    // Find closest track within detection radius
-    int closestTrackId = -1;
-    double closestDistanceSq = detectionRadiusSq;
-
-    for (const stTrackDisplayInfo &track : listTracks) {
-        QPointF ptScreen = mapToPixel.transform(QgsPointXY(track.lon, track.lat)).toQPointF();
-
-        // Calculate squared distance (faster than sqrt)
-        double dx = pos.x() - ptScreen.x();
-        double dy = pos.y() - ptScreen.y();
-        double distanceSq = dx * dx + dy * dy;
-
-        if (distanceSq < closestDistanceSq) {
-            closestDistanceSq = distanceSq;
-            closestTrackId = track.nTrkId;
-        }
+    // The grid is rebuilt with every frame; only before the first one is there nothing to ask
+    if (!m_bFrameValid) {
+        updateFrameProjection();
     }
 
-    return closestTrackId;
+    int nTrack = m_hitGrid.nearest(pos, kHitRadiusPx);
+    return (nTrack >= 0) ? m_frameTracks[nTrack].nTrkId : -1;
 }
 
-/**
- * @brief Draws the tooltip for the hovered track
- * @param pPainter QPainter instance
- * @param trackInfo Track information to display
- * @param screenPos Position on screen where to draw tooltip
- */
-void CTrackLayer::drawTooltip(QPainter *pPainter, const stTrackDisplayInfo &trackInfo, const QPointF &screenPos)
+void CTrackLayer::updateFrameProjection()
 {
-    // Determine identity display
-    QString identityStr;
-    QString identityIcon;
-    QColor identityColor;
-
-    switch(trackInfo.nTrackIden) {
-        case TRACK_IDENTITY_FRIEND:
-            identityStr = "FRIENDLY";
-            identityIcon = "✓";
-            identityColor = QColor(46, 204, 113); // Modern green
-            break;
-        case TRACK_IDENTITY_HOSTILE:
-            identityStr = "HOSTILE";
-            identityIcon = "✖";
-            identityColor = QColor(231, 76, 60); // Modern red
-            break;
-        case TRACK_IDENTITY_UNKNOWN:
-            identityStr = "UNKNOWN";
-            identityIcon = "?";
-            identityColor = QColor(241, 196, 15); // Modern yellow
-            break;
-        default:
-            identityStr = "UNDEFINED";
-            identityIcon = "•";
-            identityColor = QColor(149, 165, 166);
-            break;
-    }
-
-    // Minimal tooltip content
-    QStringList lines;
-    lines << QString("ID %1").arg(trackInfo.nTrkId);
-    lines << QString("%1 %2").arg(identityIcon).arg(identityStr);
-    lines << "";
-    lines << QString("📍 %1°, %2°").arg(trackInfo.lat, 0, 'f', 4).arg(trackInfo.lon, 0, 'f', 4);
-    lines << QString("📏 %1 km").arg(trackInfo.range / 1000.0, 0, 'f', 1);
-    lines << QString("🧭 %1°").arg(trackInfo.heading, 0, 'f', 0);
-    lines << QString("⬆ %1 m").arg(trackInfo.alt, 0, 'f', 0);
-
-    // Calculate dimensions
-    QFont tooltipFont("Segoe UI", 10);
-    pPainter->setFont(tooltipFont);
-    QFontMetrics fm(tooltipFont);
-
-    int maxWidth = 0;
-    for (const QString &line : lines) {
-        int lineWidth = fm.horizontalAdvance(line);
-        if (lineWidth > maxWidth) {
-            maxWidth = lineWidth;
+    CDataWarehouse *pWarehouse = CDataWarehouse::getInstance();
+    quint64 nVersion = pWarehouse->getDataVersion();
+    bool dataChanged = !m_bFrameValid || nVersion != m_nFrameDataVersion;
+
+    if (dataChanged) {
+        m_frameTracks = pWarehouse->getTrackList();
+        m_nFrameDataVersion = nVersion;
+
+        const int nTracks = m_frameTracks.size();
+        m_vecTrackLon.resize(nTracks);
+        m_vecTrackLat.resize(nTracks);
+        m_vecTrackLonRate.resize(nTracks);
+        m_vecTrackLatRate.resize(nTracks);
+        m_vecTrackUpdateMs.resize(nTracks);
+        m_vecTrackExtrapSec.resize(nTracks);
+        m_vecTrackScreenX.resize(nTracks);
+        m_vecTrackScreenY.resize(nTracks);
+
+        // Flatten positions into coordinate arrays
+        m_nNewestUpdateMs = 0;
+        for (int i = 0; i < nTracks; ++i) {
+            const stTrackDisplayInfo &track = m_frameTracks[i];
+            m_vecTrackLon[i] = track.lon;
+            m_vecTrackLat[i] = track.lat;
+            m_vecTrackLonRate[i] = track.lonRate;
+            m_vecTrackLatRate[i] = track.latRate;
+            m_vecTrackUpdateMs[i] = track.nUpdateTimeMs;
+            m_nNewestUpdateMs = qMax(m_nNewestUpdateMs, track.nUpdateTimeMs);
         }
     }
 
-    int padding = 15;
-    int tooltipWidth = maxWidth + padding * 2;
-    int lineHeight = fm.height() + 3;
-    int tooltipHeight = lines.count() * lineHeight + padding * 2;
+    bool viewChanged = m_projector.setMapToPixel(m_canvas->mapSettings().mapToPixel(),
+                                                 m_canvas->extent().center());
+    const double pixelPerDegree = 1.0 / m_canvas->mapUnitsPerPixel();
 
-    // Position tooltip
-    QPointF tooltipPos = screenPos + QPointF(25, -tooltipHeight / 2);
+    // Trails appended in map coordinates; a zoom across a level resimplifies them
+    bool trailLevelChanged = m_trailCache.setScale(pixelPerDegree);
+    if (dataChanged) {
+        m_trailCache.update(m_frameTracks);
+    }
+    if (dataChanged || trailLevelChanged) {
+        m_trailCache.flatten(m_frameTracks, &m_vecHistoryStart, &m_vecHistoryLon, &m_vecHistoryLat);
+        m_vecHistoryScreenX.resize(m_vecHistoryLon.size());
+        m_vecHistoryScreenY.resize(m_vecHistoryLon.size());
+    }
 
-    // Keep within bounds
-    if (tooltipPos.x() + tooltipWidth > m_canvas->width()) {
-        tooltipPos.setX(screenPos.x() - tooltipWidth - 25);
+    if (m_bDeadReckoning) {
+        // Time since each report, clamped to the staleness cutoff
+        const qint64 nowMs = QDateTime::currentMSecsSinceEpoch();
+        const int nTracks = m_vecTrackUpdateMs.size();
+        for (int i = 0; i < nTracks; ++i) {
+            m_vecTrackExtrapSec[i] = qBound<qint64>(0, nowMs - m_vecTrackUpdateMs[i], m_nMaxExtrapolationMs) / 1000.0;
+        }
+        m_projector.projectExtrapolated(nTracks, m_vecTrackLon.constData(), m_vecTrackLat.constData(),
+                                        m_vecTrackLonRate.constData(), m_vecTrackLatRate.constData(),
+                                        m_vecTrackExtrapSec.constData(),
+                                        m_vecTrackScreenX.data(), m_vecTrackScreenY.data());
+    } else if (dataChanged || viewChanged) {
+        m_projector.project(m_vecTrackLon.size(), m_vecTrackLon.constData(), m_vecTrackLat.constData(),
+                            m_vecTrackScreenX.data(), m_vecTrackScreenY.data());
     }
-    if (tooltipPos.y() < 5) {
-        tooltipPos.setY(5);
+
+    if (viewChanged) {
+        // Every footprint moved
+        m_bFullRepaint = true;
     }
-    if (tooltipPos.y() + tooltipHeight > m_canvas->height()) {
-        tooltipPos.setY(m_canvas->height() - tooltipHeight - 5);
+
+    if (dataChanged || viewChanged) {
+        // New tracks or a moved view need a new overlay frame; dead reckoning
+        // alone rides on the animation tick
+        m_bFrameRequested = true;
+        m_projector.project(m_vecHistoryLon.size(), m_vecHistoryLon.constData(), m_vecHistoryLat.constData(),
+                            m_vecHistoryScreenX.data(), m_vecHistoryScreenY.data());
+        updateHistoryBounds();
     }
 
-    QRectF tooltipRect(tooltipPos, QSizeF(tooltipWidth, tooltipHeight));
+    if (m_bClustering) {
+        if (pixelPerDegree <= kClusterFullDetailScale) {
+            // Incremental at a fixed level, a zoom across levels rebuilds once
+            int level = CTrackClusterer::levelForScale(pixelPerDegree, kClusterCellPx);
+            if (dataChanged || level != m_clusterer.level()) {
+                m_clusterer.update(m_frameTracks, level);
+            }
+        } else if (m_clusterer.level() >= 0) {
+            m_clusterer.clear();
+        }
+    }
 
-    // Simple background - no gradients for performance
-    pPainter->setPen(QPen(identityColor, 2));
-    pPainter->setBrush(QColor(30, 30, 40, 200));
-    pPainter->drawRoundedRect(tooltipRect, 8, 8);
+    // A requested frame may carry new hover, highlight or focus, which decide what clusters
+    if (m_bDeadReckoning || dataChanged || viewChanged || m_bFrameRequested) {
+        cullTracks();
+    }
 
-    // Accent line on left side
-    QRectF accentRect(tooltipPos.x() + 2, tooltipPos.y() + 5, 3, tooltipHeight - 10);
-    pPainter->setPen(Qt::NoPen);
-    pPainter->setBrush(identityColor);
-    pPainter->drawRoundedRect(accentRect, 2, 2);
+    m_bFrameValid = true;
 
-    // Draw text with subtle shadow
-    int yOffset = padding + fm.ascent();
+    // Blips and extrapolated symbols need the next step even when nothing else changes
+    if (isAnimating()) {
+        m_pScheduler->startAnimation(this, kAnimationStepMs);
+    } else {
+        m_pScheduler->stopAnimation(this);
+    }
+}
 
-    for (int i = 0; i < lines.count(); i++) {
-        const QString &line = lines[i];
+void CTrackLayer::updateHistoryBounds()
+{
+    const int nTracks = m_vecHistoryStart.size() - 1;
+    m_vecHistoryBounds.resize(qMax(0, nTracks));
 
-        if (line.isEmpty()) {
-            yOffset += lineHeight / 2;
+    for (int i = 0; i < nTracks; ++i) {
+        int start = m_vecHistoryStart[i], end = m_vecHistoryStart[i + 1];
+        if (start == end) {
+            m_vecHistoryBounds[i] = QRectF();
             continue;
         }
-
-        // Main text with colors (removed text shadow for performance)
-        if (i == 0) {
-            // Track ID - bright cyan
-            pPainter->setFont(QFont("Segoe UI", 11, QFont::Bold));
-            pPainter->setPen(QColor(100, 200, 255));
-        } else if (i == 1) {
-            // Identity - use identity color
-            pPainter->setFont(QFont("Segoe UI", 10, QFont::Bold));
-            pPainter->setPen(identityColor);
-        } else {
-            // Regular info - bright for visibility on transparent bg
-            pPainter->setFont(QFont("Segoe UI", 9));
-            pPainter->setPen(QColor(240, 240, 240));
+        double minX = m_vecHistoryScreenX[start], maxX = minX;
+        double minY = m_vecHistoryScreenY[start], maxY = minY;
+        for (int k = start + 1; k < end; ++k) {
+            minX = qMin(minX, m_vecHistoryScreenX[k]);
+            maxX = qMax(maxX, m_vecHistoryScreenX[k]);
+            minY = qMin(minY, m_vecHistoryScreenY[k]);
+            maxY = qMax(maxY, m_vecHistoryScreenY[k]);
         }
-
-        pPainter->drawText(QPointF(tooltipPos.x() + padding + 10, tooltipPos.y() + yOffset), line);
-        yOffset += lineHeight;
+        // Degenerate trails still need a non-empty rectangle to intersect
+        m_vecHistoryBounds[i] = QRectF(QPointF(minX, minY), QPointF(maxX, maxY)).adjusted(-1, -1, 1, 1);
     }
 }
 
-/**
- * @brief Draws speed vector for a track
- * @param pPainter QPainter instance
- * @param trackInfo Track information
- * @param screenPos Screen position of track
- * @param trackColor Color of the track
- */
-void CTrackLayer::drawSpeedVector(QPainter *pPainter, const stTrackDisplayInfo &trackInfo, 
-                                 const QPointF &screenPos, const QColor &trackColor)
+void CTrackLayer::cullTracks()
 {
-    if (trackInfo.velocity <= 0) return; // No vector for stationary targets
-    
-    // Calculate speed vector length (proportional to speed)
-    // Scale factor: 1 m/s = 2 pixels, max length = 50 pixels
-    double speedScale = 2.0;
-    double maxVectorLength = 50.0;
-    double vectorLength = qMin(trackInfo.velocity * speedScale, maxVectorLength);
-    
-    // Calculate speed vector direction (same as heading)
-    double speedHeadingRad = qDegreesToRadians(trackInfo.heading);
-    QPointF vectorEnd(
-        screenPos.x() + std::cos(speedHeadingRad) * vectorLength,
-        screenPos.y() - std::sin(speedHeadingRad) * vectorLength
-    );
-    
-    // Draw speed vector line
-    QColor vectorColor = trackColor;
-    vectorColor.setAlpha(200);
-    pPainter->setPen(QPen(vectorColor, 2, Qt::SolidLine));
-    pPainter->drawLine(screenPos, vectorEnd);
-    
-    // Draw arrowhead at the end
-    double arrowSize = 6.0;
-    double arrowAngle = M_PI / 6; // 30 degrees
-    
-    QPointF arrowP1(
-        vectorEnd.x() - arrowSize * std::cos(speedHeadingRad - arrowAngle),
-        vectorEnd.y() + arrowSize * std::sin(speedHeadingRad - arrowAngle)
-    );
-    QPointF arrowP2(
-        vectorEnd.x() - arrowSize * std::cos(speedHeadingRad + arrowAngle),
-        vectorEnd.y() + arrowSize * std::sin(speedHeadingRad + arrowAngle)
-    );
-    
-    pPainter->setPen(QPen(vectorColor, 2, Qt::SolidLine));
-    pPainter->drawLine(vectorEnd, arrowP1);
-    pPainter->drawLine(vectorEnd, arrowP2);
-    
-    // Optional: Draw speed text near the vector
-    if (vectorLength > 20) { // Only show text if vector is long enough
-        pPainter->setFont(QFont("Arial", 8));
-        pPainter->setPen(Qt::white);
-        QString speedText = QString("%1 m/s").arg(trackInfo.velocity, 0, 'f', 1);
-        QPointF textPos = screenPos + QPointF(vectorLength * 0.6 * std::cos(speedHeadingRad), 
-                                             -vectorLength * 0.6 * std::sin(speedHeadingRad));
-        pPainter->drawText(textPos, speedText);
+    m_rectCull = QRectF(m_canvas->rect()).adjusted(-kCullMarginPx, -kCullMarginPx,
+                                                   kCullMarginPx, kCullMarginPx);
+    const double left = m_rectCull.left(), right = m_rectCull.right();
+    const double top = m_rectCull.top(), bottom = m_rectCull.bottom();
+
+    // Uncertainty ellipses can reach far beyond the symbol
+    const double ellipseScale = (m_nEllipseSigma > 0) ? m_nEllipseSigma / m_canvas->mapUnitsPerPixel() : 0.0;
+
+    // Level of detail: every shared cell clusters at overview scale, only dense cells
+    // closer in, none once symbols have room
+    const double pixelPerDegree = 1.0 / m_canvas->mapUnitsPerPixel();
+    int minClusterCount = 0;
+    if (m_bClustering && m_clusterer.level() >= 0 && pixelPerDegree <= kClusterFullDetailScale) {
+        minClusterCount = (pixelPerDegree <= PPI_VISIBLE_THRESHOLD) ? 2 : kDenseClusterCount;
     }
-}
+    const QHash<quint64, stTrackClusterCell> &cells = m_clusterer.cells();
+    const QVector<quint64> &trackCells = m_clusterer.trackCells();
+
+    const int nTracks = m_vecTrackScreenX.size();
+    const bool hasMarkedTracks = m_focusedTrackId != -1 || m_hoveredTrackId != -1 || !m_highlightedTracks.isEmpty();
+    m_vecVisibleTracks.resize(0);
+    m_bBlipsVisible = false;
+    for (int i = 0; i < nTracks; ++i) {
+        if (minClusterCount > 0) {
+            // Tracks the operator interacts with always stay individual
+            const int trackId = m_frameTracks[i].nTrkId;
+            if (trackId != m_focusedTrackId && trackId != m_hoveredTrackId &&
+                !m_highlightedTracks.contains(trackId)) {
+                QHash<quint64, stTrackClusterCell>::const_iterator it = cells.constFind(trackCells[i]);
+                if (it != cells.constEnd() && it.value().count >= minClusterCount) {
+                    continue;
+                }
+            }
+        }
 
-/**
- * @brief Draws focused track datatip that follows the track
- * @param pPainter QPainter instance
- * @param trackInfo Track information
- * @param screenPos Screen position of track
- */
-void CTrackLayer::drawFocusedTrackDatatip(QPainter *pPainter, const stTrackDisplayInfo &trackInfo, 
-                                         const QPointF &screenPos)
-{
-    // Use a modified version of the tooltip for focused tracks
-    // This will always be visible and follow the track
-    
-    // Determine identity display
-    QString identityStr;
-    QString identityIcon;
-    QColor identityColor;
-
-    switch(trackInfo.nTrackIden) {
-        case TRACK_IDENTITY_FRIEND:
-            identityStr = "FRIENDLY";
-            identityIcon = "✓";
-            identityColor = QColor(46, 204, 113);
-            break;
-        case TRACK_IDENTITY_HOSTILE:
-            identityStr = "HOSTILE";
-            identityIcon = "✖";
-            identityColor = QColor(231, 76, 60);
-            break;
-        case TRACK_IDENTITY_UNKNOWN:
-            identityStr = "UNKNOWN";
-            identityIcon = "?";
-            identityColor = QColor(241, 196, 15);
-            break;
-        default:
-            identityStr = "UNDEFINED";
-            identityIcon = "•";
-            identityColor = QColor(149, 165, 166);
-            break;
-    }
+        double x = m_vecTrackScreenX[i], y = m_vecTrackScreenY[i];
+        double reach = 0.0;
+        if (ellipseScale > 0.0 && m_frameTracks[i].hasCovariance) {
+            reach = m_frameTracks[i].ellipseMajor * ellipseScale;
+        }
 
-    // Focused track tooltip content (more compact)
-    QStringList lines;
-    lines << QString("🎯 FOCUSED: ID %1").arg(trackInfo.nTrkId);
-    lines << QString("%1 %2").arg(identityIcon).arg(identityStr);
-    lines << QString("🚀 %1 m/s").arg(trackInfo.velocity, 0, 'f', 1);
-    lines << QString("🧭 %1°").arg(trackInfo.heading, 0, 'f', 0);
-
-    // Calculate dimensions
-    QFont tooltipFont("Segoe UI", 9, QFont::Bold);
-    pPainter->setFont(tooltipFont);
-    QFontMetrics fm(tooltipFont);
-
-    int maxWidth = 0;
-    for (const QString &line : lines) {
-        int lineWidth = fm.horizontalAdvance(line);
-        if (lineWidth > maxWidth) {
-            maxWidth = lineWidth;
+        bool visible = x >= left - reach && x <= right + reach && y >= top - reach && y <= bottom + reach;
+        if (!visible && !m_vecHistoryBounds[i].isNull()) {
+            // The trail, and the connector from its last point, may cross the view
+            QRectF trail = m_vecHistoryBounds[i].united(QRectF(x - 1, y - 1, 2, 2));
+            visible = trail.intersects(m_rectCull);
+        }
+        if (visible) {
+            m_vecVisibleTracks.append(i);
+
+            // Focused, hovered and highlighted tracks pulse
+            if (hasMarkedTracks && !m_bBlipsVisible) {
+                const int trackId = m_frameTracks[i].nTrkId;
+                m_bBlipsVisible = trackId == m_focusedTrackId || trackId == m_hoveredTrackId ||
+                                  m_highlightedTracks.contains(trackId);
+            }
         }
     }
 
-    int padding = 10;
-    int tooltipWidth = maxWidth + padding * 2;
-    int lineHeight = fm.height() + 2;
-    int tooltipHeight = lines.count() * lineHeight + padding * 2;
+    // Cluster glyphs at the cell centroids
+    m_vecClusters.resize(0);
+    if (minClusterCount > 0) {
+        m_vecClusterCells.resize(0);
+        m_vecClusterLon.resize(0);
+        m_vecClusterLat.resize(0);
+        for (QHash<quint64, stTrackClusterCell>::const_iterator it = cells.constBegin();
+             it != cells.constEnd(); ++it) {
+            const stTrackClusterCell &cell = it.value();
+            if (cell.count >= minClusterCount) {
+                m_vecClusterCells.append(it.key());
+                m_vecClusterLon.append(cell.sumLon / cell.count);
+                m_vecClusterLat.append(cell.sumLat / cell.count);
+            }
+        }
 
-    // Position tooltip above and to the right of track
-    QPointF tooltipPos = screenPos + QPointF(15, -tooltipHeight - 15);
+        const int nClusters = m_vecClusterCells.size();
+        m_vecClusterScreenX.resize(nClusters);
+        m_vecClusterScreenY.resize(nClusters);
+        m_projector.project(nClusters, m_vecClusterLon.constData(), m_vecClusterLat.constData(),
+                            m_vecClusterScreenX.data(), m_vecClusterScreenY.data());
 
-    // Keep within bounds
-    if (tooltipPos.x() + tooltipWidth > m_canvas->width()) {
-        tooltipPos.setX(screenPos.x() - tooltipWidth - 15);
-    }
-    if (tooltipPos.y() < 5) {
-        tooltipPos.setY(screenPos.y() + 15);
+        for (int c = 0; c < nClusters; ++c) {
+            QPointF screenPos(m_vecClusterScreenX[c], m_vecClusterScreenY[c]);
+            if (!m_rectCull.contains(screenPos)) {
+                continue;
+            }
+            const stTrackClusterCell cell = cells.value(m_vecClusterCells[c]);
+            int nIdentities = 0;
+            for (int k = 0; k < CTrackSymbolAtlas::kIdentityCount; ++k) {
+                nIdentities += (cell.identityCounts[k] > 0) ? 1 : 0;
+            }
+            stTrackCluster cluster;
+            cluster.cell = m_vecClusterCells[c];
+            cluster.screenPos = screenPos;
+            cluster.count = cell.count;
+            cluster.identity = cell.dominantIdentity();
+            cluster.mixed = nIdentities > 1;
+            m_vecClusters.append(cluster);
+        }
     }
 
-    QRectF tooltipRect(tooltipPos, QSizeF(tooltipWidth, tooltipHeight));
-
-    // Draw focused tooltip with stronger background
-    QLinearGradient bgGradient(tooltipRect.topLeft(), tooltipRect.bottomLeft());
-    bgGradient.setColorAt(0, QColor(30, 30, 40, 200));
-    bgGradient.setColorAt(1, QColor(20, 20, 30, 220));
-
-    pPainter->setBrush(bgGradient);
-    pPainter->setPen(QPen(identityColor, 2));
-    pPainter->drawRoundedRect(tooltipRect, 8, 8);
+    // Off-screen and clustered tracks cannot be under the mouse
+    m_hitGrid.build(m_rectCull, kHitRadiusPx, m_vecVisibleTracks,
+                    m_vecTrackScreenX.constData(), m_vecTrackScreenY.constData());
+}
 
-    // Draw text
-    int yOffset = padding + fm.ascent();
-    for (int i = 0; i < lines.count(); i++) {
-        const QString &line = lines[i];
+void CTrackLayer::setDeadReckoning(bool enabled, int maxExtrapolationMs)
+{
+    m_bDeadReckoning = enabled;
+    m_nMaxExtrapolationMs = qMax(0, maxExtrapolationMs);
 
-        if (i == 0) {
-            // Focused header - bright cyan
-            pPainter->setPen(QColor(100, 200, 255));
-        } else if (i == 1) {
-            // Identity - use identity color
-            pPainter->setPen(identityColor);
-        } else {
-            // Regular info - bright white
-            pPainter->setPen(QColor(255, 255, 255));
-        }
+    // Force a plain reprojection when switching back to reported positions
+    m_bFrameValid = false;
+    requestFrame();
+}
 
-        pPainter->drawText(QPointF(tooltipPos.x() + padding, tooltipPos.y() + yOffset), line);
-        yOffset += lineHeight;
+void CTrackLayer::setClustering(bool enabled)
+{
+    m_bClustering = enabled;
+    if (!enabled) {
+        m_clusterer.clear();
+        m_vecClusters.resize(0);
     }
+
+    // Rebuilds the grid and the culled set
+    m_bFrameValid = false;
+    requestFrame();
 }
 
-/**
- * @brief Draws drone internal details panel next to track
- * @param pPainter QPainter instance
- * @param trackInfo Track information with drone pointer
- * @param screenPos Screen position of track
- */
-void CTrackLayer::drawDroneInternalDetails(QPainter *pPainter, const stTrackDisplayInfo &trackInfo, 
-                                          const QPointF &screenPos)
+void CTrackLayer::setUncertaintyEllipseSigma(int nSigma)
 {
-    if (!trackInfo.pDrone) return;
-    
-    stDroneInternalState droneState = trackInfo.pDrone->getInternalState();
-    
-    // Determine health color
-    QColor healthColor = trackInfo.pDrone->getHealthStatusColor();
-    
-    // Build info lines for display
-    QStringList lines;
-    lines << QString("🚁 DRONE #%1").arg(trackInfo.nTrkId);
-    lines << QString("━━━━━━━━━━━━━━");
-    lines << QString("MODE: %1").arg(trackInfo.pDrone->getFlightModeString());
-    lines << QString("STATUS: %1").arg(droneState.statusMessage);
-    lines << "";
-    lines << QString("⚡ POWER");
-    lines << QString("  Battery: %1%").arg(droneState.batteryLevel, 0, 'f', 1);
-    lines << QString("  Voltage: %1V").arg(droneState.batteryVoltage, 0, 'f', 2);
-    lines << QString("  Flight Time: %1m").arg(droneState.estimatedFlightTime, 0, 'f', 1);
-    lines << "";
-    lines << QString("🎯 DYNAMICS");
-    lines << QString("  Speed: %1 m/s").arg(droneState.groundSpeed, 0, 'f', 1);
-    lines << QString("  V-Speed: %1 m/s").arg(droneState.verticalSpeed, 0, 'f', 1);
-    lines << QString("  Accel: %1 m/s²").arg(droneState.acceleration, 0, 'f', 2);
-    lines << QString("  Heading: %1°").arg(droneState.yaw, 0, 'f', 1);
-    lines << "";
-    lines << QString("🎚️ ATTITUDE");
-    lines << QString("  Pitch: %1°").arg(droneState.pitch, 0, 'f', 1);
-    lines << QString("  Roll: %1°").arg(droneState.roll, 0, 'f', 1);
-    lines << QString("  Yaw: %1°").arg(droneState.yaw, 0, 'f', 1);
-    lines << "";
-    lines << QString("📡 SENSORS");
-    lines << QString("  GPS: %1%2").arg(droneState.sensors.gpsActive ? "✓" : "✗").arg(QString(" %1%").arg(droneState.sensors.gpsQuality));
-    lines << QString("  Link: %1%").arg(droneState.sensors.linkQuality);
-    lines << QString("  IMU: %1").arg(droneState.sensors.imuActive ? "✓" : "✗");
-    lines << "";
-    lines << QString("📍 MISSION");
-    lines << QString("  ID: %1").arg(droneState.missionId);
-    lines << QString("  WP: %1/%2").arg(droneState.waypointIndex).arg(droneState.totalWaypoints);
-    lines << QString("  Progress: %1%").arg(droneState.missionProgress, 0, 'f', 0);
-    
-    // Calculate dimensions
-    QFont detailFont("Consolas", 8);
-    pPainter->setFont(detailFont);
-    QFontMetrics fm(detailFont);
-    
-    int maxWidth = 0;
-    for (const QString &line : lines) {
-        int lineWidth = fm.horizontalAdvance(line);
-        if (lineWidth > maxWidth) {
-            maxWidth = lineWidth;
-        }
-    }
-    
-    int padding = 12;
-    int panelWidth = maxWidth + padding * 2;
-    int lineHeight = fm.height() + 1;
-    int panelHeight = lines.count() * lineHeight + padding * 2;
-    
-    // Position panel to the right of track
-    QPointF panelPos = screenPos + QPointF(40, -panelHeight / 2);
-    
-    // Keep within bounds
-    if (panelPos.x() + panelWidth > m_canvas->width() - 10) {
-        panelPos.setX(screenPos.x() - panelWidth - 40);
-    }
-    if (panelPos.y() < 10) {
-        panelPos.setY(10);
-    }
-    if (panelPos.y() + panelHeight > m_canvas->height() - 10) {
-        panelPos.setY(m_canvas->height() - panelHeight - 10);
-    }
-    
-    QRectF panelRect(panelPos, QSizeF(panelWidth, panelHeight));
-    
-    // Draw panel shadow
-    pPainter->setPen(Qt::NoPen);
-    pPainter->setBrush(QColor(0, 0, 0, 60));
-    pPainter->drawRoundedRect(panelRect.adjusted(-3, -3, 3, 3), 12, 12);
-    
-    // Main background - dark semi-transparent
-    QLinearGradient bgGradient(panelRect.topLeft(), panelRect.bottomLeft());
-    bgGradient.setColorAt(0, QColor(20, 25, 35, 240));
-    bgGradient.setColorAt(1, QColor(15, 20, 30, 250));
-    
-    pPainter->setBrush(bgGradient);
-    pPainter->setPen(QPen(healthColor, 2));
-    pPainter->drawRoundedRect(panelRect, 10, 10);
-    
-    // Health status indicator bar on left
-    QRectF healthBar(panelPos.x() + 5, panelPos.y() + 5, 4, panelHeight - 10);
-    pPainter->setPen(Qt::NoPen);
-    pPainter->setBrush(healthColor);
-    pPainter->drawRoundedRect(healthBar, 2, 2);
-    
-    // Battery level indicator (visual bar)
-    if (droneState.batteryLevel > 0) {
-        QRectF batteryBg(panelPos.x() + padding, panelPos.y() + panelHeight - padding - 8, 
-                         panelWidth - padding * 2, 6);
-        pPainter->setPen(Qt::NoPen);
-        pPainter->setBrush(QColor(60, 60, 70));
-        pPainter->drawRoundedRect(batteryBg, 3, 3);
-        
-        // Battery fill color based on level
-        QColor batteryColor;
-        if (droneState.batteryLevel > 50) {
-            batteryColor = QColor(46, 204, 113); // Green
-        } else if (droneState.batteryLevel > 25) {
-            batteryColor = QColor(241, 196, 15); // Yellow
-        } else {
-            batteryColor = QColor(231, 76, 60); // Red
-        }
-        
-        QRectF batteryFill(batteryBg.x(), batteryBg.y(), 
-                          batteryBg.width() * (droneState.batteryLevel / 100.0), batteryBg.height());
-        pPainter->setBrush(batteryColor);
-        pPainter->drawRoundedRect(batteryFill, 3, 3);
-    }
-    
-    // Draw text lines
-    int yOffset = padding + fm.ascent();
-    
-    for (int i = 0; i < lines.count(); i++) {
-        const QString &line = lines[i];
-        
-        if (line.isEmpty() || line.startsWith("━")) {
-            yOffset += lineHeight / 2;
-            
-            // Draw separator line
-            if (line.startsWith("━")) {
-                pPainter->setPen(QPen(QColor(100, 100, 120, 100), 1));
-                pPainter->drawLine(panelPos.x() + padding + 15, panelPos.y() + yOffset - fm.ascent()/2,
-                                  panelPos.x() + panelWidth - padding - 15, panelPos.y() + yOffset - fm.ascent()/2);
-            }
-            continue;
-        }
-        
-        // Color coding for different line types
-        if (line.startsWith("🚁")) {
-            // Title - bright cyan
-            pPainter->setFont(QFont("Consolas", 9, QFont::Bold));
-            pPainter->setPen(QColor(100, 200, 255));
-        } else if (line.startsWith("MODE:") || line.startsWith("STATUS:")) {
-            // Status lines
-            pPainter->setFont(QFont("Consolas", 8, QFont::Bold));
-            if (line.contains("EMERGENCY") || line.contains("CRITICAL")) {
-                pPainter->setPen(QColor(231, 76, 60)); // Red
-            } else if (line.contains("WARNING") || line.contains("RTB")) {
-                pPainter->setPen(QColor(241, 196, 15)); // Yellow
-            } else {
-                pPainter->setPen(healthColor);
-            }
-        } else if (line.startsWith("⚡") || line.startsWith("🎯") || 
-                   line.startsWith("🎚️") || line.startsWith("📡") || line.startsWith("📍")) {
-            // Section headers
-            pPainter->setFont(QFont("Consolas", 8, QFont::Bold));
-            pPainter->setPen(QColor(150, 180, 255));
-        } else if (line.startsWith("  ")) {
-            // Data lines (indented)
-            pPainter->setFont(QFont("Consolas", 8));
-            pPainter->setPen(QColor(220, 220, 230));
-        } else {
-            // Default
-            pPainter->setFont(detailFont);
-            pPainter->setPen(QColor(200, 200, 210));
-        }
-        
-        pPainter->drawText(QPointF(panelPos.x() + padding + 15, panelPos.y() + yOffset), line);
-        yOffset += lineHeight;
-    }
-    
-    // Draw connection line from panel to track
-    QPainterPath connectorPath;
-    if (panelPos.x() > screenPos.x()) {
-        // Panel on right
-        connectorPath.moveTo(panelPos.x(), panelPos.y() + panelHeight / 2);
-        connectorPath.lineTo(screenPos.x() + 15, screenPos.y());
-    } else {
-        // Panel on left
-        connectorPath.moveTo(panelPos.x() + panelWidth, panelPos.y() + panelHeight / 2);
-        connectorPath.lineTo(screenPos.x() - 15, screenPos.y());
-    }
-    
-    pPainter->setPen(QPen(healthColor, 2, Qt::DotLine));
-    pPainter->setBrush(Qt::NoBrush);
-    pPainter->drawPath(connectorPath);
+    m_nEllipseSigma = qBound(0, nSigma, 2);
+
+    // The warehouse only propagates covariances while someone draws them
+    CDataWarehouse::getInstance()->setCovarianceEnabled(m_nEllipseSigma > 0);
+
+    // Ellipses widen the culling reach
+    m_bFrameValid = false;
+    requestFrame();
 }
 
 /**
@@ -979,298 +828,257 @@ void CTrackLayer::drawRotatedDroneImage(QPainter *pPainter, const QPixmap &image
 
 /**
  * @brief Paints the tracks on the canvas
+ *
+ * With threaded rendering a new frame is handed to the worker when something changed
+ * and the last completed one is blitted, so a slow render never blocks input.
  * @param pPainter QPainter instance used for drawing
  */
 void CTrackLayer::paint(QPainter *pPainter)
 {
     if (!pPainter) return;
 
-    pPainter->setRenderHint(QPainter::Antialiasing, true);
+    // Threaded, only the blit; the worker's render time is its own series
+    CProfileScope profileScope(m_pProfiler, QStringLiteral("CTrackLayer"));
+
+    if (!m_bThreadedRendering) {
+        // Snapshot and screen positions for this frame, reused by hit testing
+        updateFrameProjection();
+        stTrackFrame frame;
+        takeFrame(&frame, pPainter->device() ? pPainter->device()->devicePixelRatioF() : 1.0);
+        m_bFrameRequested = false;
+        m_renderer.render(frame, pPainter);
+        reportRenderStats();
+        return;
+    }
 
-    // Transform geographic positions to screen coordinates
-    const QgsMapToPixel &mapToPixel = m_canvas->mapSettings().mapToPixel();
+    // A view change reaches the layer as a repaint, render for the new view
+    submitFrame();
 
-    QList<stTrackDisplayInfo> listTracks = CDataWarehouse::getInstance()->getTrackList();
+    // The view clips this to the invalidated area
+    if (!m_frontImage.isNull()) {
+        pPainter->drawImage(QPointF(0, 0), m_frontImage);
+    }
+}
 
-    stTrackDisplayInfo hoveredTrack;
-    bool hasHoveredTrack = false;
+void CTrackLayer::requestFrame()
+{
+    // Every request until the next canvas tick makes one frame; threaded, the canvas is
+    // invalidated when that frame has been rendered, not now
+    m_bFrameRequested = true;
+    m_pScheduler->requestFrame();
+}
 
-    for (const stTrackDisplayInfo &track : listTracks) {
-        QPointF ptScreen = mapToPixel.transform(QgsPointXY(track.lon, track.lat)).toQPointF();
-        double pixelPerDegree = 1.0 / m_canvas->mapUnitsPerPixel();
-        QColor clr = Qt::cyan;
+void CTrackLayer::submitFrame()
+{
+    updateFrameProjection();
+    if (!m_bFrameRequested) {
+        return;
+    }
+    m_bFrameRequested = false;
+
+    const qreal dpr = m_canvas->devicePixelRatioF();
+    // Not isRunning(): it turns false when the worker returns, before the posted finished()
+    // is handled, and a render started in that gap would share the back image and footprints
+    if (m_bRenderInFlight) {
+        // Only the newest frame is worth drawing next, but a skipped frame's full
+        // repaint still has to happen
+        bool fullRepaint = m_bFrameQueued && m_queuedFrame.fullRepaint;
+        takeFrame(&m_queuedFrame, dpr);
+        m_queuedFrame.fullRepaint |= fullRepaint;
+        m_bFrameQueued = true;
+    } else {
+        stTrackFrame frame;
+        takeFrame(&frame, dpr);
+        startRender(frame);
+    }
+}
 
-        // Check track states
-        bool isHovered = (track.nTrkId == m_hoveredTrackId);
-        bool isHighlighted = m_highlightedTracks.contains(track.nTrkId);
-        bool isFocused = (track.nTrkId == m_focusedTrackId);
-        
-        if (isHovered) {
-            hoveredTrack = track;
-            hasHoveredTrack = true;
+void CTrackLayer::takeFrame(stTrackFrame *pFrame, qreal devicePixelRatio)
+{
+    pFrame->size = m_canvas->rect().size();
+    pFrame->devicePixelRatio = devicePixelRatio;
+    pFrame->pixelPerDegree = 1.0 / m_canvas->mapUnitsPerPixel();
+    pFrame->ellipseSigma = m_nEllipseSigma;
+    pFrame->animFrame = nAnimFrame;
+
+    pFrame->tracks = m_frameTracks;
+    pFrame->trackScreenX = m_vecTrackScreenX;
+    pFrame->trackScreenY = m_vecTrackScreenY;
+    pFrame->visibleTracks = m_vecVisibleTracks;
+    pFrame->historyStart = m_vecHistoryStart;
+    pFrame->historyScreenX = m_vecHistoryScreenX;
+    pFrame->historyScreenY = m_vecHistoryScreenY;
+    pFrame->rectCull = m_rectCull;
+    pFrame->clusters = m_vecClusters;
+    pFrame->clustering = m_bClustering;
+
+    pFrame->highlightedTracks = m_highlightedTracks;
+    pFrame->focusedTrackId = m_focusedTrackId;
+    pFrame->hoveredTrackId = m_hoveredTrackId;
+    pFrame->mousePos = m_mousePos;
+
+    // The renderer may run on another thread and the UDP thread updates the drone, so
+    // the frame gets a copy taken under the warehouse's data lock
+    pFrame->hasFocusedDrone = false;
+    if (m_focusedTrackId != -1) {
+        for (int nTrack : m_vecVisibleTracks) {
+            const stTrackDisplayInfo &track = m_frameTracks[nTrack];
+            if (track.nTrkId == m_focusedTrackId) {
+                if (track.pDrone) {
+                    pFrame->hasFocusedDrone = CDataWarehouse::getInstance()->getDroneSnapshot(
+                        m_focusedTrackId, &pFrame->focusedDroneState, &pFrame->focusedDroneHealth,
+                        &pFrame->focusedDroneMode);
+                }
+                break;
+            }
         }
+    }
 
-        switch (track.nTrackIden) {
-        case TRACK_IDENTITY_UNKNOWN:
-            clr = Qt::yellow;
-            break;
-        case TRACK_IDENTITY_FRIEND:
-            clr = Qt::green;
-            break;
-        case TRACK_IDENTITY_HOSTILE:
-            clr = Qt::red;
-            break;
-        }
+    pFrame->invalidateImages = m_bImagesChanged;
+    pFrame->fullRepaint = m_bFullRepaint;
+    m_bImagesChanged = false;
+    m_bFullRepaint = false;
 
-        if (pixelPerDegree > PPI_VISIBLE_THRESHOLD) {
-            // Determine track size based on state
-            double trackSize = 4;
-            if (isHighlighted) trackSize = 8;  // Larger for highlighted tracks
-            if (isFocused) trackSize = 10;     // Even larger for focused tracks
-            
-            // Highlight effects
-            if (isHighlighted || isFocused) {
-                // Outer highlight ring
-                pPainter->setPen(QPen(Qt::white, 3));
-                pPainter->setBrush(Qt::NoBrush);
-                pPainter->drawEllipse(ptScreen, trackSize + 6, trackSize + 6);
-
-                // Inner glow effect
-                pPainter->setPen(QPen(clr, 2));
-                pPainter->drawEllipse(ptScreen, trackSize + 3, trackSize + 3);
-            }
-            
-            // Hover effect (additional to highlight/focus)
-            if (isHovered) {
-                pPainter->setPen(QPen(Qt::cyan, 2));
-                pPainter->setBrush(Qt::NoBrush);
-                pPainter->drawEllipse(ptScreen, trackSize + 8, trackSize + 8);
-            }
+    if (m_pProfiler->isEnabled()) {
+        m_pProfiler->setCounter(QStringLiteral("Tracks drawn"), m_vecVisibleTracks.size());
+        m_pProfiler->setCounter(QStringLiteral("Tracks culled"), m_frameTracks.size() - m_vecVisibleTracks.size());
+        m_pProfiler->setCounter(QStringLiteral("Cluster glyphs"), m_vecClusters.size());
+    }
+}
 
-            bool drawnCustomImage = false;
-            // Draw custom image if available for this track
-            if (!track.imagePath.isEmpty()) {
-                // Ensure pixmap cached; if not, attempt load
-                if (!m_trackPixmaps.contains(track.nTrkId)) {
-                    QPixmap pix(track.imagePath);
-                    if (!pix.isNull()) {
-                        m_trackPixmaps.insert(track.nTrkId, pix);
-                    }
-                }
+void CTrackLayer::reportRenderStats()
+{
+    if (!m_pProfiler->isEnabled()) {
+        return;
+    }
+    m_pProfiler->setCounter(QStringLiteral("Labels placed"), m_renderer.labelEngine().placedCount());
+    m_pProfiler->setCounter(QStringLiteral("Labels dropped"), m_renderer.labelEngine().droppedCount());
+
+    const CLruCache<QImage> &trackImages = m_renderer.trackImageCache();
+    const CLruCache<QImage> &rotatedImages = m_renderer.rotatedImageCache();
+    const CLruCache<QImage> &panels = m_renderer.panelCache();
+    m_pProfiler->reportCache(QStringLiteral("Track images"), trackImages.hits(), trackImages.misses());
+    m_pProfiler->reportCache(QStringLiteral("Rotated images"), rotatedImages.hits(), rotatedImages.misses());
+    m_pProfiler->reportCache(QStringLiteral("Track panels"), panels.hits(), panels.misses());
+}
 
-                if (m_trackPixmaps.contains(track.nTrkId)) {
-                    const QPixmap &pix = m_trackPixmaps.value(track.nTrkId);
-                    int baseSize = isFocused ? 40 : (isHighlighted ? 32 : 24);
-                    
-                    // Round heading to nearest 5 degrees for better cache hits
-                    int roundedHeading = static_cast<int>(track.heading / 5.0) * 5;
-                    QString cacheKey = QString("%1_%2_%3").arg(track.nTrkId).arg(baseSize).arg(roundedHeading);
-                    
-                    QPixmap rotated;
-                    if (m_rotatedImageCache.contains(cacheKey)) {
-                        rotated = m_rotatedImageCache.value(cacheKey);
-                    } else {
-                        QPixmap scaled = pix.scaled(baseSize, baseSize, Qt::KeepAspectRatio, Qt::SmoothTransformation);
-                        QTransform transform;
-                        transform.translate(scaled.width() / 2.0, scaled.height() / 2.0);
-                        transform.rotate(-roundedHeading);
-                        transform.translate(-scaled.width() / 2.0, -scaled.height() / 2.0);
-                        rotated = scaled.transformed(transform, Qt::SmoothTransformation);
-                        
-                        // Limit cache size to prevent memory issues
-                        if (m_rotatedImageCache.size() > 500) {
-                            m_rotatedImageCache.clear();
-                        }
-                        m_rotatedImageCache.insert(cacheKey, rotated);
-                    }
-
-                    // Draw centered at ptScreen
-                    QPointF topLeft(ptScreen.x() - rotated.width() / 2.0,
-                                    ptScreen.y() - rotated.height() / 2.0);
-                    pPainter->drawPixmap(topLeft, rotated);
-                    drawnCustomImage = true;
-                }
-            }
+void CTrackLayer::startRender(const stTrackFrame &frame)
+{
+    m_bRenderInFlight = true;
+    m_bRenderFullRepaint = frame.fullRepaint;
+    m_renderWatcher.setFuture(QtConcurrent::run([this, frame]() {
+        m_renderer.renderImage(frame, &m_backImage);
+    }));
+}
 
-            if (!drawnCustomImage) {
-                // Fallback: draw a small default drone-like marker oriented by heading
-                int baseSize = isFocused ? 28 : (isHighlighted ? 22 : 16);
-                int roundedHeading = static_cast<int>(track.heading / 5.0) * 5;
-                QString cacheKey = QString("def_%1_%2_%3").arg(baseSize).arg(clr.name()).arg(roundedHeading);
-                
-                QPixmap rotated;
-                if (m_rotatedImageCache.contains(cacheKey)) {
-                    rotated = m_rotatedImageCache.value(cacheKey);
-                } else {
-                    QPixmap defaultIcon;
-                    QString iconKey = QString("%1x%2_%3").arg(baseSize).arg(baseSize).arg(clr.name());
-                    if (m_defaultIconCache.contains(iconKey)) {
-                        defaultIcon = m_defaultIconCache.value(iconKey);
-                    } else {
-                        defaultIcon = getDefaultDronePixmap(baseSize, clr, Qt::white);
-                        m_defaultIconCache.insert(iconKey, defaultIcon);
-                    }
-                    
-                    QTransform transform;
-                    transform.translate(defaultIcon.width() / 2.0, defaultIcon.height() / 2.0);
-                    transform.rotate(-roundedHeading);
-                    transform.translate(-defaultIcon.width() / 2.0, -defaultIcon.height() / 2.0);
-                    rotated = defaultIcon.transformed(transform, Qt::SmoothTransformation);
-                    
-                    if (m_rotatedImageCache.size() > 500) {
-                        m_rotatedImageCache.clear();
-                    }
-                    m_rotatedImageCache.insert(cacheKey, rotated);
-                }
-                
-                QPointF topLeft(ptScreen.x() - rotated.width() / 2.0,
-                                ptScreen.y() - rotated.height() / 2.0);
-                pPainter->drawPixmap(topLeft, rotated);
-            }
+void CTrackLayer::onRenderFinished()
+{
+    if (!m_bRenderInFlight) {
+        return;
+    }
+    m_bRenderInFlight = false;
+    if (!m_bThreadedRendering) {
+        return;
+    }
 
-            // Draw speed vector instead of simple heading line
-            drawSpeedVector(pPainter, track, ptScreen, clr);
+    m_frontImage.swap(m_backImage);
+    m_pProfiler->addPaintTime(QStringLiteral("CTrackLayer render"), m_renderer.lastRenderMs());
+    reportRenderStats();
 
-            if (pixelPerDegree > TEXT_VISIBLE_THRESHOLD) {
-                pPainter->setFont(QFont("century", 11, 80, true));
-                // Label
-                pPainter->setPen(Qt::white);
-                pPainter->drawText(ptScreen + QPointF(6, -6), QString::number(track.nTrkId));
-            }
-        }
+    // Blit only what changed; reads the renderer's footprints, so before the next render
+    invalidateChanged(m_bRenderFullRepaint);
+
+    // The frame lands between ticks; one more tick tells views mirroring the canvas
+    m_pScheduler->requestFrame();
+
+    if (m_bFrameQueued) {
+        m_bFrameQueued = false;
+        startRender(m_queuedFrame);
+        m_queuedFrame = stTrackFrame();
+    }
+}
+
+void CTrackLayer::invalidateChanged(bool fullRepaint)
+{
+    const QVector<stTrackFootprint> &footprints = m_renderer.footprints();
 
-        // Simplified blip animation - only for highlighted/focused tracks to improve performance
-        if (isHighlighted || isFocused || isHovered) {
-            int nMaxRadius = 20;
-            int nCurrentRadius = 4 + (nAnimFrame * (nMaxRadius - 4) / 20);
-            int nAlpha = 255 - (nAnimFrame * 255 / 20);
+    // Overlays follow the mouse and the drone state, repaint their old and new areas
+    QVector<QRectF> vecDirty = m_vecShownOverlays;
+    vecDirty += m_renderer.overlayRects();
+    m_vecShownOverlays = m_renderer.overlayRects();
 
-            // Simplified blip - single color with alpha, no gradient
-            QColor blipColor = clr;
-            blipColor.setAlpha(nAlpha);
+    QHash<quint64, stTrackFootprint> hashShown;
+    hashShown.reserve(footprints.size());
+    for (const stTrackFootprint &footprint : footprints) {
+        hashShown.insert(footprint.key, footprint);
 
-            pPainter->setPen(Qt::NoPen);
-            pPainter->setBrush(blipColor);
-            pPainter->drawEllipse(ptScreen, nCurrentRadius, nCurrentRadius);
+        QHash<quint64, stTrackFootprint>::iterator it = m_hashShownFootprints.find(footprint.key);
+        if (it == m_hashShownFootprints.end()) {
+            appendFootprint(&vecDirty, footprint);
+            continue;
         }
-        
-        // Draw history trail if enabled - optimized version
-        if (track.showHistory && !track.historyPoints.isEmpty()) {
-            int totalPoints = track.historyPoints.size();
-            
-            // Only draw every Nth point for better performance with large histories
-            int step = (totalPoints > 50) ? 2 : 1;
-            
-            QPainterPath historyPath;
-            bool firstPoint = true;
-            
-            for (int i = 0; i < totalPoints; i += step) {
-                const stTrackHistoryPoint &histPoint = track.historyPoints[i];
-                QPointF histScreen = mapToPixel.transform(QgsPointXY(histPoint.lon, histPoint.lat)).toQPointF();
-                
-                if (firstPoint) {
-                    historyPath.moveTo(histScreen);
-                    firstPoint = false;
-                } else {
-                    historyPath.lineTo(histScreen);
-                }
+        const stTrackFootprint &shown = it.value();
+        if (shown.fingerprint != footprint.fingerprint || shown.rect != footprint.rect) {
+            vecDirty.append(shown.rect);
+            vecDirty.append(footprint.rect);
+        }
+        // Dashes shifted along the whole trail, or a point inside it moved
+        if (shown.trailFingerprint != footprint.trailFingerprint || shown.rectTrail != footprint.rectTrail) {
+            if (!shown.rectTrail.isNull()) {
+                vecDirty.append(shown.rectTrail);
+            }
+            if (!footprint.rectTrail.isNull()) {
+                vecDirty.append(footprint.rectTrail);
             }
-            
-            // Draw the history trail line
-            QColor trailColor = clr;
-            trailColor.setAlpha(120);
-            pPainter->setPen(QPen(trailColor, 1.5, Qt::DashLine));
-            pPainter->setBrush(Qt::NoBrush);
-            pPainter->drawPath(historyPath);
-            
-            // Draw line from last history point to current position
-            const stTrackHistoryPoint &lastPoint = track.historyPoints.last();
-            QPointF lastScreen = mapToPixel.transform(QgsPointXY(lastPoint.lon, lastPoint.lat)).toQPointF();
-            
-            QColor connectColor = clr;
-            connectColor.setAlpha(180);
-            pPainter->setPen(QPen(connectColor, 2, Qt::SolidLine));
-            pPainter->drawLine(lastScreen, ptScreen);
         }
+        m_hashShownFootprints.erase(it);
     }
 
-    // Draw focused track datatip (always visible, follows track)
-    if (m_focusedTrackId != -1) {
-        for (const stTrackDisplayInfo &track : listTracks) {
-            if (track.nTrkId == m_focusedTrackId) {
-                QPointF focusedScreen = mapToPixel.transform(QgsPointXY(track.lon, track.lat)).toQPointF();
-                
-                // Draw drone internal details if this track has an associated drone
-                if (track.pDrone) {
-                    drawDroneInternalDetails(pPainter, track, focusedScreen);
-                } else {
-                    // Otherwise draw regular datatip
-                    drawFocusedTrackDatatip(pPainter, track, focusedScreen);
-                }
-                break;
-            }
-        }
+    // What is left was deleted or left the view
+    for (QHash<quint64, stTrackFootprint>::const_iterator it = m_hashShownFootprints.constBegin();
+         it != m_hashShownFootprints.constEnd(); ++it) {
+        appendFootprint(&vecDirty, it.value());
     }
-    
-    // Draw tooltip for hovered track (draw last so it's on top, but not for focused tracks)
-    if (hasHoveredTrack && m_hoveredTrackId != -1 && m_hoveredTrackId != m_focusedTrackId) {
-        drawTooltip(pPainter, hoveredTrack, m_mousePos);
+    m_hashShownFootprints.swap(hashShown);
+
+    const QRectF canvasRect = boundingRect();
+    double dirtyArea = 0.0;
+    for (const QRectF &rect : vecDirty) {
+        QRectF visible = rect & canvasRect;
+        dirtyArea += visible.width() * visible.height();
     }
-}
 
+    if (fullRepaint || !scene() || vecDirty.size() > kMaxDirtyRects ||
+        dirtyArea > kFullRepaintCoverage * canvasRect.width() * canvasRect.height()) {
+        update();
+        return;
+    }
 
-QPixmap CTrackLayer::getDefaultDronePixmap(int size, const QColor &color, const QColor &accent)
+    // Through the scene, item updates would merge into one bounding rectangle
+    for (const QRectF &rect : vecDirty) {
+        if (rect.intersects(canvasRect)) {
+            scene()->update(mapRectToScene(rect.adjusted(-1, -1, 1, 1)));
+        }
+    }
+}
+
+void CTrackLayer::setThreadedRendering(bool enabled)
 {
-    // Create a triangular arrow-like shape to represent a drone nose-forward
-    QPixmap pix(size, size);
-    pix.fill(Qt::transparent);
-
-    QPainter painter(&pix);
-    painter.setRenderHint(QPainter::Antialiasing, true);
-
-    QPointF center(size / 2.0, size / 2.0);
-    double bodyRadius = size * 0.35;
-
-    // Body circle
-    painter.setPen(Qt::NoPen);
-    QColor bodyColor = color;
-    bodyColor.setAlpha(230);
-    painter.setBrush(bodyColor);
-    painter.drawEllipse(center, bodyRadius, bodyRadius);
-
-    // Nose triangle pointing up (will be rotated later)
-    QPainterPath nose;
-    double tipY = size * 0.08;
-    double baseY = size * 0.45;
-    double halfWidth = size * 0.18;
-    nose.moveTo(center.x(), tipY);
-    nose.lineTo(center.x() - halfWidth, baseY);
-    nose.lineTo(center.x() + halfWidth, baseY);
-    nose.closeSubpath();
-    QColor noseColor = accent;
-    noseColor.setAlpha(240);
-    painter.setBrush(noseColor);
-    painter.drawPath(nose);
-
-    // Tail fin
-    QPainterPath tail;
-    double tailTop = size * 0.55;
-    double tailBottom = size * 0.9;
-    double tailHalfWidth = size * 0.12;
-    tail.moveTo(center.x(), tailTop);
-    tail.lineTo(center.x() - tailHalfWidth, tailBottom);
-    tail.lineTo(center.x() + tailHalfWidth, tailBottom);
-    tail.closeSubpath();
-    QColor tailColor = color.darker(130);
-    tailColor.setAlpha(220);
-    painter.setBrush(tailColor);
-    painter.drawPath(tail);
-
-    // Outline
-    painter.setBrush(Qt::NoBrush);
-    painter.setPen(QPen(QColor(255,255,255,180), 1));
-    painter.drawEllipse(center, bodyRadius, bodyRadius);
-
-    painter.end();
-    return pix;
+    if (enabled == m_bThreadedRendering) {
+        return;
+    }
+
+    // The renderer is used by one thread at a time
+    m_renderWatcher.waitForFinished();
+    m_bRenderInFlight = false;
+    m_bThreadedRendering = enabled;
+    m_bFrameQueued = false;
+    m_queuedFrame = stTrackFrame();
+    m_frontImage = QImage();
+    m_backImage = QImage();
+    m_hashShownFootprints.clear();
+    m_vecShownOverlays.clear();
+    m_bFullRepaint = true;
+    requestFrame();
+    update();
 }
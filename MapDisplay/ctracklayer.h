@@ -36,9 +36,18 @@
 #include <QPixmap>
 #include <QHash>
 #include <QMap>
+#include <QVector>
+#include <QImage>
+#include <QFutureWatcher>
+#include "cscreenprojector.h"
+#include "ctrackrenderer.h"
+#include "ctrackclusterer.h"
+#include "ctracktrailcache.h"
+#include "ctrackhitgrid.h"
+#include "cframescheduler.h"
+#include "cframeprofiler.h"
 
-// Forward declaration
-struct stTrackDisplayInfo;
+#include "../globalstructs.h"
 
 class CTrackLayer : public QObject, public QgsMapCanvasItem
 {
@@ -50,6 +59,43 @@ public:
     void paint(QPainter *painter) override;
     QRectF boundingRect() const override;
 
+    /**
+     * @brief Sets the scale of the drawn position uncertainty ellipses
+     * @param nSigma 0 hides the ellipses, 1 or 2 draws the 1-sigma or 2-sigma ellipse
+     */
+    void setUncertaintyEllipseSigma(int nSigma);
+    int uncertaintyEllipseSigma() const { return m_nEllipseSigma; }
+
+    /**
+     * @brief Extrapolates track symbols from their last report to the frame time
+     * @param enabled Dead reckoning on or off
+     * @param maxExtrapolationMs Reports older than this are held at this extrapolation
+     */
+    void setDeadReckoning(bool enabled, int maxExtrapolationMs = 3000);
+    bool isDeadReckoningEnabled() const { return m_bDeadReckoning; }
+
+    /**
+     * @brief Aggregates nearby tracks into cluster glyphs when zoomed out
+     *
+     * At overview scale every cell shared by two tracks clusters; closer in only dense
+     * cells do, until the symbols have room and every track is drawn on its own.
+     */
+    void setClustering(bool enabled);
+    bool isClusteringEnabled() const { return m_bClustering; }
+
+    /**
+     * @brief Renders the overlay on a worker thread and only blits finished frames in paint()
+     *
+     * When disabled, paint() draws the tracks itself on the GUI thread.
+     */
+    void setThreadedRendering(bool enabled);
+    bool isThreadedRendering() const { return m_bThreadedRendering; }
+
+    /**
+     * @brief Duration of the last completed overlay render in milliseconds
+     */
+    double lastRenderMs() const { return m_renderer.lastRenderMs(); }
+
 signals:
     void trackRightClicked(int trackId, const QPoint& globalPos);
 
@@ -60,14 +106,16 @@ protected:
     bool eventFilter(QObject *obj, QEvent *event) override;
 
 private slots:
-    void _UpdateAnimation(); //!< Timer-based animation tick
+    void onFrame(qint64 nowMs); //!< Canvas tick: animation step and requested frames
+    void onRenderFinished(); //!< Worker frame done, swap buffers and blit
 
 private slots:
     //void showContextMenu(const QPoint& pos);
 
 private:
     QgsMapCanvas *m_canvas;
-    QTimer m_timer;
+    CFrameScheduler *m_pScheduler; //!< Canvas tick and animation clock, owned by the canvas
+    CFrameProfiler *m_pProfiler;   //!< Canvas profiler, owned by the canvas
     QMenu *m_contextMenu;
 
     // Tooltip support members
@@ -83,67 +131,150 @@ private:
     QPixmap m_droneIcon;           //!< Default drone icon image
     QMap<int, QPixmap> m_trackImages; //!< Custom images for specific track IDs
 
-    // Cached images for track icons
-    QHash<int, QPixmap> m_trackPixmaps; //!< Cache of loaded images by track ID
-    QHash<QString, QPixmap> m_defaultIconCache; //!< Cache for generated default icons
-    QHash<QString, QPixmap> m_rotatedImageCache; //!< Cache for rotated images (key: "trackId_heading")
+    // Overlay rendering, double buffered: the worker draws m_backImage while paint()
+    // blits m_frontImage, swapped on the GUI thread when a render finishes
+    CTrackRenderer m_renderer;
+    QFutureWatcher<void> m_renderWatcher;
+    QImage m_frontImage;           //!< Last completed frame
+    QImage m_backImage;            //!< Frame in progress, owned by the worker while it runs
+    stTrackFrame m_queuedFrame;    //!< Latest frame taken while a render was running
+    bool m_bFrameQueued;
+    bool m_bRenderInFlight;        //!< Started and its finished() not handled yet; the worker may be done
+    bool m_bFrameRequested;        //!< Tracks, view or display state changed since the last frame
+    bool m_bImagesChanged;         //!< A custom track image was replaced since the last frame
+    bool m_bFullRepaint;           //!< The next frame invalidates the whole canvas
+    bool m_bRenderFullRepaint;     //!< Same, for the frame being rendered
+    bool m_bThreadedRendering;
+
+    // Dirty rectangles: what the front image shows, compared against each new frame
+    QHash<quint64, stTrackFootprint> m_hashShownFootprints;   //!< Key: stTrackFootprint::key
+    QVector<QRectF> m_vecShownOverlays;
     
     // Mouse move throttling
     QTimer m_mouseMoveThrottle;
     QPointF m_pendingMousePos;
     bool m_hasPendingMouseMove;
 
+    int m_nEllipseSigma;           //!< Uncertainty ellipse scale, 0 when disabled
+    bool m_bDeadReckoning;         //!< Extrapolate track positions to the frame time
+    int m_nMaxExtrapolationMs;     //!< Staleness cutoff for dead reckoning
+    bool m_bClustering;            //!< Level-of-detail clustering when zoomed out
+
+    // Per-frame projection, shared by paint, hit testing and label placement
+    CScreenProjector m_projector;
+    bool m_bFrameValid;
+    quint64 m_nFrameDataVersion;                //!< Warehouse version m_frameTracks was taken at
+    QList<stTrackDisplayInfo> m_frameTracks;    //!< Track snapshot for the current frame
+    QVector<double> m_vecTrackLon;
+    QVector<double> m_vecTrackLat;
+    QVector<double> m_vecTrackLonRate;          //!< Dead reckoning rates (deg/s)
+    QVector<double> m_vecTrackLatRate;
+    QVector<qint64> m_vecTrackUpdateMs;         //!< Report time of m_frameTracks[i]
+    QVector<double> m_vecTrackExtrapSec;        //!< Per-frame extrapolation time (s)
+    qint64 m_nNewestUpdateMs;                   //!< Latest report time in m_vecTrackUpdateMs
+    QVector<double> m_vecTrackScreenX;          //!< Screen X of m_frameTracks[i]
+    QVector<double> m_vecTrackScreenY;          //!< Screen Y of m_frameTracks[i]
+    CTrackTrailCache m_trailCache;              //!< History trails of m_frameTracks in map coordinates
+    QVector<int> m_vecHistoryStart;             //!< Simplified trail of track i is [start[i], start[i+1])
+    QVector<double> m_vecHistoryLon;
+    QVector<double> m_vecHistoryLat;
+    QVector<double> m_vecHistoryScreenX;
+    QVector<double> m_vecHistoryScreenY;
+    QVector<QRectF> m_vecHistoryBounds;         //!< Screen bounding box of each trail, null when none
+    QVector<int> m_vecVisibleTracks;            //!< Frame tracks that can reach the view, paint order
+    QRectF m_rectCull;                          //!< View rectangle plus the culling margin
+    bool m_bBlipsVisible;                       //!< A visible track is focused, hovered or highlighted
+    CTrackClusterer m_clusterer;                //!< Geographic cells of m_frameTracks
+    QVector<stTrackCluster> m_vecClusters;      //!< Cluster glyphs that reach the view
+    QVector<quint64> m_vecClusterCells;         //!< Scratch for projecting cluster centroids
+    QVector<double> m_vecClusterLon;
+    QVector<double> m_vecClusterLat;
+    QVector<double> m_vecClusterScreenX;
+    QVector<double> m_vecClusterScreenY;
+    CTrackHitGrid m_hitGrid;                    //!< Screen bins of m_vecVisibleTracks for hit testing
+
     /**
-     * @brief Creates the context menu for tracks
+     * @brief Refreshes the track snapshot and its screen positions
+     *
+     * Refetches from the warehouse only when its data version moved and reprojects
+     * only when the data or the canvas transform changed, or every call while dead
+     * reckoning moves the track positions with time.
      */
-    void createContextMenu();
+    void updateFrameProjection();
 
-    // Helpers for icon rendering
-    QPixmap getDefaultDronePixmap(int size, const QColor &color, const QColor &accent);
+    /**
+     * @brief Screen bounding box of every trail, after the history was reprojected
+     */
+    void updateHistoryBounds();
 
     /**
-     * @brief Detects if a track is at the given position
-     * @param pos Mouse position in screen coordinates
-     * @return Track ID if found, -1 otherwise
+     * @brief Collects the tracks whose symbol, uncertainty ellipse or trail reaches the view
+     *
+     * Tracks in clustered cells are left out and their cells become cluster glyphs.
+     * Rebuilds the hit testing grid from the tracks that stay.
      */
-    int getTrackAtPosition(const QPointF &pos);
+    void cullTracks();
 
     /**
-     * @brief Draws tooltip with track information
-     * @param pPainter QPainter instance
-     * @param trackInfo Track information to display
-     * @param screenPos Screen position for tooltip
+     * @brief Schedules a new overlay frame on the next canvas tick
+     *
+     * Threaded, the frame goes to the worker and the canvas is invalidated when it is done;
+     * otherwise the tick repaints.
      */
-    void drawTooltip(QPainter *pPainter, const stTrackDisplayInfo &trackInfo, const QPointF &screenPos);
-    
+    void requestFrame();
+
     /**
-     * @brief Draws speed vector for a track
-     * @param pPainter QPainter instance
-     * @param trackInfo Track information
-     * @param screenPos Screen position of track
-     * @param trackColor Color of the track
+     * @brief Blips are visible or dead reckoning still moves symbols
      */
-    void drawSpeedVector(QPainter *pPainter, const stTrackDisplayInfo &trackInfo, 
-                        const QPointF &screenPos, const QColor &trackColor);
-    
+    bool isAnimating() const;
+
     /**
-     * @brief Draws focused track datatip that follows the track
-     * @param pPainter QPainter instance
-     * @param trackInfo Track information
-     * @param screenPos Screen position of track
+     * @brief Hands a frame to the worker if one was requested, or queues it behind the running one
      */
-    void drawFocusedTrackDatatip(QPainter *pPainter, const stTrackDisplayInfo &trackInfo, 
-                                const QPointF &screenPos);
-    
+    void submitFrame();
+
     /**
-     * @brief Draws drone internal details panel
-     * @param pPainter QPainter instance
-     * @param trackInfo Track information with drone pointer
-     * @param screenPos Screen position of track
+     * @brief Invalidates the areas where the new front image differs from the last one
+     *
+     * Compares the renderer's footprints with those of the previous frame and repaints
+     * the old and new area of every track that moved or changed, plus tracks that
+     * appeared or disappeared. Falls back to a full repaint above a coverage threshold.
+     * @param fullRepaint Skip the comparison and repaint the whole canvas
      */
-    void drawDroneInternalDetails(QPainter *pPainter, const stTrackDisplayInfo &trackInfo, 
-                                  const QPointF &screenPos);
-    
+    void invalidateChanged(bool fullRepaint);
+
+    /**
+     * @brief Fills a render frame from the current projection and display state
+     * @param pFrame Frame to fill
+     * @param devicePixelRatio Pixel ratio of the canvas painter
+     */
+    void takeFrame(stTrackFrame *pFrame, qreal devicePixelRatio);
+
+    /**
+     * @brief Reports the last render's label and cache figures to the profiler
+     */
+    void reportRenderStats();
+
+    /**
+     * @brief Starts rendering a frame into the back buffer on the thread pool
+     */
+    void startRender(const stTrackFrame &frame);
+
+    /**
+     * @brief Creates the context menu for tracks
+     */
+    void createContextMenu();
+
+    /**
+     * @brief Detects if a track is at the given position
+     *
+     * Answered from the hit grid of the last projected frame, so it matches what is on
+     * screen and costs the same at any track count.
+     * @param pos Mouse position in screen coordinates
+     * @return Track ID if found, -1 otherwise
+     */
+    int getTrackAtPosition(const QPointF &pos);
+
     /**
      * @brief Draws a rotated drone image based on heading
      * @param pPainter QPainter instance
@@ -0,0 +1,1078 @@
+#include "ctrackrenderer.h"
+#include "crendercache.h"
+#include "globalmacros.h"
+#include <QElapsedTimer>
+#include <QPainterPath>
+#include <QTransform>
+#include <QtMath>
+#include <cmath>
+#include <functional>
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+namespace {
+
+// Largest reach of the symbol, its highlight and hover rings, the blip and a rotated custom image
+const double kSymbolReachPx = 32.0;
+
+// Room for a track number or speed label
+const double kLabelWidthPx = 64.0;
+
+// Trail points at the new end of a trail kept in a track's footprint
+const int kTrailEndPoints = 3;
+
+// Cluster glyph radius grows with the member count up to this
+const double kClusterMaxRadiusPx = 24.0;
+
+// Transparent border around a cached panel, room for the drone panel's shadow and the outline
+const double kPanelMarginPx = 4.0;
+
+// Panel kinds, the first value of a panel cache key
+const int kPanelTooltip = 1;
+const int kPanelDatatip = 2;
+const int kPanelDrone = 3;
+
+// Cache cost of an image, its pixel storage
+inline qint64 imageBytes(const QImage &image)
+{
+    return qint64(image.bytesPerLine()) * image.height();
+}
+
+// Cleared image a panel is rendered into, in logical size
+inline QImage newPanelImage(const QSizeF &size, qreal dpr)
+{
+    QImage image(qCeil(size.width() * dpr), qCeil(size.height() * dpr), QImage::Format_ARGB32_Premultiplied);
+    image.setDevicePixelRatio(dpr);
+    image.fill(Qt::transparent);
+    return image;
+}
+
+// Panel cache key from the text a panel draws: reports that format the same share an image
+quint64 panelKey(int kind, qreal dpr, const QStringList &lines)
+{
+    quint64 key = CRenderCache::hashCombine(1469598103934665603ull, kind);
+    key = CRenderCache::hashCombine(key, dpr);
+    for (const QString &line : lines) {
+        key = CRenderCache::hashCombine(key, qHash(line));
+    }
+    return key;
+}
+
+// Identity text, icon and colour of the tooltip and the datatip
+struct stIdentityDisplay {
+    QString text;
+    QString icon;
+    QColor color;
+};
+
+stIdentityDisplay identityDisplay(int nTrackIden)
+{
+    switch (nTrackIden) {
+        case TRACK_IDENTITY_FRIEND:
+            return { "FRIENDLY", "✓", QColor(46, 204, 113) };  // Modern green
+        case TRACK_IDENTITY_HOSTILE:
+            return { "HOSTILE", "✖", QColor(231, 76, 60) };    // Modern red
+        case TRACK_IDENTITY_UNKNOWN:
+            return { "UNKNOWN", "?", QColor(241, 196, 15) };   // Modern yellow
+        default:
+            return { "UNDEFINED", "•", QColor(149, 165, 166) };
+    }
+}
+
+// Minimal tooltip content
+QStringList tooltipLines(const stTrackDisplayInfo &trackInfo)
+{
+    const stIdentityDisplay identity = identityDisplay(trackInfo.nTrackIden);
+    QStringList lines;
+    lines << QString("ID %1").arg(trackInfo.nTrkId);
+    lines << QString("%1 %2").arg(identity.icon).arg(identity.text);
+    lines << "";
+    lines << QString("📍 %1°, %2°").arg(trackInfo.lat, 0, 'f', 4).arg(trackInfo.lon, 0, 'f', 4);
+    lines << QString("📏 %1 km").arg(trackInfo.range / 1000.0, 0, 'f', 1);
+    lines << QString("🧭 %1°").arg(trackInfo.heading, 0, 'f', 0);
+    lines << QString("⬆ %1 m").arg(trackInfo.alt, 0, 'f', 0);
+    return lines;
+}
+
+// Focused track tooltip content (more compact)
+QStringList datatipLines(const stTrackDisplayInfo &trackInfo)
+{
+    const stIdentityDisplay identity = identityDisplay(trackInfo.nTrackIden);
+    QStringList lines;
+    lines << QString("🎯 FOCUSED: ID %1").arg(trackInfo.nTrkId);
+    lines << QString("%1 %2").arg(identity.icon).arg(identity.text);
+    lines << QString("🚀 %1 m/s").arg(trackInfo.velocity, 0, 'f', 1);
+    lines << QString("🧭 %1°").arg(trackInfo.heading, 0, 'f', 0);
+    return lines;
+}
+
+// Drone panel content from the frame's copy of the drone state
+QStringList dronePanelLines(const stTrackDisplayInfo &trackInfo, const stTrackFrame &frame)
+{
+    const stDroneInternalState &droneState = frame.focusedDroneState;
+    QStringList lines;
+    lines << QString("🚁 DRONE #%1").arg(trackInfo.nTrkId);
+    lines << QString("━━━━━━━━━━━━━━");
+    lines << QString("MODE: %1").arg(frame.focusedDroneMode);
+    lines << QString("STATUS: %1").arg(droneState.statusMessage);
+    lines << "";
+    lines << QString("⚡ POWER");
+    lines << QString("  Battery: %1%").arg(droneState.batteryLevel, 0, 'f', 1);
+    lines << QString("  Voltage: %1V").arg(droneState.batteryVoltage, 0, 'f', 2);
+    lines << QString("  Flight Time: %1m").arg(droneState.estimatedFlightTime, 0, 'f', 1);
+    lines << "";
+    lines << QString("🎯 DYNAMICS");
+    lines << QString("  Speed: %1 m/s").arg(droneState.groundSpeed, 0, 'f', 1);
+    lines << QString("  V-Speed: %1 m/s").arg(droneState.verticalSpeed, 0, 'f', 1);
+    lines << QString("  Accel: %1 m/s²").arg(droneState.acceleration, 0, 'f', 2);
+    lines << QString("  Turn: %1°/s").arg(droneState.turnRate, 0, 'f', 1);
+    lines << QString("  Heading: %1°").arg(droneState.yaw, 0, 'f', 1);
+    lines << "";
+    lines << QString("🎚️ ATTITUDE");
+    lines << QString("  Pitch: %1°").arg(droneState.pitch, 0, 'f', 1);
+    lines << QString("  Roll: %1°").arg(droneState.roll, 0, 'f', 1);
+    lines << QString("  Yaw: %1°").arg(droneState.yaw, 0, 'f', 1);
+    lines << "";
+    lines << QString("📡 SENSORS");
+    lines << QString("  GPS: %1%2").arg(droneState.sensors.gpsActive ? "✓" : "✗").arg(QString(" %1%").arg(droneState.sensors.gpsQuality));
+    lines << QString("  Link: %1%").arg(droneState.sensors.linkQuality);
+    lines << QString("  IMU: %1").arg(droneState.sensors.imuActive ? "✓" : "✗");
+    lines << "";
+    lines << QString("📍 MISSION");
+    lines << QString("  ID: %1").arg(droneState.missionId);
+    lines << QString("  WP: %1/%2").arg(droneState.waypointIndex).arg(droneState.totalWaypoints);
+    lines << QString("  Progress: %1%").arg(droneState.missionProgress, 0, 'f', 0);
+    return lines;
+}
+
+} // namespace
+
+CTrackRenderer::CTrackRenderer()
+    : m_trackImages(32 * 1024 * 1024), m_rotatedImageCache(16 * 1024 * 1024), m_panelCache(4 * 1024 * 1024),
+      m_pFrame(nullptr), m_dLastRenderMs(0.0)
+{
+}
+
+void CTrackRenderer::build()
+{
+    // Default track symbols for every identity, state and heading
+    m_symbolAtlas.build();
+}
+
+void CTrackRenderer::renderImage(const stTrackFrame &frame, QImage *pImage)
+{
+    const qreal dpr = frame.devicePixelRatio;
+    QSize pixelSize(qCeil(frame.size.width() * dpr), qCeil(frame.size.height() * dpr));
+    if (pImage->size() != pixelSize) {
+        *pImage = QImage(pixelSize, QImage::Format_ARGB32_Premultiplied);
+    }
+    pImage->setDevicePixelRatio(dpr);
+    pImage->fill(Qt::transparent);
+
+    QPainter painter(pImage);
+    render(frame, &painter);
+}
+
+/**
+ * @brief Draws the tracks of a frame
+ * @param frame Frame taken by the track layer
+ * @param pPainter QPainter instance used for drawing
+ */
+void CTrackRenderer::render(const stTrackFrame &frame, QPainter *pPainter)
+{
+    if (!pPainter) return;
+
+    QElapsedTimer timer;
+    timer.start();
+    m_pFrame = &frame;
+
+    if (frame.invalidateImages) {
+        // Rotations of a previous image are keyed by track, drop them (rare, user action)
+        m_trackImages.clear();
+        m_rotatedImageCache.clear();
+    }
+
+    pPainter->setRenderHint(QPainter::Antialiasing, true);
+
+    const QList<stTrackDisplayInfo> &listTracks = frame.tracks;
+    const double pixelPerDegree = frame.pixelPerDegree;
+
+    stTrackDisplayInfo hoveredTrack;
+    bool hasHoveredTrack = false;
+    m_labelEngine.begin(frame.size);
+    m_vecLabelFootprints.resize(0);
+    m_vecFootprints.resize(0);
+    m_vecOverlayRects.resize(0);
+
+    // Clustered tracks are not in visibleTracks, their glyphs go underneath the rest
+    drawClusters(pPainter);
+
+    // Only tracks whose symbol, ellipse or trail can reach the view
+    for (int nTrack : frame.visibleTracks) {
+        const stTrackDisplayInfo &track = listTracks[nTrack];
+        QPointF ptScreen(frame.trackScreenX[nTrack], frame.trackScreenY[nTrack]);
+        QColor clr = Qt::cyan;
+
+        // Check track states
+        bool isHovered = (track.nTrkId == frame.hoveredTrackId);
+        bool isHighlighted = frame.highlightedTracks.contains(track.nTrkId);
+        bool isFocused = (track.nTrkId == frame.focusedTrackId);
+        
+        if (isHovered) {
+            hoveredTrack = track;
+            hasHoveredTrack = true;
+        }
+
+        m_vecFootprints.append(trackFootprint(nTrack, (isHovered ? 1 : 0) | (isHighlighted ? 2 : 0) |
+                                                      (isFocused ? 4 : 0)));
+
+        switch (track.nTrackIden) {
+        case TRACK_IDENTITY_UNKNOWN:
+            clr = Qt::yellow;
+            break;
+        case TRACK_IDENTITY_FRIEND:
+            clr = Qt::green;
+            break;
+        case TRACK_IDENTITY_HOSTILE:
+            clr = Qt::red;
+            break;
+        }
+
+        if (pixelPerDegree > PPI_VISIBLE_THRESHOLD) {
+            // Determine track size based on state
+            double trackSize = 4;
+            if (isHighlighted) trackSize = 8;  // Larger for highlighted tracks
+            if (isFocused) trackSize = 10;     // Even larger for focused tracks
+            
+            // Highlight effects
+            if (isHighlighted || isFocused) {
+                // Outer highlight ring
+                pPainter->setPen(QPen(Qt::white, 3));
+                pPainter->setBrush(Qt::NoBrush);
+                pPainter->drawEllipse(ptScreen, trackSize + 6, trackSize + 6);
+
+                // Inner glow effect
+                pPainter->setPen(QPen(clr, 2));
+                pPainter->drawEllipse(ptScreen, trackSize + 3, trackSize + 3);
+            }
+            
+            // Hover effect (additional to highlight/focus)
+            if (isHovered) {
+                pPainter->setPen(QPen(Qt::cyan, 2));
+                pPainter->setBrush(Qt::NoBrush);
+                pPainter->drawEllipse(ptScreen, trackSize + 8, trackSize + 8);
+            }
+
+            bool drawnCustomImage = false;
+            // Draw custom image if available for this track
+            if (!track.imagePath.isEmpty()) {
+                // Ensure image cached; if not, attempt load
+                const QImage *pSource = m_trackImages.find(track.nTrkId);
+                if (!pSource) {
+                    QImage image(track.imagePath);
+                    if (!image.isNull()) {
+                        m_trackImages.insert(track.nTrkId, image, imageBytes(image));
+                        pSource = m_trackImages.find(track.nTrkId);
+                    }
+                }
+
+                if (pSource) {
+                    int baseSize = isFocused ? 40 : (isHighlighted ? 32 : 24);
+                    
+                    // Round heading to nearest 5 degrees for better cache hits
+                    int roundedHeading = static_cast<int>(track.heading / 5.0) * 5;
+                    quint64 cacheKey = CLruCache<QImage>::makeKey(quint32(track.nTrkId), quint16(baseSize),
+                                                                  quint16(roundedHeading));
+                    
+                    QImage rotated;
+                    if (const QImage *pRotated = m_rotatedImageCache.find(cacheKey)) {
+                        rotated = *pRotated;
+                    } else {
+                        QImage scaled = pSource->scaled(baseSize, baseSize, Qt::KeepAspectRatio, Qt::SmoothTransformation);
+                        QTransform transform;
+                        transform.translate(scaled.width() / 2.0, scaled.height() / 2.0);
+                        transform.rotate(-roundedHeading);
+                        transform.translate(-scaled.width() / 2.0, -scaled.height() / 2.0);
+                        rotated = scaled.transformed(transform, Qt::SmoothTransformation);
+                        m_rotatedImageCache.insert(cacheKey, rotated, imageBytes(rotated));
+                    }
+
+                    // Draw centered at ptScreen
+                    QPointF topLeft(ptScreen.x() - rotated.width() / 2.0,
+                                    ptScreen.y() - rotated.height() / 2.0);
+                    pPainter->drawImage(topLeft, rotated);
+                    drawnCustomImage = true;
+                }
+            }
+
+            if (!drawnCustomImage) {
+                // Fallback: default drone marker from the atlas, drawn with the frame's batch
+                int symbolState = isFocused ? CTrackSymbolAtlas::SYMBOL_FOCUSED
+                                            : (isHighlighted ? CTrackSymbolAtlas::SYMBOL_HIGHLIGHTED
+                                                             : CTrackSymbolAtlas::SYMBOL_NORMAL);
+                m_symbolAtlas.addSymbol(ptScreen, CTrackSymbolAtlas::identityIndex(track.nTrackIden),
+                                        symbolState, track.heading);
+            }
+
+            if (frame.ellipseSigma > 0 && track.hasCovariance) {
+                drawUncertaintyEllipse(pPainter, track, ptScreen, pixelPerDegree, clr);
+            }
+
+            // Draw speed vector instead of simple heading line
+            drawSpeedVector(pPainter, track, ptScreen, clr);
+
+            // Labels go on top of the symbol batch, after the loop, placed by priority
+            if (pixelPerDegree > TEXT_VISIBLE_THRESHOLD) {
+                int priority = isFocused ? 4 : (isHovered ? 3 : (isHighlighted ? 2 :
+                               (track.nTrackIden == TRACK_IDENTITY_HOSTILE ? 1 : 0)));
+                m_labelEngine.addLabel(track.nTrkId, ptScreen, priority);
+                m_vecLabelFootprints.append(m_vecFootprints.size() - 1);
+            }
+        } else if (frame.clustering) {
+            // Overview level of detail: tracks left out of the clusters show as a dot
+            pPainter->setPen(Qt::NoPen);
+            int identity = CTrackSymbolAtlas::identityIndex(track.nTrackIden);
+            pPainter->setBrush(CTrackSymbolAtlas::identityColor(identity));
+            pPainter->drawEllipse(ptScreen, 3, 3);
+        }
+
+        // Simplified blip animation - only for highlighted/focused tracks to improve performance
+        if (isHighlighted || isFocused || isHovered) {
+            int nMaxRadius = 20;
+            int nCurrentRadius = 4 + (frame.animFrame * (nMaxRadius - 4) / 20);
+            int nAlpha = 255 - (frame.animFrame * 255 / 20);
+
+            // Simplified blip - single color with alpha, no gradient
+            QColor blipColor = clr;
+            blipColor.setAlpha(nAlpha);
+
+            pPainter->setPen(Qt::NoPen);
+            pPainter->setBrush(blipColor);
+            pPainter->drawEllipse(ptScreen, nCurrentRadius, nCurrentRadius);
+        }
+        
+        // Draw history trail if enabled, already simplified for the zoom level
+        int histStart = frame.historyStart[nTrack];
+        int totalPoints = frame.historyStart[nTrack + 1] - histStart;
+        if (totalPoints > 0) {
+            QColor trailColor = clr;
+            trailColor.setAlpha(120);
+            pPainter->setPen(QPen(trailColor, 1.5, Qt::DashLine));
+            pPainter->setBrush(Qt::NoBrush);
+
+            // Clip per segment: segments outside the view are skipped and the polyline
+            // restarts at the next visible one
+            m_vecTrailPoints.resize(0);
+            QPointF prevScreen(frame.historyScreenX[histStart], frame.historyScreenY[histStart]);
+            for (int i = 1; i < totalPoints; ++i) {
+                QPointF histScreen(frame.historyScreenX[histStart + i], frame.historyScreenY[histStart + i]);
+                if (segmentInView(prevScreen, histScreen)) {
+                    if (m_vecTrailPoints.isEmpty()) {
+                        m_vecTrailPoints.append(prevScreen);
+                    }
+                    m_vecTrailPoints.append(histScreen);
+                } else if (!m_vecTrailPoints.isEmpty()) {
+                    pPainter->drawPolyline(m_vecTrailPoints.constData(), m_vecTrailPoints.size());
+                    m_vecTrailPoints.resize(0);
+                }
+                prevScreen = histScreen;
+            }
+            if (!m_vecTrailPoints.isEmpty()) {
+                pPainter->drawPolyline(m_vecTrailPoints.constData(), m_vecTrailPoints.size());
+            }
+
+            // Draw line from last history point to current position
+            int nLast = histStart + totalPoints - 1;
+            QPointF lastScreen(frame.historyScreenX[nLast], frame.historyScreenY[nLast]);
+            
+            if (segmentInView(lastScreen, ptScreen)) {
+                QColor connectColor = clr;
+                connectColor.setAlpha(180);
+                pPainter->setPen(QPen(connectColor, 2, Qt::SolidLine));
+                pPainter->drawLine(lastScreen, ptScreen);
+            }
+        }
+    }
+
+    // All default symbols in one draw, then their labels
+    m_symbolAtlas.drawPending(pPainter);
+
+    if (!m_vecLabelFootprints.isEmpty()) {
+        m_labelEngine.layout();
+
+        // A neighbour can push a label to another side, that changes what the track shows
+        for (int i = 0; i < m_vecLabelFootprints.size(); ++i) {
+            stTrackFootprint &footprint = m_vecFootprints[m_vecLabelFootprints[i]];
+            footprint.fingerprint = CRenderCache::hashCombine(footprint.fingerprint, m_labelEngine.placement(i));
+        }
+        m_labelEngine.draw(pPainter, Qt::white);
+    }
+
+    // Draw focused track datatip (always visible, follows track)
+    if (frame.focusedTrackId != -1) {
+        for (int nTrack : frame.visibleTracks) {
+            const stTrackDisplayInfo &track = listTracks[nTrack];
+            if (track.nTrkId == frame.focusedTrackId) {
+                QPointF focusedScreen(frame.trackScreenX[nTrack], frame.trackScreenY[nTrack]);
+                
+                // Draw drone internal details if this track has an associated drone
+                if (frame.hasFocusedDrone) {
+                    drawDroneInternalDetails(pPainter, track, focusedScreen);
+                } else {
+                    // Otherwise draw regular datatip
+                    drawFocusedTrackDatatip(pPainter, track, focusedScreen);
+                }
+                break;
+            }
+        }
+    }
+    
+    // Draw tooltip for hovered track (draw last so it's on top, but not for focused tracks)
+    if (hasHoveredTrack && frame.hoveredTrackId != -1 && frame.hoveredTrackId != frame.focusedTrackId) {
+        drawTooltip(pPainter, hoveredTrack, frame.mousePos);
+    }
+
+    m_pFrame = nullptr;
+    m_dLastRenderMs = timer.nsecsElapsed() / 1.0e6;
+}
+
+stTrackFootprint CTrackRenderer::trackFootprint(int nTrack, int stateBits) const
+{
+    const stTrackFrame &frame = *m_pFrame;
+    const stTrackDisplayInfo &track = frame.tracks[nTrack];
+    const QPointF ptScreen(frame.trackScreenX[nTrack], frame.trackScreenY[nTrack]);
+
+    stTrackFootprint footprint;
+    footprint.key = quint32(track.nTrkId);
+
+    // Symbol, rings, blip and the track number label on any side the label engine picks
+    QRectF rect(ptScreen.x() - kSymbolReachPx, ptScreen.y() - kSymbolReachPx,
+                2 * kSymbolReachPx, 2 * kSymbolReachPx);
+    rect |= QRectF(ptScreen.x() - 6 - kLabelWidthPx, ptScreen.y() - 30,
+                   2 * (6 + kLabelWidthPx), 60);
+
+    // Speed vector, arrowhead and speed text, as drawSpeedVector() places them
+    if (track.velocity > 0) {
+        double length = qMin(track.velocity * 2.0, 50.0);
+        double headingRad = qDegreesToRadians(track.heading);
+        QPointF direction(std::cos(headingRad), -std::sin(headingRad));
+        QPointF vectorEnd = ptScreen + direction * length;
+        rect |= QRectF(vectorEnd - QPointF(8, 8), QSizeF(16, 16));
+        QPointF textPos = ptScreen + direction * (length * 0.6);
+        rect |= QRectF(textPos + QPointF(0, -12), QSizeF(kLabelWidthPx, 16));
+    }
+
+    quint64 hash = CRenderCache::hashCombine(1469598103934665603ull, ptScreen.x());
+    hash = CRenderCache::hashCombine(hash, ptScreen.y());
+    hash = CRenderCache::hashCombine(hash, track.heading);
+    hash = CRenderCache::hashCombine(hash, track.velocity);
+    hash = CRenderCache::hashCombine(hash, track.nTrackIden);
+    hash = CRenderCache::hashCombine(hash, stateBits);
+    hash = CRenderCache::hashCombine(hash, stateBits ? frame.animFrame : -1); // Blip only when flagged
+    hash = CRenderCache::hashCombine(hash, qHash(track.imagePath));
+
+    if (frame.ellipseSigma > 0 && track.hasCovariance) {
+        double reach = track.ellipseMajor * frame.pixelPerDegree * frame.ellipseSigma + 1.0;
+        rect |= QRectF(ptScreen.x() - reach, ptScreen.y() - reach, 2 * reach, 2 * reach);
+        hash = CRenderCache::hashCombine(hash, track.ellipseMajor);
+        hash = CRenderCache::hashCombine(hash, track.ellipseMinor);
+        hash = CRenderCache::hashCombine(hash, track.ellipseAngle);
+    }
+
+    // Trail: new points and the connector join next to the symbol. The dash pattern runs
+    // from the first point, so when the oldest point drops off or the point count changes
+    // the dashes move along the whole trail; the trail fingerprint covers exactly that
+    const int histStart = frame.historyStart[nTrack];
+    const int totalPoints = frame.historyStart[nTrack + 1] - histStart;
+    quint64 trailHash = CRenderCache::hashCombine(1469598103934665603ull, totalPoints);
+    if (totalPoints > 0) {
+        const double *pX = frame.historyScreenX.constData() + histStart;
+        const double *pY = frame.historyScreenY.constData() + histStart;
+        for (int i = qMax(0, totalPoints - kTrailEndPoints); i < totalPoints; ++i) {
+            rect |= QRectF(pX[i] - 2, pY[i] - 2, 4, 4);
+        }
+        hash = CRenderCache::hashCombine(hash, pX[totalPoints - 1]);
+        hash = CRenderCache::hashCombine(hash, pY[totalPoints - 1]);
+
+        double left = pX[0], right = pX[0], top = pY[0], bottom = pY[0];
+        for (int i = 1; i < totalPoints; ++i) {
+            left = qMin(left, pX[i]);
+            right = qMax(right, pX[i]);
+            top = qMin(top, pY[i]);
+            bottom = qMax(bottom, pY[i]);
+        }
+        footprint.rectTrail = QRectF(left - 2, top - 2, right - left + 4, bottom - top + 4);
+        trailHash = CRenderCache::hashCombine(trailHash, pX[0]);
+        trailHash = CRenderCache::hashCombine(trailHash, pY[0]);
+    }
+
+    footprint.rect = rect;
+    footprint.fingerprint = hash;
+    footprint.trailFingerprint = trailHash;
+    return footprint;
+}
+
+void CTrackRenderer::drawClusters(QPainter *pPainter)
+{
+    const QVector<stTrackCluster> &vecClusters = m_pFrame->clusters;
+    if (vecClusters.isEmpty()) {
+        return;
+    }
+
+    QFont font = pPainter->font();
+    font.setBold(true);
+    pPainter->setFont(font);
+
+    for (const stTrackCluster &cluster : vecClusters) {
+        const double radius = qMin(kClusterMaxRadiusPx, 8.0 + 3.0 * std::log2(double(cluster.count)));
+        QColor fill = CTrackSymbolAtlas::identityColor(cluster.identity);
+        QColor outline = cluster.mixed ? QColor(Qt::white) : fill.darker(150);
+        fill.setAlpha(160);
+
+        pPainter->setPen(QPen(outline, 2));
+        pPainter->setBrush(fill);
+        pPainter->drawEllipse(cluster.screenPos, radius, radius);
+
+        QRectF rect(cluster.screenPos.x() - radius, cluster.screenPos.y() - radius, 2 * radius, 2 * radius);
+        pPainter->setPen(Qt::white);
+        pPainter->drawText(rect, Qt::AlignCenter, QString::number(cluster.count));
+
+        stTrackFootprint footprint;
+        footprint.key = kClusterKeyFlag | cluster.cell;
+        footprint.rect = rect.adjusted(-2, -2, 2, 2);
+        quint64 hash = CRenderCache::hashCombine(1469598103934665603ull, cluster.screenPos.x());
+        hash = CRenderCache::hashCombine(hash, cluster.screenPos.y());
+        hash = CRenderCache::hashCombine(hash, cluster.count);
+        hash = CRenderCache::hashCombine(hash, cluster.identity);
+        footprint.fingerprint = CRenderCache::hashCombine(hash, cluster.mixed ? 1 : 0);
+        m_vecFootprints.append(footprint);
+    }
+}
+
+QImage CTrackRenderer::cachedPanel(quint64 key, const std::function<QImage()> &render)
+{
+    const QImage *pCached = m_panelCache.find(key);
+    if (pCached) {
+        return *pCached;
+    }
+    QImage image = render();
+    m_panelCache.insert(key, image, imageBytes(image));
+    return image;
+}
+
+/**
+ * @brief Draws the tooltip for the hovered track
+ * @param pPainter QPainter instance
+ * @param trackInfo Track information to display
+ * @param screenPos Position on screen where to draw tooltip
+ */
+void CTrackRenderer::drawTooltip(QPainter *pPainter, const stTrackDisplayInfo &trackInfo, const QPointF &screenPos)
+{
+    // Keyed on the text it shows, the identity line sets the colour; the mouse only moves it
+    const qreal dpr = m_pFrame->devicePixelRatio;
+    const QStringList lines = tooltipLines(trackInfo);
+    const QColor identityColor = identityDisplay(trackInfo.nTrackIden).color;
+    QImage panel = cachedPanel(panelKey(kPanelTooltip, dpr, lines), [this, &lines, &identityColor, dpr]() {
+        return renderTooltip(lines, identityColor, dpr);
+    });
+
+    const QSizeF panelSize = QSizeF(panel.size()) / dpr;
+    const double tooltipWidth = panelSize.width() - 2 * kPanelMarginPx;
+    const double tooltipHeight = panelSize.height() - 2 * kPanelMarginPx;
+
+    // Position tooltip
+    QPointF tooltipPos = screenPos + QPointF(25, -tooltipHeight / 2);
+
+    // Keep within bounds
+    if (tooltipPos.x() + tooltipWidth > m_pFrame->size.width()) {
+        tooltipPos.setX(screenPos.x() - tooltipWidth - 25);
+    }
+    if (tooltipPos.y() < 5) {
+        tooltipPos.setY(5);
+    }
+    if (tooltipPos.y() + tooltipHeight > m_pFrame->size.height()) {
+        tooltipPos.setY(m_pFrame->size.height() - tooltipHeight - 5);
+    }
+
+    QRectF tooltipRect(tooltipPos, QSizeF(tooltipWidth, tooltipHeight));
+    m_vecOverlayRects.append(tooltipRect.adjusted(-2, -2, 2, 2));
+
+    pPainter->drawImage(tooltipPos - QPointF(kPanelMarginPx, kPanelMarginPx), panel);
+}
+
+/**
+ * @brief Renders the hovered track's tooltip into a transparent image
+ * @param lines Text lines from tooltipLines()
+ * @param identityColor Colour of the track identity
+ * @param dpr Device pixel ratio of the frame
+ * @return Tooltip with kPanelMarginPx around it for the border
+ */
+QImage CTrackRenderer::renderTooltip(const QStringList &lines, const QColor &identityColor, qreal dpr) const
+{
+    // Calculate dimensions
+    QFont tooltipFont("Segoe UI", 10);
+    QFontMetrics fm(tooltipFont);
+
+    int maxWidth = 0;
+    for (const QString &line : lines) {
+        int lineWidth = fm.horizontalAdvance(line);
+        if (lineWidth > maxWidth) {
+            maxWidth = lineWidth;
+        }
+    }
+
+    int padding = 15;
+    int tooltipWidth = maxWidth + padding * 2;
+    int lineHeight = fm.height() + 3;
+    int tooltipHeight = lines.count() * lineHeight + padding * 2;
+
+    QImage image = newPanelImage(QSizeF(tooltipWidth + 2 * kPanelMarginPx, tooltipHeight + 2 * kPanelMarginPx), dpr);
+    QPainter painter(&image);
+    QPainter *pPainter = &painter;
+    pPainter->setRenderHint(QPainter::Antialiasing, true);
+    pPainter->setFont(tooltipFont);
+
+    const QPointF tooltipPos(kPanelMarginPx, kPanelMarginPx);
+    QRectF tooltipRect(tooltipPos, QSizeF(tooltipWidth, tooltipHeight));
+
+    // Simple background - no gradients for performance
+    pPainter->setPen(QPen(identityColor, 2));
+    pPainter->setBrush(QColor(30, 30, 40, 200));
+    pPainter->drawRoundedRect(tooltipRect, 8, 8);
+
+    // Accent line on left side
+    QRectF accentRect(tooltipPos.x() + 2, tooltipPos.y() + 5, 3, tooltipHeight - 10);
+    pPainter->setPen(Qt::NoPen);
+    pPainter->setBrush(identityColor);
+    pPainter->drawRoundedRect(accentRect, 2, 2);
+
+    // Draw text with subtle shadow
+    int yOffset = padding + fm.ascent();
+
+    for (int i = 0; i < lines.count(); i++) {
+        const QString &line = lines[i];
+
+        if (line.isEmpty()) {
+            yOffset += lineHeight / 2;
+            continue;
+        }
+
+        // Main text with colors (removed text shadow for performance)
+        if (i == 0) {
+            // Track ID - bright cyan
+            pPainter->setFont(QFont("Segoe UI", 11, QFont::Bold));
+            pPainter->setPen(QColor(100, 200, 255));
+        } else if (i == 1) {
+            // Identity - use identity color
+            pPainter->setFont(QFont("Segoe UI", 10, QFont::Bold));
+            pPainter->setPen(identityColor);
+        } else {
+            // Regular info - bright for visibility on transparent bg
+            pPainter->setFont(QFont("Segoe UI", 9));
+            pPainter->setPen(QColor(240, 240, 240));
+        }
+
+        pPainter->drawText(QPointF(tooltipPos.x() + padding + 10, tooltipPos.y() + yOffset), line);
+        yOffset += lineHeight;
+    }
+
+    return image;
+}
+
+/**
+ * @brief Draws the horizontal position uncertainty ellipse of a track
+ * @param pPainter QPainter instance
+ * @param trackInfo Track information with a valid covariance
+ * @param screenPos Screen position of track
+ * @param pixelPerDegree Current map scale
+ * @param trackColor Color of the track
+ */
+void CTrackRenderer::drawUncertaintyEllipse(QPainter *pPainter, const stTrackDisplayInfo &trackInfo,
+                                         const QPointF &screenPos, double pixelPerDegree, const QColor &trackColor)
+{
+    double rx = trackInfo.ellipseMajor * pixelPerDegree * m_pFrame->ellipseSigma;
+    double ry = trackInfo.ellipseMinor * pixelPerDegree * m_pFrame->ellipseSigma;
+    if (rx < 1.0) return; // Smaller than the track symbol, nothing to show
+
+    QColor fillColor = trackColor;
+    fillColor.setAlpha(40);
+
+    pPainter->save();
+    pPainter->translate(screenPos);
+    pPainter->rotate(-trackInfo.ellipseAngle); // Screen Y points down, so CCW from East is negative
+    pPainter->setPen(QPen(trackColor, 1, Qt::DashLine));
+    pPainter->setBrush(fillColor);
+    pPainter->drawEllipse(QPointF(0, 0), rx, ry);
+    pPainter->restore();
+}
+
+/**
+ * @brief Draws speed vector for a track
+ * @param pPainter QPainter instance
+ * @param trackInfo Track information
+ * @param screenPos Screen position of track
+ * @param trackColor Color of the track
+ */
+void CTrackRenderer::drawSpeedVector(QPainter *pPainter, const stTrackDisplayInfo &trackInfo, 
+                                 const QPointF &screenPos, const QColor &trackColor)
+{
+    if (trackInfo.velocity <= 0) return; // No vector for stationary targets
+    
+    // Calculate speed vector length (proportional to speed)
+    // Scale factor: 1 m/s = 2 pixels, max length = 50 pixels
+    double speedScale = 2.0;
+    double maxVectorLength = 50.0;
+    double vectorLength = qMin(trackInfo.velocity * speedScale, maxVectorLength);
+    
+    // Calculate speed vector direction (same as heading)
+    double speedHeadingRad = qDegreesToRadians(trackInfo.heading);
+    QPointF vectorEnd(
+        screenPos.x() + std::cos(speedHeadingRad) * vectorLength,
+        screenPos.y() - std::sin(speedHeadingRad) * vectorLength
+    );
+    
+    // Draw speed vector line
+    QColor vectorColor = trackColor;
+    vectorColor.setAlpha(200);
+    pPainter->setPen(QPen(vectorColor, 2, Qt::SolidLine));
+    pPainter->drawLine(screenPos, vectorEnd);
+    
+    // Draw arrowhead at the end
+    double arrowSize = 6.0;
+    double arrowAngle = M_PI / 6; // 30 degrees
+    
+    QPointF arrowP1(
+        vectorEnd.x() - arrowSize * std::cos(speedHeadingRad - arrowAngle),
+        vectorEnd.y() + arrowSize * std::sin(speedHeadingRad - arrowAngle)
+    );
+    QPointF arrowP2(
+        vectorEnd.x() - arrowSize * std::cos(speedHeadingRad + arrowAngle),
+        vectorEnd.y() + arrowSize * std::sin(speedHeadingRad + arrowAngle)
+    );
+    
+    pPainter->setPen(QPen(vectorColor, 2, Qt::SolidLine));
+    pPainter->drawLine(vectorEnd, arrowP1);
+    pPainter->drawLine(vectorEnd, arrowP2);
+    
+    // Optional: Draw speed text near the vector
+    if (vectorLength > 20) { // Only show text if vector is long enough
+        pPainter->setFont(QFont("Arial", 8));
+        pPainter->setPen(Qt::white);
+        QString speedText = QString("%1 m/s").arg(trackInfo.velocity, 0, 'f', 1);
+        QPointF textPos = screenPos + QPointF(vectorLength * 0.6 * std::cos(speedHeadingRad), 
+                                             -vectorLength * 0.6 * std::sin(speedHeadingRad));
+        pPainter->drawText(textPos, speedText);
+    }
+}
+
+/**
+ * @brief Draws focused track datatip that follows the track
+ * @param pPainter QPainter instance
+ * @param trackInfo Track information
+ * @param screenPos Screen position of track
+ */
+void CTrackRenderer::drawFocusedTrackDatatip(QPainter *pPainter, const stTrackDisplayInfo &trackInfo, 
+                                         const QPointF &screenPos)
+{
+    // Use a modified version of the tooltip for focused tracks
+    // This will always be visible and follow the track
+    const qreal dpr = m_pFrame->devicePixelRatio;
+    const QStringList lines = datatipLines(trackInfo);
+    const QColor identityColor = identityDisplay(trackInfo.nTrackIden).color;
+    QImage panel = cachedPanel(panelKey(kPanelDatatip, dpr, lines), [this, &lines, &identityColor, dpr]() {
+        return renderDatatip(lines, identityColor, dpr);
+    });
+
+    const QSizeF panelSize = QSizeF(panel.size()) / dpr;
+    const double tooltipWidth = panelSize.width() - 2 * kPanelMarginPx;
+    const double tooltipHeight = panelSize.height() - 2 * kPanelMarginPx;
+
+    // Position tooltip above and to the right of track
+    QPointF tooltipPos = screenPos + QPointF(15, -tooltipHeight - 15);
+
+    // Keep within bounds
+    if (tooltipPos.x() + tooltipWidth > m_pFrame->size.width()) {
+        tooltipPos.setX(screenPos.x() - tooltipWidth - 15);
+    }
+    if (tooltipPos.y() < 5) {
+        tooltipPos.setY(screenPos.y() + 15);
+    }
+
+    QRectF tooltipRect(tooltipPos, QSizeF(tooltipWidth, tooltipHeight));
+    m_vecOverlayRects.append(tooltipRect.adjusted(-2, -2, 2, 2));
+
+    pPainter->drawImage(tooltipPos - QPointF(kPanelMarginPx, kPanelMarginPx), panel);
+}
+
+/**
+ * @brief Renders the focused track's datatip into a transparent image
+ * @param lines Text lines from datatipLines()
+ * @param identityColor Colour of the track identity
+ * @param dpr Device pixel ratio of the frame
+ * @return Datatip with kPanelMarginPx around it for the border
+ */
+QImage CTrackRenderer::renderDatatip(const QStringList &lines, const QColor &identityColor, qreal dpr) const
+{
+    // Calculate dimensions
+    QFont tooltipFont("Segoe UI", 9, QFont::Bold);
+    QFontMetrics fm(tooltipFont);
+
+    int maxWidth = 0;
+    for (const QString &line : lines) {
+        int lineWidth = fm.horizontalAdvance(line);
+        if (lineWidth > maxWidth) {
+            maxWidth = lineWidth;
+        }
+    }
+
+    int padding = 10;
+    int tooltipWidth = maxWidth + padding * 2;
+    int lineHeight = fm.height() + 2;
+    int tooltipHeight = lines.count() * lineHeight + padding * 2;
+
+    QImage image = newPanelImage(QSizeF(tooltipWidth + 2 * kPanelMarginPx, tooltipHeight + 2 * kPanelMarginPx), dpr);
+    QPainter painter(&image);
+    QPainter *pPainter = &painter;
+    pPainter->setRenderHint(QPainter::Antialiasing, true);
+    pPainter->setFont(tooltipFont);
+
+    const QPointF tooltipPos(kPanelMarginPx, kPanelMarginPx);
+    QRectF tooltipRect(tooltipPos, QSizeF(tooltipWidth, tooltipHeight));
+
+    // Draw focused tooltip with stronger background
+    QLinearGradient bgGradient(tooltipRect.topLeft(), tooltipRect.bottomLeft());
+    bgGradient.setColorAt(0, QColor(30, 30, 40, 200));
+    bgGradient.setColorAt(1, QColor(20, 20, 30, 220));
+
+    pPainter->setBrush(bgGradient);
+    pPainter->setPen(QPen(identityColor, 2));
+    pPainter->drawRoundedRect(tooltipRect, 8, 8);
+
+    // Draw text
+    int yOffset = padding + fm.ascent();
+    for (int i = 0; i < lines.count(); i++) {
+        const QString &line = lines[i];
+
+        if (i == 0) {
+            // Focused header - bright cyan
+            pPainter->setPen(QColor(100, 200, 255));
+        } else if (i == 1) {
+            // Identity - use identity color
+            pPainter->setPen(identityColor);
+        } else {
+            // Regular info - bright white
+            pPainter->setPen(QColor(255, 255, 255));
+        }
+
+        pPainter->drawText(QPointF(tooltipPos.x() + padding, tooltipPos.y() + yOffset), line);
+        yOffset += lineHeight;
+    }
+
+    return image;
+}
+
+/**
+ * @brief Draws drone internal details panel next to track
+ * @param pPainter QPainter instance
+ * @param trackInfo Track information of the focused drone
+ * @param screenPos Screen position of track
+ */
+void CTrackRenderer::drawDroneInternalDetails(QPainter *pPainter, const stTrackDisplayInfo &trackInfo, 
+                                          const QPointF &screenPos)
+{
+    // Copied from the drone on the GUI thread when the frame was taken
+    const stDroneInternalState &droneState = m_pFrame->focusedDroneState;
+
+    // Keyed on the text it shows and the health colour, so telemetry that formats the same
+    // is a blit; the battery bar follows the shown level, not the raw one
+    const qreal dpr = m_pFrame->devicePixelRatio;
+    const QStringList lines = dronePanelLines(trackInfo, *m_pFrame);
+    const double batteryShown = std::round(droneState.batteryLevel * 10.0) / 10.0;
+    quint64 key = panelKey(kPanelDrone, dpr, lines);
+    key = CRenderCache::hashCombine(key, m_pFrame->focusedDroneHealth.rgba());
+    QImage panel = cachedPanel(key, [this, &lines, batteryShown, dpr]() {
+        return renderDronePanel(lines, m_pFrame->focusedDroneHealth, batteryShown, dpr);
+    });
+
+    const QSizeF panelSize = QSizeF(panel.size()) / dpr;
+    const double panelWidth = panelSize.width() - 2 * kPanelMarginPx;
+    const double panelHeight = panelSize.height() - 2 * kPanelMarginPx;
+
+    // Position panel to the right of track
+    QPointF panelPos = screenPos + QPointF(40, -panelHeight / 2);
+    
+    // Keep within bounds
+    if (panelPos.x() + panelWidth > m_pFrame->size.width() - 10) {
+        panelPos.setX(screenPos.x() - panelWidth - 40);
+    }
+    if (panelPos.y() < 10) {
+        panelPos.setY(10);
+    }
+    if (panelPos.y() + panelHeight > m_pFrame->size.height() - 10) {
+        panelPos.setY(m_pFrame->size.height() - panelHeight - 10);
+    }
+    
+    QRectF panelRect(panelPos, QSizeF(panelWidth, panelHeight));
+    pPainter->drawImage(panelPos - QPointF(kPanelMarginPx, kPanelMarginPx), panel);
+
+    // Only the connector moves with the track
+    QColor healthColor = m_pFrame->focusedDroneHealth;
+
+    // Draw connection line from panel to track
+    QPainterPath connectorPath;
+    if (panelPos.x() > screenPos.x()) {
+        // Panel on right
+        connectorPath.moveTo(panelPos.x(), panelPos.y() + panelHeight / 2);
+        connectorPath.lineTo(screenPos.x() + 15, screenPos.y());
+    } else {
+        // Panel on left
+        connectorPath.moveTo(panelPos.x() + panelWidth, panelPos.y() + panelHeight / 2);
+        connectorPath.lineTo(screenPos.x() - 15, screenPos.y());
+    }
+    
+    pPainter->setPen(QPen(healthColor, 2, Qt::DotLine));
+    pPainter->setBrush(Qt::NoBrush);
+    pPainter->drawPath(connectorPath);
+
+    // Shadow and connector included
+    QRectF drawnRect = panelRect.adjusted(-3, -3, 3, 3).united(connectorPath.boundingRect());
+    m_vecOverlayRects.append(drawnRect.adjusted(-2, -2, 2, 2));
+}
+
+/**
+ * @brief Renders the drone internal details panel into a transparent image
+ * @param lines Text lines from dronePanelLines()
+ * @param healthColor Colour of the drone's health
+ * @param batteryLevel Battery level as the panel shows it, in percent
+ * @param dpr Device pixel ratio of the frame
+ * @return Panel with kPanelMarginPx around it for the shadow and border
+ */
+QImage CTrackRenderer::renderDronePanel(const QStringList &lines, const QColor &healthColor,
+                                        double batteryLevel, qreal dpr) const
+{
+    // Calculate dimensions
+    QFont detailFont("Consolas", 8);
+    QFontMetrics fm(detailFont);
+    
+    int maxWidth = 0;
+    for (const QString &line : lines) {
+        int lineWidth = fm.horizontalAdvance(line);
+        if (lineWidth > maxWidth) {
+            maxWidth = lineWidth;
+        }
+    }
+    
+    int padding = 12;
+    int panelWidth = maxWidth + padding * 2;
+    int lineHeight = fm.height() + 1;
+    int panelHeight = lines.count() * lineHeight + padding * 2;
+    
+    QImage image = newPanelImage(QSizeF(panelWidth + 2 * kPanelMarginPx, panelHeight + 2 * kPanelMarginPx), dpr);
+    QPainter painter(&image);
+    QPainter *pPainter = &painter;
+    pPainter->setRenderHint(QPainter::Antialiasing, true);
+    pPainter->setFont(detailFont);
+
+    const QPointF panelPos(kPanelMarginPx, kPanelMarginPx);
+    QRectF panelRect(panelPos, QSizeF(panelWidth, panelHeight));
+    
+    // Draw panel shadow
+    pPainter->setPen(Qt::NoPen);
+    pPainter->setBrush(QColor(0, 0, 0, 60));
+    pPainter->drawRoundedRect(panelRect.adjusted(-3, -3, 3, 3), 12, 12);
+    
+    // Main background - dark semi-transparent
+    QLinearGradient bgGradient(panelRect.topLeft(), panelRect.bottomLeft());
+    bgGradient.setColorAt(0, QColor(20, 25, 35, 240));
+    bgGradient.setColorAt(1, QColor(15, 20, 30, 250));
+    
+    pPainter->setBrush(bgGradient);
+    pPainter->setPen(QPen(healthColor, 2));
+    pPainter->drawRoundedRect(panelRect, 10, 10);
+    
+    // Health status indicator bar on left
+    QRectF healthBar(panelPos.x() + 5, panelPos.y() + 5, 4, panelHeight - 10);
+    pPainter->setPen(Qt::NoPen);
+    pPainter->setBrush(healthColor);
+    pPainter->drawRoundedRect(healthBar, 2, 2);
+    
+    // Battery level indicator (visual bar)
+    if (batteryLevel > 0) {
+        QRectF batteryBg(panelPos.x() + padding, panelPos.y() + panelHeight - padding - 8, 
+                         panelWidth - padding * 2, 6);
+        pPainter->setPen(Qt::NoPen);
+        pPainter->setBrush(QColor(60, 60, 70));
+        pPainter->drawRoundedRect(batteryBg, 3, 3);
+        
+        // Battery fill color based on level
+        QColor batteryColor;
+        if (batteryLevel > 50) {
+            batteryColor = QColor(46, 204, 113); // Green
+        } else if (batteryLevel > 25) {
+            batteryColor = QColor(241, 196, 15); // Yellow
+        } else {
+            batteryColor = QColor(231, 76, 60); // Red
+        }
+        
+        QRectF batteryFill(batteryBg.x(), batteryBg.y(), 
+                          batteryBg.width() * (batteryLevel / 100.0), batteryBg.height());
+        pPainter->setBrush(batteryColor);
+        pPainter->drawRoundedRect(batteryFill, 3, 3);
+    }
+    
+    // Draw text lines
+    int yOffset = padding + fm.ascent();
+    
+    for (int i = 0; i < lines.count(); i++) {
+        const QString &line = lines[i];
+        
+        if (line.isEmpty() || line.startsWith("━")) {
+            yOffset += lineHeight / 2;
+            
+            // Draw separator line
+            if (line.startsWith("━")) {
+                pPainter->setPen(QPen(QColor(100, 100, 120, 100), 1));
+                pPainter->drawLine(panelPos.x() + padding + 15, panelPos.y() + yOffset - fm.ascent()/2,
+                                  panelPos.x() + panelWidth - padding - 15, panelPos.y() + yOffset - fm.ascent()/2);
+            }
+            continue;
+        }
+        
+        // Color coding for different line types
+        if (line.startsWith("🚁")) {
+            // Title - bright cyan
+            pPainter->setFont(QFont("Consolas", 9, QFont::Bold));
+            pPainter->setPen(QColor(100, 200, 255));
+        } else if (line.startsWith("MODE:") || line.startsWith("STATUS:")) {
+            // Status lines
+            pPainter->setFont(QFont("Consolas", 8, QFont::Bold));
+            if (line.contains("EMERGENCY") || line.contains("CRITICAL")) {
+                pPainter->setPen(QColor(231, 76, 60)); // Red
+            } else if (line.contains("WARNING") || line.contains("RTB")) {
+                pPainter->setPen(QColor(241, 196, 15)); // Yellow
+            } else {
+                pPainter->setPen(healthColor);
+            }
+        } else if (line.startsWith("⚡") || line.startsWith("🎯") || 
+                   line.startsWith("🎚️") || line.startsWith("📡") || line.startsWith("📍")) {
+            // Section headers
+            pPainter->setFont(QFont("Consolas", 8, QFont::Bold));
+            pPainter->setPen(QColor(150, 180, 255));
+        } else if (line.startsWith("  ")) {
+            // Data lines (indented)
+            pPainter->setFont(QFont("Consolas", 8));
+            pPainter->setPen(QColor(220, 220, 230));
+        } else {
+            // Default
+            pPainter->setFont(detailFont);
+            pPainter->setPen(QColor(200, 200, 210));
+        }
+        
+        pPainter->drawText(QPointF(panelPos.x() + padding + 15, panelPos.y() + yOffset), line);
+        yOffset += lineHeight;
+    }
+
+    return image;
+}
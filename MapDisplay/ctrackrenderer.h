@@ -0,0 +1,242 @@
+#ifndef CTRACKRENDERER_H
+#define CTRACKRENDERER_H
+
+#include <QPainter>
+#include <QImage>
+#include <QList>
+#include <QSet>
+#include <QSize>
+#include <QVector>
+#include <functional>
+#include "ctracksymbolatlas.h"
+#include "clrucache.h"
+#include "ctracklabelengine.h"
+#include "ctrackclusterer.h"
+#include "../cdrone.h"
+#include "../globalstructs.h"
+
+/**
+ * @brief Everything one frame of the track overlay is drawn from
+ *
+ * Taken by CTrackLayer on the GUI thread. The containers are implicitly shared, so
+ * taking the frame copies no track data until the layer's next projection writes
+ * its own arrays. stTrackDisplayInfo::pDrone is not dereferenced by the renderer;
+ * the focused drone's state is copied into the frame instead.
+ */
+struct stTrackFrame {
+    QSize size;                             //!< Canvas size in device independent pixels
+    qreal devicePixelRatio;
+    double pixelPerDegree;                  //!< Map scale
+    int ellipseSigma;                       //!< Uncertainty ellipse scale, 0 when disabled
+    int animFrame;                          //!< Blip animation phase, 0-19
+
+    QList<stTrackDisplayInfo> tracks;
+    QVector<double> trackScreenX;           //!< Screen X of tracks[i]
+    QVector<double> trackScreenY;           //!< Screen Y of tracks[i]
+    QVector<int> visibleTracks;             //!< Culled track indices, paint order
+    QVector<int> historyStart;              //!< History of track i is [start[i], start[i+1])
+    QVector<double> historyScreenX;
+    QVector<double> historyScreenY;
+    QRectF rectCull;                        //!< View rectangle plus the culling margin
+    QVector<stTrackCluster> clusters;       //!< Glyphs standing in for the clustered tracks
+    bool clustering;                        //!< Level of detail on, overview tracks drawn as dots
+
+    QSet<int> highlightedTracks;
+    int focusedTrackId;                     //!< -1 if none
+    int hoveredTrackId;                     //!< -1 if none
+    QPointF mousePos;                       //!< Tooltip anchor
+
+    bool hasFocusedDrone;                   //!< The focused track is a drone, fields below are valid
+    stDroneInternalState focusedDroneState;
+    QColor focusedDroneHealth;
+    QString focusedDroneMode;
+
+    bool invalidateImages;                  //!< A custom track image was replaced since the last frame
+    bool fullRepaint;                       //!< Invalidate the whole canvas when this frame is shown
+
+    stTrackFrame()
+        : devicePixelRatio(1.0), pixelPerDegree(0.0), ellipseSigma(0), animFrame(0),
+          clustering(false), focusedTrackId(-1), hoveredTrackId(-1), hasFocusedDrone(false),
+          invalidateImages(false), fullRepaint(false)
+    {
+    }
+};
+
+/**
+ * @brief Screen area one track or cluster glyph covered in a rendered frame
+ *
+ * Two frames' footprints with the same key differ in rect or fingerprint when the
+ * item has to be repainted; the track layer invalidates the old and new areas. The
+ * trail is dashed from its first point, so a new first point or point count moves the
+ * dashes along all of it: trailFingerprint then differs and the whole trail is redrawn.
+ */
+struct stTrackFootprint {
+    quint64 key;                //!< Track ID, or kClusterKeyFlag | cell key for a cluster glyph
+    QRectF rect;                //!< Symbol, rings, blip, speed vector, label, ellipse and trail tail
+    QRectF rectTrail;           //!< Whole trail
+    quint64 fingerprint;        //!< Hash of everything drawn for the track
+    quint64 trailFingerprint;   //!< Hash of the trail's first point and point count
+
+    stTrackFootprint() : key(0), fingerprint(0), trailFingerprint(0) {}
+};
+
+/**
+ * @brief Footprint key flag of cluster glyphs, track IDs never reach it
+ */
+const quint64 kClusterKeyFlag = quint64(1) << 63;
+
+/**
+ * @brief CTrackRenderer - Draws the track overlay from a stTrackFrame
+ *
+ * Holds the symbol atlas and the custom image caches, and touches nothing outside the
+ * frame it is given, so renderImage() can run on a worker thread while the GUI thread
+ * keeps projecting, hit testing and handling input. Only QImage and QPainter are used
+ * on that path. One render at a time per instance.
+ */
+class CTrackRenderer
+{
+public:
+    CTrackRenderer();
+
+    /**
+     * @brief Prerenders the symbol atlas, call once on the GUI thread before the first render
+     */
+    void build();
+
+    /**
+     * @brief Draws a frame with an existing painter, in item coordinates
+     */
+    void render(const stTrackFrame &frame, QPainter *pPainter);
+
+    /**
+     * @brief Draws a frame into a transparent ARGB32_Premultiplied image of the frame's size
+     * @param pImage Reallocated only when the size or pixel ratio changed
+     */
+    void renderImage(const stTrackFrame &frame, QImage *pImage);
+
+    /**
+     * @brief Duration of the last render() or renderImage() in milliseconds
+     */
+    double lastRenderMs() const { return m_dLastRenderMs; }
+
+    /**
+     * @brief Footprints of the tracks drawn by the last render, valid until the next one
+     */
+    const QVector<stTrackFootprint> &footprints() const { return m_vecFootprints; }
+
+    /**
+     * @brief Tooltip, datatip and drone panel areas of the last render
+     *
+     * Their content changes with the drone state and the mouse, so they are always repainted.
+     */
+    const QVector<QRectF> &overlayRects() const { return m_vecOverlayRects; }
+
+    /**
+     * @brief Label placement of the last render: placed and dropped counts, layout time
+     */
+    const CTrackLabelEngine &labelEngine() const { return m_labelEngine; }
+
+    /**
+     * @brief Custom image, rotated image and panel caches, for their hit counters
+     *
+     * Only read them while no render is running.
+     */
+    const CLruCache<QImage> &trackImageCache() const { return m_trackImages; }
+    const CLruCache<QImage> &rotatedImageCache() const { return m_rotatedImageCache; }
+    const CLruCache<QImage> &panelCache() const { return m_panelCache; }
+
+private:
+    CTrackSymbolAtlas m_symbolAtlas;        //!< Default symbols, drawn in one batch per frame
+    CLruCache<QImage> m_trackImages;        //!< Loaded custom images by track ID
+    CLruCache<QImage> m_rotatedImageCache;  //!< Rotated custom images, key makeKey(trackId, size, heading)
+    CLruCache<QImage> m_panelCache;         //!< Tooltip, datatip and drone panels, key hash of the shown values
+    CTrackLabelEngine m_labelEngine;        //!< Track numbers, placed after the symbol batch
+    QVector<int> m_vecLabelFootprints;      //!< Footprint index of each label candidate
+    QVector<QPointF> m_vecTrailPoints;      //!< Visible run of the trail being drawn
+    QVector<stTrackFootprint> m_vecFootprints;
+    QVector<QRectF> m_vecOverlayRects;
+    const stTrackFrame *m_pFrame;           //!< Frame being drawn, only valid inside render()
+    double m_dLastRenderMs;
+
+    /**
+     * @brief Conservative test of a screen segment against the culling rectangle
+     */
+    bool segmentInView(const QPointF &a, const QPointF &b) const
+    {
+        const QRectF &rectCull = m_pFrame->rectCull;
+        return qMax(a.x(), b.x()) >= rectCull.left() && qMin(a.x(), b.x()) <= rectCull.right() &&
+               qMax(a.y(), b.y()) >= rectCull.top() && qMin(a.y(), b.y()) <= rectCull.bottom();
+    }
+
+    /**
+     * @brief Conservative screen area and content hash of one track as render() draws it
+     * @param nTrack Index into the frame's tracks
+     * @param stateBits Hover, highlight and focus flags of the track
+     */
+    stTrackFootprint trackFootprint(int nTrack, int stateBits) const;
+
+    /**
+     * @brief Draws the cluster glyphs of the frame and records their footprints
+     * @param pPainter QPainter instance
+     */
+    void drawClusters(QPainter *pPainter);
+
+    /**
+     * @brief Panel image for a key, rendered and cached on a miss
+     * @param key Hash of the panel kind, device pixel ratio and the text lines the panel draws
+     * @param render Renders the panel when it is not cached
+     */
+    QImage cachedPanel(quint64 key, const std::function<QImage()> &render);
+
+    /**
+     * @brief Draws tooltip with track information
+     * @param pPainter QPainter instance
+     * @param trackInfo Track information to display
+     * @param screenPos Screen position for tooltip
+     */
+    void drawTooltip(QPainter *pPainter, const stTrackDisplayInfo &trackInfo, const QPointF &screenPos);
+    QImage renderTooltip(const QStringList &lines, const QColor &identityColor, qreal dpr) const;
+
+    /**
+     * @brief Draws speed vector for a track
+     * @param pPainter QPainter instance
+     * @param trackInfo Track information
+     * @param screenPos Screen position of track
+     * @param trackColor Color of the track
+     */
+    void drawSpeedVector(QPainter *pPainter, const stTrackDisplayInfo &trackInfo,
+                         const QPointF &screenPos, const QColor &trackColor);
+
+    /**
+     * @brief Draws the horizontal position uncertainty ellipse of a track
+     * @param pPainter QPainter instance
+     * @param trackInfo Track information with a valid covariance
+     * @param screenPos Screen position of track
+     * @param pixelPerDegree Current map scale
+     * @param trackColor Color of the track
+     */
+    void drawUncertaintyEllipse(QPainter *pPainter, const stTrackDisplayInfo &trackInfo,
+                                const QPointF &screenPos, double pixelPerDegree, const QColor &trackColor);
+
+    /**
+     * @brief Draws focused track datatip that follows the track
+     * @param pPainter QPainter instance
+     * @param trackInfo Track information
+     * @param screenPos Screen position of track
+     */
+    void drawFocusedTrackDatatip(QPainter *pPainter, const stTrackDisplayInfo &trackInfo,
+                                 const QPointF &screenPos);
+    QImage renderDatatip(const QStringList &lines, const QColor &identityColor, qreal dpr) const;
+
+    /**
+     * @brief Draws drone internal details panel from the frame's copy of the drone state
+     * @param pPainter QPainter instance
+     * @param trackInfo Track information of the focused drone
+     * @param screenPos Screen position of track
+     */
+    void drawDroneInternalDetails(QPainter *pPainter, const stTrackDisplayInfo &trackInfo,
+                                  const QPointF &screenPos);
+    QImage renderDronePanel(const QStringList &lines, const QColor &healthColor, double batteryLevel, qreal dpr) const;
+};
+
+#endif // CTRACKRENDERER_H
@@ -0,0 +1,210 @@
+#include "ctracksymbolatlas.h"
+#include "../globalstructs.h"
+#include <QElapsedTimer>
+#include <QImage>
+#include <QCoreApplication>
+#include <QThread>
+#include <QPainterPath>
+#include <QDebug>
+#include <QtMath>
+
+namespace {
+
+// Cells per row of one (identity, state) block, 4 rows of 18 headings
+const int kBlockColumns = 18;
+const int kBlockRows = CTrackSymbolAtlas::kHeadingCount / kBlockColumns;
+
+// Cell edge: the rotated symbol's diagonal plus a pixel of padding on each side
+inline int cellSize(int state)
+{
+    return int(std::ceil(CTrackSymbolAtlas::symbolSize(state) * M_SQRT2)) + 2;
+}
+
+} // namespace
+
+CTrackSymbolAtlas::CTrackSymbolAtlas()
+    : m_dBuildMs(0.0)
+{
+}
+
+int CTrackSymbolAtlas::identityIndex(int nTrackIden)
+{
+    switch (nTrackIden) {
+    case TRACK_IDENTITY_UNKNOWN:
+        return 0;
+    case TRACK_IDENTITY_FRIEND:
+        return 1;
+    case TRACK_IDENTITY_HOSTILE:
+        return 2;
+    default:
+        return 3;
+    }
+}
+
+QColor CTrackSymbolAtlas::identityColor(int identity)
+{
+    switch (identity) {
+    case 0:
+        return Qt::yellow;
+    case 1:
+        return Qt::green;
+    case 2:
+        return Qt::red;
+    default:
+        return Qt::cyan;
+    }
+}
+
+int CTrackSymbolAtlas::symbolSize(int state)
+{
+    switch (state) {
+    case SYMBOL_FOCUSED:
+        return 28;
+    case SYMBOL_HIGHLIGHTED:
+        return 22;
+    default:
+        return 16;
+    }
+}
+
+double CTrackSymbolAtlas::build()
+{
+    QElapsedTimer timer;
+    timer.start();
+
+    const int maxCell = cellSize(SYMBOL_FOCUSED);
+    int height = 0;
+    for (int state = 0; state < kStateCount; ++state) {
+        height += kBlockRows * cellSize(state);
+    }
+    height *= kIdentityCount;
+
+    QImage image(kBlockColumns * maxCell, height, QImage::Format_ARGB32_Premultiplied);
+    image.fill(Qt::transparent);
+    m_vecSourceRects.resize(kIdentityCount * kStateCount * kHeadingCount);
+
+    QPainter painter(&image);
+    painter.setRenderHint(QPainter::Antialiasing, true);
+    painter.setRenderHint(QPainter::SmoothPixmapTransform, true);
+
+    int blockTop = 0;
+    for (int identity = 0; identity < kIdentityCount; ++identity) {
+        for (int state = 0; state < kStateCount; ++state) {
+            const int size = symbolSize(state);
+            const int cell = cellSize(state);
+            QPixmap symbol = renderSymbol(size, identityColor(identity), Qt::white);
+
+            for (int heading = 0; heading < kHeadingCount; ++heading) {
+                int cellX = (heading % kBlockColumns) * cell;
+                int cellY = blockTop + (heading / kBlockColumns) * cell;
+
+                // Same sense as the per-track rotation it replaces
+                painter.save();
+                painter.translate(cellX + cell / 2.0, cellY + cell / 2.0);
+                painter.rotate(-heading * (360.0 / kHeadingCount));
+                painter.drawPixmap(QPointF(-size / 2.0, -size / 2.0), symbol);
+                painter.restore();
+
+                m_vecSourceRects[(identity * kStateCount + state) * kHeadingCount + heading] =
+                    QRectF(cellX, cellY, cell, cell);
+            }
+            blockTop += kBlockRows * cell;
+        }
+    }
+    painter.end();
+
+    m_atlas = QPixmap::fromImage(image);
+    m_atlasImage = image;
+    m_dBuildMs = timer.nsecsElapsed() / 1.0e6;
+
+    qDebug() << "[CTrackSymbolAtlas] built" << m_vecSourceRects.size() << "symbols,"
+             << m_atlas.width() << "x" << m_atlas.height() << "px,"
+             << memoryBytes() / 1024 << "KB in" << m_dBuildMs << "ms";
+    return m_dBuildMs;
+}
+
+void CTrackSymbolAtlas::addSymbol(const QPointF &center, int identity, int state, double heading)
+{
+    int nHeading = qRound(heading * (kHeadingCount / 360.0)) % kHeadingCount;
+    if (nHeading < 0) nHeading += kHeadingCount;
+
+    const QRectF &source = m_vecSourceRects[(identity * kStateCount + state) * kHeadingCount + nHeading];
+    m_vecFragments.append(QPainter::PixmapFragment::create(center, source));
+}
+
+void CTrackSymbolAtlas::drawPending(QPainter *pPainter)
+{
+    if (m_vecFragments.isEmpty()) {
+        return;
+    }
+
+    if (QThread::currentThread() == QCoreApplication::instance()->thread()) {
+        pPainter->drawPixmapFragments(m_vecFragments.constData(), m_vecFragments.size(), m_atlas);
+    } else {
+        // Pixmaps belong to the GUI thread; the raster engine splits the fragment
+        // call into these same per-fragment blits anyway
+        for (const QPainter::PixmapFragment &fragment : m_vecFragments) {
+            QRectF target(fragment.x - fragment.width / 2.0, fragment.y - fragment.height / 2.0,
+                          fragment.width, fragment.height);
+            QRectF source(fragment.sourceLeft, fragment.sourceTop, fragment.width, fragment.height);
+            pPainter->drawImage(target, m_atlasImage, source);
+        }
+    }
+    m_vecFragments.resize(0);
+}
+
+QPixmap CTrackSymbolAtlas::renderSymbol(int size, const QColor &color, const QColor &accent)
+{
+    // Create a triangular arrow-like shape to represent a drone nose-forward
+    QPixmap pix(size, size);
+    pix.fill(Qt::transparent);
+
+    QPainter painter(&pix);
+    painter.setRenderHint(QPainter::Antialiasing, true);
+
+    QPointF center(size / 2.0, size / 2.0);
+    double bodyRadius = size * 0.35;
+
+    // Body circle
+    painter.setPen(Qt::NoPen);
+    QColor bodyColor = color;
+    bodyColor.setAlpha(230);
+    painter.setBrush(bodyColor);
+    painter.drawEllipse(center, bodyRadius, bodyRadius);
+
+    // Nose triangle pointing up (will be rotated later)
+    QPainterPath nose;
+    double tipY = size * 0.08;
+    double baseY = size * 0.45;
+    double halfWidth = size * 0.18;
+    nose.moveTo(center.x(), tipY);
+    nose.lineTo(center.x() - halfWidth, baseY);
+    nose.lineTo(center.x() + halfWidth, baseY);
+    nose.closeSubpath();
+    QColor noseColor = accent;
+    noseColor.setAlpha(240);
+    painter.setBrush(noseColor);
+    painter.drawPath(nose);
+
+    // Tail fin
+    QPainterPath tail;
+    double tailTop = size * 0.55;
+    double tailBottom = size * 0.9;
+    double tailHalfWidth = size * 0.12;
+    tail.moveTo(center.x(), tailTop);
+    tail.lineTo(center.x() - tailHalfWidth, tailBottom);
+    tail.lineTo(center.x() + tailHalfWidth, tailBottom);
+    tail.closeSubpath();
+    QColor tailColor = color.darker(130);
+    tailColor.setAlpha(220);
+    painter.setBrush(tailColor);
+    painter.drawPath(tail);
+
+    // Outline
+    painter.setBrush(Qt::NoBrush);
+    painter.setPen(QPen(QColor(255,255,255,180), 1));
+    painter.drawEllipse(center, bodyRadius, bodyRadius);
+
+    painter.end();
+    return pix;
+}
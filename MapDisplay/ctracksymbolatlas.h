@@ -0,0 +1,91 @@
+#ifndef CTRACKSYMBOLATLAS_H
+#define CTRACKSYMBOLATLAS_H
+
+#include <QPainter>
+#include <QPixmap>
+#include <QImage>
+#include <QVector>
+#include <QRectF>
+
+/**
+ * @brief CTrackSymbolAtlas - Every default track symbol prerendered into one pixmap
+ *
+ * The atlas holds the drone marker for each identity colour, each display state
+ * (normal, highlighted, focused) and 72 headings in 5 degree steps. Painting a track
+ * is a rectangle lookup; the frame's symbols are queued with addSymbol() and drawn
+ * by drawPending() in one QPainter::drawPixmapFragments() call. Off the GUI thread the
+ * same symbols are blitted from a QImage copy of the atlas.
+ */
+class CTrackSymbolAtlas
+{
+public:
+    enum eSymbolState {
+        SYMBOL_NORMAL = 0,
+        SYMBOL_HIGHLIGHTED = 1,
+        SYMBOL_FOCUSED = 2
+    };
+
+    static const int kIdentityCount = 4;    //!< Unknown, friend, hostile, other
+    static const int kStateCount = 3;
+    static const int kHeadingCount = 72;    //!< 5 degree steps
+
+    CTrackSymbolAtlas();
+
+    /**
+     * @brief Renders every symbol into the atlas
+     * @return Build time in milliseconds
+     */
+    double build();
+
+    bool isBuilt() const { return !m_atlas.isNull(); }
+    double buildMs() const { return m_dBuildMs; }
+    qint64 memoryBytes() const { return qint64(m_atlas.width()) * m_atlas.height() * 4; }
+    const QPixmap &pixmap() const { return m_atlas; }
+
+    /**
+     * @brief Atlas identity slot of a track identity (TRACK_IDENTITY_*)
+     */
+    static int identityIndex(int nTrackIden);
+
+    static QColor identityColor(int identity);
+
+    /**
+     * @brief Symbol edge length in pixels for a display state
+     */
+    static int symbolSize(int state);
+
+    /**
+     * @brief Renders one unrotated drone marker, nose up
+     * @param size Edge length in pixels
+     * @param color Body colour
+     * @param accent Nose colour
+     */
+    static QPixmap renderSymbol(int size, const QColor &color, const QColor &accent);
+
+    /**
+     * @brief Queues a symbol centred on a screen point for the next drawPending()
+     * @param center Screen position
+     * @param identity Slot from identityIndex()
+     * @param state eSymbolState
+     * @param heading Heading in degrees, as the track reports it
+     */
+    void addSymbol(const QPointF &center, int identity, int state, double heading);
+
+    int pendingCount() const { return m_vecFragments.size(); }
+
+    /**
+     * @brief Draws and clears the queued symbols
+     *
+     * A single fragment draw on the GUI thread, one image blit per symbol on any other.
+     */
+    void drawPending(QPainter *pPainter);
+
+private:
+    QPixmap m_atlas;
+    QImage m_atlasImage;                    //!< Same pixels, for painters on worker threads
+    QVector<QRectF> m_vecSourceRects;       //!< Index (identity * kStateCount + state) * kHeadingCount + heading
+    QVector<QPainter::PixmapFragment> m_vecFragments;
+    double m_dBuildMs;
+};
+
+#endif // CTRACKSYMBOLATLAS_H
@@ -0,0 +1,241 @@
+#include "ctracktrailcache.h"
+#include <QtMath>
+#include <cmath>
+
+namespace {
+
+// Spacing of the kept trail points on screen
+const double kTolerancePx = 2.0;
+
+// Spacing at level 0, about 1.7 m of latitude
+const double kBaseToleranceDeg = 1.0 / 65536.0;
+
+// Top level spacing is 16 degrees, coarser than any trail at theatre scale
+const int kMaxLevel = 20;
+
+// Dropped history is compacted away once it is this long and half the storage
+const int kCompactHead = 64;
+
+} // namespace
+
+CTrackTrailCache::CTrackTrailCache()
+    : m_nLevel(0), m_dToleranceSq(kBaseToleranceDeg * kBaseToleranceDeg), m_nGeneration(0)
+{
+}
+
+bool CTrackTrailCache::setScale(double pixelPerDegree)
+{
+    if (pixelPerDegree <= 0.0) {
+        return false;
+    }
+
+    int level = int(std::floor(std::log2(kTolerancePx / pixelPerDegree / kBaseToleranceDeg)));
+    level = qBound(0, level, kMaxLevel);
+    if (level == m_nLevel) {
+        return false;
+    }
+
+    m_nLevel = level;
+    const double tolerance = std::ldexp(kBaseToleranceDeg, level);
+    m_dToleranceSq = tolerance * tolerance;
+    for (QHash<int, stTrail>::iterator it = m_hashTrails.begin(); it != m_hashTrails.end(); ++it) {
+        simplify(it.value());
+    }
+    return true;
+}
+
+void CTrackTrailCache::update(const QList<stTrackDisplayInfo> &tracks)
+{
+    m_nGeneration++;
+    int nListed = 0;
+
+    for (const stTrackDisplayInfo &track : tracks) {
+        if (!track.showHistory || track.historyPoints.isEmpty()) {
+            continue;
+        }
+        nListed++;
+
+        QHash<int, stTrail>::iterator it = m_hashTrails.find(track.nTrkId);
+        if (it == m_hashTrails.end()) {
+            it = m_hashTrails.insert(track.nTrkId, stTrail());
+        } else if (sync(it.value(), track.historyPoints)) {
+            it.value().generation = m_nGeneration;
+            continue;
+        }
+
+        // New trail, or a history that no longer lines up (cleared, toggled, limit changed)
+        stTrail &trail = it.value();
+        trail.lon.resize(0);
+        trail.lat.resize(0);
+        trail.head = 0;
+        trail.kept.resize(0);
+        trail.keptHead = 0;
+        for (const stTrackHistoryPoint &point : track.historyPoints) {
+            append(trail, point.lon, point.lat);
+        }
+        trail.generation = m_nGeneration;
+    }
+
+    // Trails of tracks that are gone or stopped showing history
+    if (m_hashTrails.size() > nListed) {
+        QHash<int, stTrail>::iterator it = m_hashTrails.begin();
+        while (it != m_hashTrails.end()) {
+            if (it.value().generation != m_nGeneration) {
+                it = m_hashTrails.erase(it);
+            } else {
+                ++it;
+            }
+        }
+    }
+}
+
+void CTrackTrailCache::flatten(const QList<stTrackDisplayInfo> &tracks, QVector<int> *pStart,
+                               QVector<double> *pLon, QVector<double> *pLat) const
+{
+    const int nTracks = tracks.size();
+    pStart->resize(nTracks + 1);
+    pLon->resize(0);
+    pLat->resize(0);
+
+    for (int i = 0; i < nTracks; ++i) {
+        (*pStart)[i] = pLon->size();
+        if (!tracks[i].showHistory) {
+            continue;
+        }
+        QHash<int, stTrail>::const_iterator it = m_hashTrails.constFind(tracks[i].nTrkId);
+        if (it == m_hashTrails.constEnd()) {
+            continue;
+        }
+
+        const stTrail &trail = it.value();
+        for (int k = trail.keptHead; k < trail.kept.size(); ++k) {
+            pLon->append(trail.lon[trail.kept[k]]);
+            pLat->append(trail.lat[trail.kept[k]]);
+        }
+        // The newest report always ends the trail
+        const int newest = trail.lon.size() - 1;
+        if (trail.kept.last() != newest) {
+            pLon->append(trail.lon[newest]);
+            pLat->append(trail.lat[newest]);
+        }
+    }
+    (*pStart)[nTracks] = pLon->size();
+}
+
+int CTrackTrailCache::pointCount() const
+{
+    int nPoints = 0;
+    for (const stTrail &trail : m_hashTrails) {
+        nPoints += trail.lon.size() - trail.head;
+    }
+    return nPoints;
+}
+
+int CTrackTrailCache::simplifiedCount() const
+{
+    int nPoints = 0;
+    for (const stTrail &trail : m_hashTrails) {
+        nPoints += trail.kept.size() - trail.keptHead;
+        nPoints += (trail.kept.last() != trail.lon.size() - 1) ? 1 : 0;
+    }
+    return nPoints;
+}
+
+void CTrackTrailCache::clear()
+{
+    m_hashTrails.clear();
+}
+
+bool CTrackTrailCache::sync(stTrail &trail, const QList<stTrackHistoryPoint> &points) const
+{
+    const int nCached = trail.lon.size() - trail.head;
+    const int nPoints = points.size();
+    if (nCached <= 0) {
+        return false;
+    }
+
+    // The history only loses points at the front and gains them at the back
+    const stTrackHistoryPoint &first = points.first();
+    int nDropped = 0;
+    while (nDropped < nCached &&
+           (trail.lon[trail.head + nDropped] != first.lon || trail.lat[trail.head + nDropped] != first.lat)) {
+        nDropped++;
+    }
+    const int nKept = nCached - nDropped;
+    if (nKept <= 0 || nKept > nPoints) {
+        return false;
+    }
+    const stTrackHistoryPoint &lastKept = points[nKept - 1];
+    if (trail.lon.last() != lastKept.lon || trail.lat.last() != lastKept.lat) {
+        return false;
+    }
+
+    dropFront(trail, nDropped);
+    for (int i = nKept; i < nPoints; ++i) {
+        append(trail, points[i].lon, points[i].lat);
+    }
+    return true;
+}
+
+void CTrackTrailCache::append(stTrail &trail, double lon, double lat) const
+{
+    trail.lon.append(lon);
+    trail.lat.append(lat);
+
+    const int index = trail.lon.size() - 1;
+    if (trail.keptHead < trail.kept.size()) {
+        const int last = trail.kept.last();
+        const double dx = lon - trail.lon[last], dy = lat - trail.lat[last];
+        if (dx * dx + dy * dy < m_dToleranceSq) {
+            return;
+        }
+    }
+    trail.kept.append(index);
+}
+
+void CTrackTrailCache::dropFront(stTrail &trail, int nPoints) const
+{
+    if (nPoints <= 0) {
+        return;
+    }
+
+    trail.head += nPoints;
+    while (trail.keptHead < trail.kept.size() && trail.kept[trail.keptHead] < trail.head) {
+        trail.keptHead++;
+    }
+    // The oldest remaining point starts the trail, the kept points after it stay put
+    if (trail.keptHead == trail.kept.size() || trail.kept[trail.keptHead] != trail.head) {
+        if (trail.keptHead > 0) {
+            trail.kept[--trail.keptHead] = trail.head;
+        } else {
+            trail.kept.prepend(trail.head);
+        }
+    }
+
+    if (trail.head >= kCompactHead && trail.head * 2 >= trail.lon.size()) {
+        trail.lon.remove(0, trail.head);
+        trail.lat.remove(0, trail.head);
+        trail.kept.remove(0, trail.keptHead);
+        for (int &index : trail.kept) {
+            index -= trail.head;
+        }
+        trail.head = 0;
+        trail.keptHead = 0;
+    }
+}
+
+void CTrackTrailCache::simplify(stTrail &trail) const
+{
+    trail.kept.resize(0);
+    trail.keptHead = 0;
+
+    double lastLon = 0.0, lastLat = 0.0;
+    for (int i = trail.head; i < trail.lon.size(); ++i) {
+        const double dx = trail.lon[i] - lastLon, dy = trail.lat[i] - lastLat;
+        if (trail.kept.isEmpty() || dx * dx + dy * dy >= m_dToleranceSq) {
+            trail.kept.append(i);
+            lastLon = trail.lon[i];
+            lastLat = trail.lat[i];
+        }
+    }
+}
@@ -0,0 +1,84 @@
+#ifndef CTRACKTRAILCACHE_H
+#define CTRACKTRAILCACHE_H
+
+#include <QHash>
+#include <QList>
+#include <QVector>
+#include "../globalstructs.h"
+
+/**
+ * @brief CTrackTrailCache - History trails in map coordinates, simplified for the zoom level
+ *
+ * Each track's trail is kept in contiguous coordinate arrays and brought up to date
+ * incrementally: points that aged out of the history are dropped from the front and new
+ * reports are appended, instead of copying every history point on every data refresh.
+ *
+ * Trails are simplified by radial distance: a point is kept when it is at least the
+ * tolerance away from the last kept point, and the newest point is always shown so the
+ * trail reaches the symbol. The tolerance is about two pixels on screen, rounded down to a
+ * power of two in degrees so small zooms keep the simplification; crossing a level
+ * resimplifies every trail once. Kept points do not move as the trail grows, so only
+ * the trail ends change between frames.
+ */
+class CTrackTrailCache
+{
+public:
+    CTrackTrailCache();
+
+    /**
+     * @brief Picks the simplification level for a map scale
+     * @return true if the level changed and the trails were resimplified
+     */
+    bool setScale(double pixelPerDegree);
+
+    /**
+     * @brief Brings the trails up to date with a track list
+     *
+     * Tracks without showHistory, and tracks no longer listed, lose their trail.
+     */
+    void update(const QList<stTrackDisplayInfo> &tracks);
+
+    /**
+     * @brief Writes the simplified trails in track order
+     * @param tracks Same list as the last update()
+     * @param pStart Trail of track i is [start[i], start[i+1]), tracks.size() + 1 entries
+     * @param pLon Trail longitudes, replaced
+     * @param pLat Trail latitudes, replaced
+     */
+    void flatten(const QList<stTrackDisplayInfo> &tracks, QVector<int> *pStart,
+                 QVector<double> *pLon, QVector<double> *pLat) const;
+
+    /**
+     * @brief History points held, and the points flatten() writes for them
+     */
+    int pointCount() const;
+    int simplifiedCount() const;
+
+    void clear();
+
+private:
+    struct stTrail {
+        QVector<double> lon;        //!< History from index head on
+        QVector<double> lat;
+        int head;
+        QVector<int> kept;          //!< Indices into lon/lat of the simplified trail, from keptHead on
+        int keptHead;
+        quint32 generation;         //!< Last update() that listed the track
+    };
+
+    QHash<int, stTrail> m_hashTrails;   //!< Key: track ID
+    int m_nLevel;
+    double m_dToleranceSq;              //!< Squared kept point spacing in degrees
+    quint32 m_nGeneration;
+
+    /**
+     * @brief Aligns a trail with the track's history, false if it has to be rebuilt
+     */
+    bool sync(stTrail &trail, const QList<stTrackHistoryPoint> &points) const;
+
+    void append(stTrail &trail, double lon, double lat) const;
+    void dropFront(stTrail &trail, int nPoints) const;
+    void simplify(stTrail &trail) const;
+};
+
+#endif // CTRACKTRAILCACHE_H
@@ -28,6 +28,9 @@ DEFINES += QT_DEPRECATED_WARNINGS
 
 CONFIG += c++11
 
+# -O2 alone does not vectorise loops that need alias checks; the batch kernels rely on it
+!msvc: QMAKE_CXXFLAGS_RELEASE += -ftree-vectorize
+
 # QGIS includes
 INCLUDEPATH += /usr/include/qgis
 
@@ -49,13 +52,27 @@ SOURCES += \
         MapDisplay/cppilayer.cpp \
         MapDisplay/crecordingwidget.cpp \
         MapDisplay/creplaywindow.cpp \
+        MapDisplay/cscreenprojector.cpp \
         MapDisplay/csearchbeamlayer.cpp \
         MapDisplay/csimulationwidget.cpp \
         MapDisplay/ctracklayer.cpp \
+        MapDisplay/ctrackrenderer.cpp \
+        MapDisplay/ctracklabelengine.cpp \
+        MapDisplay/ctrackclusterer.cpp \
+        MapDisplay/ctracktrailcache.cpp \
+        MapDisplay/cframescheduler.cpp \
+        MapDisplay/ctrackhitgrid.cpp \
+        MapDisplay/cframeprofiler.cpp \
+        MapDisplay/cframeprofileroverlay.cpp \
+        MapDisplay/ctracksymbolatlas.cpp \
+        MapDisplay/crendercache.cpp \
         MapDisplay/ctracktablewidget.cpp \
         MapDisplay/customgradiantfillsymbollayer.cpp \
+        ccoveragegrid.cpp \
         cdatawarehouse.cpp \
         cdrone.cpp \
+        cperfbenchmark.cpp \
+        ctrackfilterbank.cpp \
         cudpreceiver.cpp \
         main.cpp \
         cmapmainwindow.cpp \
@@ -66,6 +83,7 @@ SOURCES += \
 
 HEADERS += \
         CoordinateConverter.h \
+        CoordinateConverterT.h \
         MapDisplay/canalyticswidget.h \
         MapDisplay/cchartswidget.h \
         MapDisplay/cconfigpanelwidget.h \
@@ -76,13 +94,28 @@ HEADERS += \
         MapDisplay/cppilayer.h \
         MapDisplay/crecordingwidget.h \
         MapDisplay/creplaywindow.h \
+        MapDisplay/cscreenprojector.h \
         MapDisplay/csearchbeamlayer.h \
         MapDisplay/csimulationwidget.h \
         MapDisplay/ctracklayer.h \
+        MapDisplay/ctrackrenderer.h \
+        MapDisplay/ctracklabelengine.h \
+        MapDisplay/ctrackclusterer.h \
+        MapDisplay/ctracktrailcache.h \
+        MapDisplay/cframescheduler.h \
+        MapDisplay/ctrackhitgrid.h \
+        MapDisplay/cframeprofiler.h \
+        MapDisplay/cframeprofileroverlay.h \
+        MapDisplay/ctracksymbolatlas.h \
+        MapDisplay/clrucache.h \
+        MapDisplay/crendercache.h \
         MapDisplay/ctracktablewidget.h \
         MapDisplay/customgradiantfillsymbollayer.h \
+        ccoveragegrid.h \
         cdatawarehouse.h \
         cdrone.h \
+        cperfbenchmark.h \
+        ctrackfilterbank.h \
         cmapmainwindow.h \
         cppiwindow.h \
         ccontrolswindow.h \
@@ -90,7 +123,8 @@ HEADERS += \
         cudpreceiver.h \
         globalmacros.h \
         globalstructs.h \
-        matrix.h
+        matrix.h \
+        smallmatrix.h
 
 FORMS += \
         cmapmainwindow.ui
@@ -0,0 +1,235 @@
+#include "ccoveragegrid.h"
+#include <QElapsedTimer>
+#include <QDebug>
+#include <cmath>
+
+namespace {
+
+// Coverage below the radar plane: targets under the horizon and the site's own terrain
+const double kMinHeight = -500.0;
+
+// Upper bound on the node count when refining, 48 MB of nodes
+const int kMaxNodes = 2000000;
+
+// Cell centres compared with the exact conversion per build
+const int kMaxCheckedPoints = 20000;
+
+inline double wrapLon(double lon)
+{
+    if (lon > 180.0) lon -= 360.0;
+    else if (lon <= -180.0) lon += 360.0;
+    return lon;
+}
+
+} // namespace
+
+CCoverageGrid::CCoverageGrid()
+    : m_bBuilt(false), m_dLat0(0), m_dLon0(0), m_dLatPerMeter(0), m_dLonPerMeter(0), m_dInv2R(0),
+      m_dX0(0), m_dY0(0), m_dZ0(0),
+      m_dCell(1), m_dInvCell(1), m_nX(0), m_nY(0), m_nZ(0)
+{
+    m_report = stCoverageGridReport();
+}
+
+stCoverageGridReport CCoverageGrid::build(double lat, double lon, double alt,
+                                          double maxRange, double maxHeight, double maxError)
+{
+    QElapsedTimer timer;
+    timer.start();
+
+    m_conv.setlp(lat, lon, alt);
+    m_dLat0 = lat;
+    m_dLon0 = lon;
+
+    const double rad2deg = 180.0 / PI;
+    m_dLatPerMeter = rad2deg / m_conv.getlpRadiusMeridian();
+    m_dLonPerMeter = rad2deg / (m_conv.getlpRadiusPrimeVertical() * std::cos(lat / rad2deg));
+    m_dInv2R = 0.5 / m_conv.getlpRadiusPrimeVertical();
+
+    stCoverageGridReport report = stCoverageGridReport();
+
+    // Trilinear error grows with the square of the cell size and the geodetic
+    // mapping is nearly linear over a radar coverage, so start coarse and halve
+    double cell = qMax(maxRange, maxHeight) / 2.0;
+    for (;;) {
+        fill(cell, maxRange, maxHeight, kMinHeight);
+        measure(&report.maxErrHorizontal, &report.maxErrAltitude, &report.nCheckedPoints);
+
+        report.meetsBound = report.maxErrHorizontal <= maxError && report.maxErrAltitude <= maxError;
+        qint64 nextNodes = qint64(2 * m_nX - 1) * (2 * m_nY - 1) * (2 * m_nZ - 1);
+        if (report.meetsBound || nextNodes > kMaxNodes) {
+            break;
+        }
+        cell *= 0.5;
+        report.nRefinements++;
+    }
+
+    report.cellSize = m_dCell;
+    report.nNodesX = m_nX;
+    report.nNodesY = m_nY;
+    report.nNodesZ = m_nZ;
+    report.memoryBytes = qint64(m_vecNodes.size()) * sizeof(stNode);
+    report.buildMs = timer.nsecsElapsed() / 1.0e6;
+    m_report = report;
+
+    qDebug() << "[CCoverageGrid] built" << m_nX << "x" << m_nY << "x" << m_nZ << "nodes, cell"
+             << m_dCell << "m," << report.memoryBytes / 1024 << "KB in" << report.buildMs << "ms";
+    qDebug() << "  max error horizontal" << report.maxErrHorizontal << "m, altitude"
+             << report.maxErrAltitude << "m (bound" << maxError << "m"
+             << (report.meetsBound ? "met)" : "NOT met, node cap reached)");
+
+    return report;
+}
+
+void CCoverageGrid::clear()
+{
+    m_bBuilt = false;
+    m_vecNodes.clear();
+    m_vecNodes.squeeze();
+    m_nX = m_nY = m_nZ = 0;
+}
+
+void CCoverageGrid::fill(double cellSize, double maxRange, double maxHeight, double minHeight)
+{
+    m_dCell = cellSize;
+    m_dInvCell = 1.0 / cellSize;
+    m_nX = m_nY = int(std::ceil(2.0 * maxRange / cellSize)) + 1;
+    m_nZ = int(std::ceil((maxHeight - minHeight) / cellSize)) + 1;
+    m_dX0 = m_dY0 = -maxRange;
+    m_dZ0 = minHeight;
+
+    m_vecNodes.resize(m_nX * m_nY * m_nZ);
+    stNode *pNode = m_vecNodes.data();
+
+    for (int iz = 0; iz < m_nZ; ++iz) {
+        double z = m_dZ0 + iz * m_dCell;
+        for (int iy = 0; iy < m_nY; ++iy) {
+            double y = m_dY0 + iy * m_dCell;
+            for (int ix = 0; ix < m_nX; ++ix, ++pNode) {
+                double x = m_dX0 + ix * m_dCell;
+                double nodeLat, nodeLon, nodeAlt, modelLat, modelLon, modelAlt;
+                m_conv.env2geodetic_lp(x, y, z, &nodeLat, &nodeLon, &nodeAlt);
+                model(x, y, z, &modelLat, &modelLon, &modelAlt);
+                pNode->dLat = nodeLat - modelLat;
+                pNode->dLon = wrapLon(nodeLon - modelLon);
+                pNode->dAlt = nodeAlt - modelAlt;
+            }
+        }
+    }
+
+    m_bBuilt = true;
+}
+
+void CCoverageGrid::measure(double *pMaxHorizontal, double *pMaxAltitude, int *pChecked)
+{
+    const double deg2rad = PI / 180.0;
+    const double mPerDegLat = m_conv.getlpRadiusMeridian() * deg2rad;
+    const double mPerDegLon = m_conv.getlpRadiusPrimeVertical() * deg2rad * std::cos(m_dLat0 * deg2rad);
+
+    // Stride through the cells so large grids are checked at a bounded cost
+    qint64 nCells = qint64(m_nX - 1) * (m_nY - 1) * (m_nZ - 1);
+    int stride = int(qMax<qint64>(1, nCells / kMaxCheckedPoints));
+
+    double maxH = 0.0, maxA = 0.0;
+    int nChecked = 0;
+    for (qint64 c = 0; c < nCells; c += stride) {
+        int ix = int(c % (m_nX - 1));
+        int iy = int((c / (m_nX - 1)) % (m_nY - 1));
+        int iz = int(c / (qint64(m_nX - 1) * (m_nY - 1)));
+        double x = m_dX0 + (ix + 0.5) * m_dCell;
+        double y = m_dY0 + (iy + 0.5) * m_dCell;
+        double z = m_dZ0 + (iz + 0.5) * m_dCell;
+
+        double latG, lonG, altG, latE, lonE, altE;
+        lookup(x, y, z, &latG, &lonG, &altG);
+        m_conv.env2geodetic_lp(x, y, z, &latE, &lonE, &altE);
+
+        double dn = (latG - latE) * mPerDegLat;
+        double de = wrapLon(lonG - lonE) * mPerDegLon;
+        maxH = qMax(maxH, std::sqrt(dn * dn + de * de));
+        maxA = qMax(maxA, std::fabs(altG - altE));
+        nChecked++;
+    }
+
+    *pMaxHorizontal = maxH;
+    *pMaxAltitude = maxA;
+    *pChecked = nChecked;
+}
+
+bool CCoverageGrid::lookup(double x, double y, double z, double *lat, double *lon, double *alt) const
+{
+    if (!m_bBuilt) return false;
+
+    double fx = (x - m_dX0) * m_dInvCell;
+    double fy = (y - m_dY0) * m_dInvCell;
+    double fz = (z - m_dZ0) * m_dInvCell;
+
+    // Written so NaN inputs also fail
+    if (!(fx >= 0.0 && fy >= 0.0 && fz >= 0.0 &&
+          fx <= m_nX - 1 && fy <= m_nY - 1 && fz <= m_nZ - 1)) {
+        return false;
+    }
+
+    int ix = qMin(int(fx), m_nX - 2);
+    int iy = qMin(int(fy), m_nY - 2);
+    int iz = qMin(int(fz), m_nZ - 2);
+    double tx = fx - ix, ty = fy - iy, tz = fz - iz;
+
+    const int strideY = m_nX;
+    const int strideZ = m_nX * m_nY;
+    const stNode *p = m_vecNodes.constData() + iz * strideZ + iy * strideY + ix;
+
+    // Weights of the 8 corners
+    double wx0 = 1.0 - tx, wy0 = 1.0 - ty, wz0 = 1.0 - tz;
+    double w000 = wx0 * wy0 * wz0, w100 = tx * wy0 * wz0;
+    double w010 = wx0 * ty * wz0,  w110 = tx * ty * wz0;
+    double w001 = wx0 * wy0 * tz,  w101 = tx * wy0 * tz;
+    double w011 = wx0 * ty * tz,   w111 = tx * ty * tz;
+
+    const stNode &n000 = p[0],                 &n100 = p[1];
+    const stNode &n010 = p[strideY],           &n110 = p[strideY + 1];
+    const stNode &n001 = p[strideZ],           &n101 = p[strideZ + 1];
+    const stNode &n011 = p[strideZ + strideY], &n111 = p[strideZ + strideY + 1];
+
+    double dLat = w000 * n000.dLat + w100 * n100.dLat + w010 * n010.dLat + w110 * n110.dLat +
+                  w001 * n001.dLat + w101 * n101.dLat + w011 * n011.dLat + w111 * n111.dLat;
+    double dLon = w000 * n000.dLon + w100 * n100.dLon + w010 * n010.dLon + w110 * n110.dLon +
+                  w001 * n001.dLon + w101 * n101.dLon + w011 * n011.dLon + w111 * n111.dLon;
+    double dAlt = w000 * n000.dAlt + w100 * n100.dAlt + w010 * n010.dAlt + w110 * n110.dAlt +
+                  w001 * n001.dAlt + w101 * n101.dAlt + w011 * n011.dAlt + w111 * n111.dAlt;
+
+    double modelLat, modelLon, modelAlt;
+    model(x, y, z, &modelLat, &modelLon, &modelAlt);
+    *lat = modelLat + dLat;
+    *lon = wrapLon(modelLon + dLon);
+    *alt = modelAlt + dAlt;
+    return true;
+}
+
+bool CCoverageGrid::env2geodetic(double x, double y, double z, double *lat, double *lon, double *alt)
+{
+    if (lookup(x, y, z, lat, lon, alt)) {
+        return true;
+    }
+    m_conv.env2geodetic_lp(x, y, z, lat, lon, alt);
+    return false;
+}
+
+int CCoverageGrid::env2geodeticBatch(int n, const double *x, const double *y, const double *z,
+                                     double *lat, double *lon, double *alt)
+{
+    int nFallback = 0;
+    for (int i = 0; i < n; ++i) {
+        if (!env2geodetic(x[i], y[i], z[i], &lat[i], &lon[i], &alt[i])) {
+            nFallback++;
+        }
+    }
+    return nFallback;
+}
+
+void CCoverageGrid::convert(double x, double y, double z, double *lat, double *lon, double *alt,
+                            double *range, double *azimuth, double *elevation)
+{
+    env2geodetic(x, y, z, lat, lon, alt);
+    m_conv.env2polar(range, azimuth, elevation, x, y, z);
+}
@@ -0,0 +1,121 @@
+#ifndef CCOVERAGEGRID_H
+#define CCOVERAGEGRID_H
+
+#include <QVector>
+#include "CoordinateConverter.h"
+
+/**
+ * @brief Build and accuracy figures of a CCoverageGrid
+ *
+ * Errors are measured at cell centres, where trilinear interpolation of a smooth
+ * field is worst, against env2geodetic_lp() on the same reference point.
+ */
+struct stCoverageGridReport {
+    double cellSize;            //!< Node spacing (m)
+    int nNodesX;                //!< Nodes along East
+    int nNodesY;                //!< Nodes along North
+    int nNodesZ;                //!< Nodes along Vertical
+    qint64 memoryBytes;         //!< Node storage
+    double buildMs;             //!< Time to fill the grid and verify it, all refinements included
+    int nRefinements;           //!< Cell size halvings needed to meet the error bound
+    int nCheckedPoints;         //!< Cell centres compared with the exact conversion
+    double maxErrHorizontal;    //!< Max horizontal position error (m)
+    double maxErrAltitude;      //!< Max altitude error (m)
+    bool meetsBound;            //!< False if the node cap was hit before the bound was met
+};
+
+/**
+ * @brief CCoverageGrid - Trilinear ENV -> geodetic lookup over a fixed radar coverage
+ *
+ * For plot rates where even the bound-origin conversion is too costly, the geodetic
+ * position of every node of a regular ENV grid is precomputed and plots are
+ * interpolated between the 8 surrounding nodes. The nodes hold the residual from a
+ * local tangent-plane model (linear lat/lon, altitude plus earth curvature), which is
+ * far smoother than the geodetic field itself, so a coarse grid that stays in cache
+ * meets sub-centimetre bounds. The cell size is chosen at build time to meet a
+ * requested error bound. Points outside the grid fall back to the exact conversion.
+ *
+ * Range/azimuth/elevation are not interpolated: they are singular at the radar and
+ * azimuth wraps at North, so no cell size bounds the error there. env2polar is only a
+ * sqrt and two atan2, and convert() computes it exactly.
+ */
+class CCoverageGrid
+{
+public:
+    CCoverageGrid();
+
+    /**
+     * @brief Builds the grid around a radar position
+     * @param lat Radar latitude in degrees
+     * @param lon Radar longitude in degrees
+     * @param alt Radar altitude in meters
+     * @param maxRange Horizontal half extent of the coverage (m)
+     * @param maxHeight Top of the coverage above the radar (m)
+     * @param maxError Required bound on the horizontal and altitude error (m)
+     * @return Build and accuracy figures, also logged through qDebug()
+     */
+    stCoverageGridReport build(double lat, double lon, double alt,
+                               double maxRange = 8000.0, double maxHeight = 8000.0,
+                               double maxError = 0.01);
+
+    void clear();
+    bool isBuilt() const { return m_bBuilt; }
+    const stCoverageGridReport &report() const { return m_report; }
+
+    /**
+     * @brief Interpolates the geodetic position of an ENV point
+     * @return false if the point is outside the grid (outputs untouched)
+     */
+    bool lookup(double x, double y, double z, double *lat, double *lon, double *alt) const;
+
+    /**
+     * @brief Geodetic position by lookup, or by the exact conversion outside the grid
+     * @return true if the grid was used
+     */
+    bool env2geodetic(double x, double y, double z, double *lat, double *lon, double *alt);
+
+    /**
+     * @brief Batch env2geodetic() over n points
+     * @return Number of points that needed the exact fallback
+     */
+    int env2geodeticBatch(int n, const double *x, const double *y, const double *z,
+                          double *lat, double *lon, double *alt);
+
+    /**
+     * @brief Geodetic position (grid or fallback) plus exact range/azimuth/elevation (degrees)
+     */
+    void convert(double x, double y, double z, double *lat, double *lon, double *alt,
+                 double *range, double *azimuth, double *elevation);
+
+private:
+    // Residuals from the tangent-plane model evaluated at the node
+    struct stNode {
+        double dLat;            //!< Latitude residual (deg)
+        double dLon;            //!< Longitude residual (deg)
+        double dAlt;            //!< Altitude residual (m)
+    };
+
+    bool m_bBuilt;
+    CoordinateConverter m_conv;     //!< Bound to the radar position, used for nodes and fallback
+    double m_dLat0, m_dLon0;
+    double m_dLatPerMeter;          //!< Tangent-plane model: degrees of latitude per meter North
+    double m_dLonPerMeter;          //!< Tangent-plane model: degrees of longitude per meter East
+    double m_dInv2R;                //!< Tangent-plane model: curvature drop is (x^2 + y^2) * m_dInv2R
+    double m_dX0, m_dY0, m_dZ0;     //!< ENV position of node (0, 0, 0)
+    double m_dCell, m_dInvCell;
+    int m_nX, m_nY, m_nZ;           //!< Node counts
+    QVector<stNode> m_vecNodes;     //!< Index (iz * m_nY + iy) * m_nX + ix
+    stCoverageGridReport m_report;
+
+    inline void model(double x, double y, double z, double *lat, double *lon, double *alt) const
+    {
+        *lat = m_dLat0 + y * m_dLatPerMeter;
+        *lon = m_dLon0 + x * m_dLonPerMeter;
+        *alt = z + (x * x + y * y) * m_dInv2R;
+    }
+
+    void fill(double cellSize, double maxRange, double maxHeight, double minHeight);
+    void measure(double *pMaxHorizontal, double *pMaxAltitude, int *pChecked);
+};
+
+#endif // CCOVERAGEGRID_H
@@ -4,6 +4,7 @@
 #include <QDateTime>
 #include <QDebug>
 #include "cdrone.h"
+#include <QtMath>
 
 // Initialize static member variables
 CDataWarehouse* CDataWarehouse::_m_pInstance = nullptr;
@@ -21,9 +22,14 @@ CDataWarehouse* CDataWarehouse::getInstance()
     return _m_pInstance;
 }
 
-CDataWarehouse::CDataWarehouse(QObject *parent) : QObject(parent), _m_nHistoryLimit(50)
+CDataWarehouse::CDataWarehouse(QObject *parent) : QObject(parent),
+    _m_bUseCoverageGrid(false), _m_dGridRange(8000.0), _m_dGridMaxError(0.01),
+    _m_nHistoryLimit(50), _m_nDataVersion(0), _m_nPublishedVersion(0), _m_bCovarianceEnabled(false)
 {
+    setMeasurementNoise(15.0, 0.5, 1.0);
+
     _m_RadarPos = QPointF(77.2946, 13.2716);
+    _m_CoordConv.setlp(_m_RadarPos.y(), _m_RadarPos.x(), 0);
 
 //    stTrackRecvInfo info1;
 //    info1.nTrkId = 1;
@@ -60,6 +66,9 @@ CDataWarehouse::CDataWarehouse(QObject *parent) : QObject(parent), _m_nHistoryLi
     connect(&_m_timeTrackTimeout,SIGNAL(timeout()),this,SLOT(slotClearTracksOnTimeOut()));
     _m_timeTrackTimeout.start(5000);
 
+    connect(&_m_timerCycle, SIGNAL(timeout()), this, SLOT(slotProcessCycle()));
+    _m_timerCycle.start(100);
+
 //    _m_UdpRecvr.startListening(2025);
 //    connect(&_m_UdpRecvr,SIGNAL(signalUpdateTrackData(stTrackRecvInfo)),this,SLOT(slotUpdateTrackData(stTrackRecvInfo)));
 
@@ -79,21 +88,198 @@ CDataWarehouse::CDataWarehouse(QObject *parent) : QObject(parent), _m_nHistoryLi
 }
 
 QList<stTrackDisplayInfo> CDataWarehouse::getTrackList() {
+    QMutexLocker locker(&_m_dataMutex);
     return _m_listTrackInfo.values();
 }
 
+quint64 CDataWarehouse::getDataVersion() {
+    QMutexLocker locker(&_m_dataMutex);
+    return _m_nDataVersion;
+}
+
 void CDataWarehouse::slotClearTracksOnTimeOut() {
+    QMutexLocker locker(&_m_dataMutex);
 
     QList<int> trackIds = _m_listTrackInfo.keys();
     for ( int trackId : trackIds  ) {
         stTrackDisplayInfo trackInfo = _m_listTrackInfo.value(trackId);
         if ( (trackInfo.nTrackTime + 10) < QDateTime::currentDateTime().toSecsSinceEpoch() ) {
             _m_listTrackInfo.remove(trackInfo.nTrkId);
+            ++_m_nDataVersion;
+            _m_setDirtyTracks.remove(trackInfo.nTrkId);
+            _m_FilterBank.removeTrack(trackInfo.nTrkId);
+        }
+    }
+}
+
+void CDataWarehouse::slotProcessCycle() {
+    _updateFilters();
+
+    if (_m_bCovarianceEnabled) {
+        _updateCovariances();
+    }
+
+    _publishDroneNotifications();
+
+    // Reports arrive on the receiver thread; views hear about them once per cycle
+    bool dataChanged = false;
+    {
+        QMutexLocker locker(&_m_dataMutex);
+        dataChanged = (_m_nDataVersion != _m_nPublishedVersion);
+        _m_nPublishedVersion = _m_nDataVersion;
+    }
+    if (dataChanged) {
+        emit signalDataChanged();
+    }
+}
+
+void CDataWarehouse::_publishDroneNotifications() {
+    _m_listChangedDrones.clear();
+    _m_vecNotifyDrones.resize(0);
+    _m_vecNotifyState.resize(0);
+    _m_vecNotifyEmergency.resize(0);
+
+    {
+        QMutexLocker locker(&_m_dataMutex);
+
+        QString emergency;
+        for (auto it = _m_mapDrones.constBegin(); it != _m_mapDrones.constEnd(); ++it) {
+            bool stateChanged = it.value()->collectNotifications(&emergency);
+            if (!stateChanged && emergency.isEmpty()) continue;
+
+            if (stateChanged) _m_listChangedDrones.append(it.key());
+            _m_vecNotifyDrones.append(it.value());
+            _m_vecNotifyState.append(stateChanged);
+            _m_vecNotifyEmergency.append(emergency);
+        }
+    }
+
+    // Receivers may call back into the warehouse, so emit without the lock; one of
+    // them deleting a track clears its guarded pointer
+    for (int i = 0; i < _m_vecNotifyDrones.size(); ++i) {
+        CDrone *pDrone = _m_vecNotifyDrones[i];
+        if (!pDrone) continue;
+        pDrone->publishNotifications(_m_vecNotifyState[i], _m_vecNotifyEmergency[i]);
+        if (!_m_vecNotifyEmergency[i].isEmpty()) {
+            emit signalEmergencyAlert(pDrone->getTrackId(), _m_vecNotifyEmergency[i]);
+        }
+    }
+
+    if (!_m_listChangedDrones.isEmpty()) {
+        emit signalDroneStatesChanged(_m_listChangedDrones);
+    }
+}
+
+void CDataWarehouse::_updateFilters() {
+    QMutexLocker locker(&_m_dataMutex);
+
+    // One batched predict/update for every track reported since the last cycle
+    if (_m_FilterBank.process() == 0) return;
+
+    stFilteredTrackState state;
+    for (int trackId : _m_FilterBank.updatedTracks()) {
+        CDrone *pDrone = _m_mapDrones.value(trackId, nullptr);
+        if (pDrone && _m_FilterBank.getState(trackId, &state) && state.nUpdates > 1) {
+            pDrone->setFilteredDynamics(state);
         }
     }
 }
 
+void CDataWarehouse::_updateCovariances() {
+    // Gather the tracks updated since the last cycle into flat arrays, and the origin
+    // they were reported against; setRadarPos() rebuilds it under the same lock
+    CoordinateConverter coordConv;
+    {
+        QMutexLocker locker(&_m_dataMutex);
+        if (_m_setDirtyTracks.isEmpty()) return;
+
+        coordConv = _m_CoordConv;
+
+        int n = _m_setDirtyTracks.size();
+        _m_vecBatchIds.resize(n);
+        _m_vecBatchX.resize(n);
+        _m_vecBatchY.resize(n);
+        _m_vecBatchZ.resize(n);
+        _m_vecBatchAlt.resize(n);
+
+        int i = 0;
+        for (int trackId : _m_setDirtyTracks) {
+            auto it = _m_listTrackInfo.constFind(trackId);
+            if (it == _m_listTrackInfo.constEnd()) continue;
+            _m_vecBatchIds[i] = trackId;
+            _m_vecBatchX[i] = it->x;
+            _m_vecBatchY[i] = it->y;
+            _m_vecBatchZ[i] = it->z;
+            _m_vecBatchAlt[i] = it->alt;
+            i++;
+        }
+        _m_vecBatchIds.resize(i);
+        _m_setDirtyTracks.clear();
+    }
+
+    // Propagate outside the lock so the receiver thread is not held up
+    int n = _m_vecBatchIds.size();
+    _m_vecBatchCovEnv.resize(6*n);
+    _m_vecBatchCovGeo.resize(6*n);
+    coordConv.cov_pos_polar2env_batch(n, _m_vecBatchX.constData(), _m_vecBatchY.constData(),
+                                      _m_vecBatchZ.constData(), _m_dVarRange, _m_dVarElevation,
+                                      _m_dVarAzimuth, _m_vecBatchCovEnv.data());
+    coordConv.cov_pos_env2geodetic_lp_batch(n, _m_vecBatchAlt.constData(),
+                                            _m_vecBatchCovEnv.constData(), _m_vecBatchCovGeo.data());
+
+    QMutexLocker locker(&_m_dataMutex);
+    for (int i = 0; i < n; i++) {
+        auto it = _m_listTrackInfo.find(_m_vecBatchIds[i]);
+        if (it == _m_listTrackInfo.end()) continue;
+
+        const double *pEnv = _m_vecBatchCovEnv.constData() + 6*i;
+        const double *pGeo = _m_vecBatchCovGeo.constData() + 6*i;
+        for (int k = 0; k < 6; k++) {
+            it->covEnv[k] = pEnv[k];
+            it->covGeo[k] = pGeo[k];
+        }
+
+        // Eigen decomposition of the lon/lat block gives the horizontal ellipse
+        double a = pGeo[0], b = pGeo[1], c = pGeo[3];
+        double mid = 0.5*(a + c);
+        double rad = qSqrt(0.25*(a - c)*(a - c) + b*b);
+        it->ellipseMajor = qSqrt(mid + rad);
+        it->ellipseMinor = qSqrt(qMax(mid - rad, 0.0));
+        it->ellipseAngle = qRadiansToDegrees(0.5*qAtan2(2.0*b, a - c));
+        it->hasCovariance = true;
+        ++_m_nDataVersion;
+    }
+}
+
+void CDataWarehouse::setCovarianceEnabled(bool enabled) {
+    QMutexLocker locker(&_m_dataMutex);
+    if (_m_bCovarianceEnabled == enabled) return;
+    _m_bCovarianceEnabled = enabled;
+
+    // Every track needs a fresh covariance on enable, and a stale one must not be drawn after disable
+    _m_setDirtyTracks.clear();
+    for (auto it = _m_listTrackInfo.begin(); it != _m_listTrackInfo.end(); ++it) {
+        it->hasCovariance = false;
+        ++_m_nDataVersion;
+        if (enabled) _m_setDirtyTracks.insert(it.key());
+    }
+}
+
+bool CDataWarehouse::isCovarianceEnabled() const {
+    return _m_bCovarianceEnabled;
+}
+
+void CDataWarehouse::setMeasurementNoise(double sigmaRange, double sigmaAzimuthDeg, double sigmaElevationDeg) {
+    double sigmaAz = qDegreesToRadians(sigmaAzimuthDeg);
+    double sigmaEl = qDegreesToRadians(sigmaElevationDeg);
+    _m_dVarRange = sigmaRange*sigmaRange;
+    _m_dVarAzimuth = sigmaAz*sigmaAz;
+    _m_dVarElevation = sigmaEl*sigmaEl;
+}
+
 void CDataWarehouse::slotUpdateTrackData(stTrackRecvInfo trackRecvInfo) {
+    // Runs on the UDP receiver thread (direct connection)
+    QMutexLocker locker(&_m_dataMutex);
 
     stTrackDisplayInfo info;
     
@@ -103,19 +289,40 @@ void CDataWarehouse::slotUpdateTrackData(stTrackRecvInfo trackRecvInfo) {
         info = _m_listTrackInfo.value(trackRecvInfo.nTrkId);
     } else {
         info.showHistory = false;  // Default to history off for new tracks
+        info.hasCovariance = false;
     }
     
     info.nTrkId = trackRecvInfo.nTrkId;
+    info.x = trackRecvInfo.x;
+    info.y = trackRecvInfo.y;
+    info.z = trackRecvInfo.z;
     info.heading = trackRecvInfo.heading;
     info.velocity = trackRecvInfo.velocity;
     info.nTrackIden = trackRecvInfo.nTrackIden;
     info.nTrackTime = QDateTime::currentDateTime().toSecsSinceEpoch();
 
-    _m_CoordConv.env2geodetic(trackRecvInfo.x,trackRecvInfo.y,trackRecvInfo.z,
-                              _m_RadarPos.y(),_m_RadarPos.x(),0,&info.lat,&info.lon,&info.alt,0);
+    if (_m_bUseCoverageGrid) {
+        // Trilinear lookup inside the coverage, exact conversion outside it
+        _m_CoverageGrid.env2geodetic(trackRecvInfo.x,trackRecvInfo.y,trackRecvInfo.z,
+                                     &info.lat,&info.lon,&info.alt);
+    } else {
+        // Radar origin is bound via setlp(), so this is a rotation plus the geodetic solve
+        _m_CoordConv.env2geodetic_lp(trackRecvInfo.x,trackRecvInfo.y,trackRecvInfo.z,
+                                     &info.lat,&info.lon,&info.alt);
+    }
 
     _m_CoordConv.env2polar(&info.range,&info.azimuth,&info.elevation,
                            trackRecvInfo.x,trackRecvInfo.y,trackRecvInfo.z);
+
+    // Geographic rates for display dead reckoning; heading is counter-clockwise
+    // from East, as the simulator and the speed vector use it
+    double headingRad = qDegreesToRadians(info.heading);
+    double velEast = info.velocity * qCos(headingRad);
+    double velNorth = info.velocity * qSin(headingRad);
+    info.nUpdateTimeMs = QDateTime::currentMSecsSinceEpoch();
+    info.latRate = qRadiansToDegrees(velNorth / (_m_CoordConv.getlpRadiusMeridian() + info.alt));
+    info.lonRate = qRadiansToDegrees(velEast / ((_m_CoordConv.getlpRadiusPrimeVertical() + info.alt) *
+                                                qCos(qDegreesToRadians(info.lat))));
     
     // Create or get drone for this track
     if (!_m_mapDrones.contains(trackRecvInfo.nTrkId)) {
@@ -149,13 +356,47 @@ void CDataWarehouse::slotUpdateTrackData(stTrackRecvInfo trackRecvInfo) {
     }
 
     _m_listTrackInfo.insert(info.nTrkId,info);
+    ++_m_nDataVersion;
+
+    _m_FilterBank.addMeasurement(info.nTrkId, trackRecvInfo.x, trackRecvInfo.y, trackRecvInfo.z,
+                                 info.nUpdateTimeMs);
+
+    if (_m_bCovarianceEnabled) {
+        _m_setDirtyTracks.insert(info.nTrkId);
+    }
 }
 
 const QPointF CDataWarehouse::getRadarPos() {
     return _m_RadarPos;
 }
 
+void CDataWarehouse::setRadarPos(const QPointF &radarPos) {
+    // Moving platforms update the origin far less often than tracks arrive,
+    // so the local-frame terms are rebuilt here once instead of per track
+    QMutexLocker locker(&_m_dataMutex);
+    _m_RadarPos = radarPos;
+    _m_CoordConv.setlp(_m_RadarPos.y(), _m_RadarPos.x(), 0);
+
+    if (_m_bUseCoverageGrid) {
+        _m_CoverageGrid.build(_m_RadarPos.y(), _m_RadarPos.x(), 0, _m_dGridRange, _m_dGridRange, _m_dGridMaxError);
+    }
+}
+
+stCoverageGridReport CDataWarehouse::setCoverageGridEnabled(bool enabled, double maxRange, double maxError) {
+    QMutexLocker locker(&_m_dataMutex);
+    _m_bUseCoverageGrid = enabled;
+    _m_dGridRange = maxRange;
+    _m_dGridMaxError = maxError;
+
+    if (!enabled) {
+        _m_CoverageGrid.clear();
+        return stCoverageGridReport();
+    }
+    return _m_CoverageGrid.build(_m_RadarPos.y(), _m_RadarPos.x(), 0, maxRange, maxRange, maxError);
+}
+
 void CDataWarehouse::toggleTrackHistory(int trackId) {
+    QMutexLocker locker(&_m_dataMutex);
     if (_m_listTrackInfo.contains(trackId)) {
         stTrackDisplayInfo info = _m_listTrackInfo.value(trackId);
         info.showHistory = !info.showHistory;
@@ -175,11 +416,13 @@ void CDataWarehouse::toggleTrackHistory(int trackId) {
         }
         
         _m_listTrackInfo.insert(trackId, info);
+        ++_m_nDataVersion;
     }
 }
 
 void CDataWarehouse::setHistoryLimit(int limit) {
     if (limit > 0 && limit <= 1000) {  // Sanity check
+        QMutexLocker locker(&_m_dataMutex);
         _m_nHistoryLimit = limit;
         
         // Trim existing histories to new limit
@@ -190,6 +433,7 @@ void CDataWarehouse::setHistoryLimit(int limit) {
                 info.historyPoints.removeFirst();
             }
             _m_listTrackInfo.insert(trackId, info);
+            ++_m_nDataVersion;
         }
     }
 }
@@ -199,9 +443,12 @@ int CDataWarehouse::getHistoryLimit() const {
 }
 
 void CDataWarehouse::deleteTrack(int trackId) {
-    QMutexLocker locker(&_m_mutex);
+    QMutexLocker locker(&_m_dataMutex);
     if (_m_listTrackInfo.contains(trackId)) {
         _m_listTrackInfo.remove(trackId);
+        ++_m_nDataVersion;
+        _m_setDirtyTracks.remove(trackId);
+        _m_FilterBank.removeTrack(trackId);
         qDebug() << "Track" << trackId << "deleted from data warehouse";
     }
     
@@ -215,22 +462,38 @@ void CDataWarehouse::deleteTrack(int trackId) {
 }
 
 void CDataWarehouse::setTrackImagePath(int trackId, const QString &imagePath) {
+    QMutexLocker locker(&_m_dataMutex);
     if (_m_listTrackInfo.contains(trackId)) {
         stTrackDisplayInfo info = _m_listTrackInfo.value(trackId);
         info.imagePath = imagePath;
         _m_listTrackInfo.insert(trackId, info);
+        ++_m_nDataVersion;
         qDebug() << "Image path set for track" << trackId << ":" << imagePath;
     }
 }
 
 CDrone* CDataWarehouse::getDrone(int trackId) {
+    QMutexLocker locker(&_m_dataMutex);
     if (_m_mapDrones.contains(trackId)) {
         return _m_mapDrones.value(trackId);
     }
     return nullptr;
 }
 
+bool CDataWarehouse::getDroneSnapshot(int trackId, stDroneInternalState *pState, QColor *pHealth, QString *pMode) {
+    QMutexLocker locker(&_m_dataMutex);
+    const CDrone *pDrone = _m_mapDrones.value(trackId, nullptr);
+    if (!pDrone) {
+        return false;
+    }
+    *pState = pDrone->getInternalState();
+    *pHealth = pDrone->getHealthStatusColor();
+    *pMode = pDrone->getFlightModeString();
+    return true;
+}
+
 void CDataWarehouse::createDroneForTrack(int trackId) {
+    QMutexLocker locker(&_m_dataMutex);
     if (!_m_mapDrones.contains(trackId)) {
         CDrone* pDrone = new CDrone(trackId, this);
         _m_mapDrones.insert(trackId, pDrone);
@@ -240,13 +503,25 @@ void CDataWarehouse::createDroneForTrack(int trackId) {
             stTrackDisplayInfo info = _m_listTrackInfo.value(trackId);
             info.pDrone = pDrone;
             _m_listTrackInfo.insert(trackId, info);
+            ++_m_nDataVersion;
         }
         
         qDebug() << "Created drone for track" << trackId;
     }
 }
 
+void CDataWarehouse::simulateDroneStep(quint64 seed, quint64 step) {
+    QMutexLocker locker(&_m_dataMutex);
+    QVector<CDrone*> vecDrones;
+    vecDrones.reserve(_m_mapDrones.size());
+    for (CDrone *pDrone : _m_mapDrones) {
+        vecDrones.append(pDrone);
+    }
+    CDrone::simulateBatch(vecDrones, seed, step);
+}
+
 void CDataWarehouse::updateDroneForTrack(int trackId) {
+    QMutexLocker locker(&_m_dataMutex);
     if (_m_mapDrones.contains(trackId) && _m_listTrackInfo.contains(trackId)) {
         CDrone* pDrone = _m_mapDrones.value(trackId);
         stTrackDisplayInfo trackInfo = _m_listTrackInfo.value(trackId);
@@ -9,6 +9,11 @@
 #include <QPointF>
 #include <QTimer>
 #include "cdrone.h"
+#include "ccoveragegrid.h"
+#include "ctrackfilterbank.h"
+#include <QSet>
+#include <QVector>
+#include <QPointer>
 
 class CDataWarehouse : public QObject
 {
@@ -23,7 +28,16 @@ public :
 
     QList<stTrackDisplayInfo> getTrackList();
 
+    /**
+     * @brief Counter bumped on every change to the track table
+     *
+     * Views compare it with the value of their last getTrackList() to skip
+     * refetching and reprojecting when nothing changed.
+     */
+    quint64 getDataVersion();
+
     const QPointF getRadarPos();
+    void setRadarPos(const QPointF &radarPos);
 
     void toggleTrackHistory(int trackId);
     void setHistoryLimit(int limit);
@@ -33,14 +47,74 @@ public :
 
     // Drone management functions
     CDrone* getDrone(int trackId);
+
+    /**
+     * @brief Copies what the drone panel shows under the data lock
+     *
+     * The UDP receiver thread updates drones under the same lock, so views on the GUI
+     * thread take their copy here rather than through the CDrone getters.
+     * @return false if the track has no drone
+     */
+    bool getDroneSnapshot(int trackId, stDroneInternalState *pState, QColor *pHealth, QString *pMode);
     void createDroneForTrack(int trackId);
     void updateDroneForTrack(int trackId);
 
+    /**
+     * @brief Enables per-track position covariance and uncertainty ellipses
+     * @param enabled When false the processing cycle skips the covariance stage
+     */
+    void setCovarianceEnabled(bool enabled);
+    bool isCovarianceEnabled() const;
+
+    /**
+     * @brief Sets the 1-sigma radar measurement noise used for covariance propagation
+     * @param sigmaRange Range noise in meters
+     * @param sigmaAzimuthDeg Azimuth noise in degrees
+     * @param sigmaElevationDeg Elevation noise in degrees
+     */
+    void setMeasurementNoise(double sigmaRange, double sigmaAzimuthDeg, double sigmaElevationDeg);
+
+    /**
+     * @brief Converts incoming tracks through a precomputed coverage grid
+     * @param enabled Builds the grid around the radar position, or releases it
+     * @param maxRange Horizontal half extent and height of the coverage (m)
+     * @param maxError Error bound the grid is built to (m)
+     * @return Build figures, default-initialised when disabling
+     */
+    stCoverageGridReport setCoverageGridEnabled(bool enabled, double maxRange = 8000.0, double maxError = 0.01);
+
+    /**
+     * @brief Advances every drone's simulated internal state by one step, in parallel
+     *
+     * For soak tests: the same seed and step sequence reproduces the same drone states
+     * whatever the thread count.
+     */
+    void simulateDroneStep(quint64 seed, quint64 step);
+
+signals:
+    /**
+     * @brief The track table changed since the last processing cycle, at most one emission per cycle
+     *
+     * Views schedule a redraw from this instead of polling getDataVersion() on a timer.
+     */
+    void signalDataChanged();
+
+    /**
+     * @brief Drones whose state changed during the last processing cycle, one emission per cycle
+     */
+    void signalDroneStatesChanged(const QList<int> &trackIds);
+
+    /**
+     * @brief An emergency condition set in on a drone, once per onset
+     */
+    void signalEmergencyAlert(int trackId, const QString &reason);
+
 public slots:
     void slotUpdateTrackData(stTrackRecvInfo trackRecvInfo);
 
 private slots:
     void slotClearTracksOnTimeOut();
+    void slotProcessCycle();
 private:
     /**
      * @brief Private constructor for singleton pattern
@@ -60,12 +134,49 @@ private:
 
     CoordinateConverter _m_CoordConv;
 
+    CTrackFilterBank _m_FilterBank;    //!< Smoothed kinematics for every track, fed each cycle
+
+    CCoverageGrid _m_CoverageGrid;     //!< Optional lookup for ENV -> geodetic, built on demand
+    bool _m_bUseCoverageGrid;
+    double _m_dGridRange;
+    double _m_dGridMaxError;
+
     QPointF _m_RadarPos;
 
     int _m_nHistoryLimit;  //!< Maximum number of history points to maintain
 
     QHash<int, CDrone*> _m_mapDrones;  //!< Map of track ID to drone object
 
+    QMutex _m_dataMutex;               //!< Guards track data shared with the UDP receiver thread
+    quint64 _m_nDataVersion;           //!< Bumped on every change to _m_listTrackInfo
+    quint64 _m_nPublishedVersion;      //!< _m_nDataVersion at the last signalDataChanged()
+    QTimer _m_timerCycle;              //!< Drives the batched per-cycle processing
+    QSet<int> _m_setDirtyTracks;       //!< Tracks updated since the last processing cycle
+
+    bool _m_bCovarianceEnabled;
+    double _m_dVarRange;               //!< Range variance (m^2)
+    double _m_dVarAzimuth;             //!< Azimuth variance (rad^2)
+    double _m_dVarElevation;           //!< Elevation variance (rad^2)
+
+    // Batch buffers, kept between cycles so the steady state does not allocate
+    QVector<int> _m_vecBatchIds;
+    QVector<double> _m_vecBatchX;
+    QVector<double> _m_vecBatchY;
+    QVector<double> _m_vecBatchZ;
+    QVector<double> _m_vecBatchAlt;
+    QVector<double> _m_vecBatchCovEnv;
+    QVector<double> _m_vecBatchCovGeo;
+
+    // Drone notifications collected in a cycle, published outside the data lock
+    QList<int> _m_listChangedDrones;
+    QVector<QPointer<CDrone> > _m_vecNotifyDrones;
+    QVector<char> _m_vecNotifyState;
+    QVector<QString> _m_vecNotifyEmergency;
+
+    void _updateCovariances();
+    void _updateFilters();
+    void _publishDroneNotifications();
+
 };
 
 #endif // CDATAWAREHOUSE_H
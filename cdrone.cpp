@@ -3,6 +3,40 @@
 #include <QDebug>
 #include <QRandomGenerator>
 #include <QColor>
+#include <QMetaMethod>
+#include <QtConcurrent>
+
+namespace {
+
+// Drones per task of simulateBatch(), enough to amortise the task overhead
+const int kSimChunkSize = 64;
+
+// splitmix64 finaliser
+inline quint64 mix64(quint64 z)
+{
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+}
+
+/*
+ * Counter-based random stream: draw k is a hash of (key, k), no state is shared
+ * between streams, so streams are independent of threads and scheduling.
+ */
+struct stCounterRandom {
+    quint64 key;
+    quint64 counter;
+
+    stCounterRandom(quint64 seed, int trackId, quint64 step)
+        : key(mix64(mix64(seed + 0x9E3779B97F4A7C15ull * quint32(trackId)) + step)), counter(0) {}
+
+    quint32 next() { return quint32(mix64(key + 0x9E3779B97F4A7C15ull * ++counter) >> 32); }
+
+    // [0, n) by multiply-shift, the bias is below 1e-7 for the small n used here
+    int bounded(int n) { return int((quint64(next()) * quint32(n)) >> 32); }
+};
+
+} // namespace
 
 CDrone::CDrone(int trackId, QObject *parent)
     : QObject(parent)
@@ -13,6 +47,10 @@ CDrone::CDrone(int trackId, QObject *parent)
     , m_bearingChangeRate(0.0)
     , m_acceleration(0.0)
     , m_climbRate(0.0)
+    , m_bFilteredDynamics(false)
+    , m_bStateDirty(false)
+    , m_nSimSeed(QRandomGenerator::global()->generate64())
+    , m_nSimStep(0)
 {
     // Initialize internal state with default values
     m_internalState.batteryLevel = 100.0f;
@@ -26,6 +64,7 @@ CDrone::CDrone(int trackId, QObject *parent)
     m_internalState.verticalSpeed = 0.0f;
     m_internalState.groundSpeed = 0.0f;
     m_internalState.acceleration = 0.0f;
+    m_internalState.turnRate = 0.0f;
     
     m_internalState.flightMode = FLIGHT_MODE_CRUISE;
     m_internalState.missionId = QString("MISSION-%1").arg(trackId, 3, 10, QChar('0'));
@@ -61,25 +100,11 @@ void CDrone::updateDynamics(const stTrackDisplayInfo &trackInfo)
     calculateDynamics(trackInfo);
     
     // Update internal state based on dynamics
-    m_internalState.groundSpeed = trackInfo.velocity;
-    m_internalState.yaw = trackInfo.heading;
-    m_internalState.acceleration = m_acceleration;
-    m_internalState.verticalSpeed = m_climbRate;
-    
-    // Calculate pitch and roll based on dynamics
-    // Pitch: related to acceleration and climb rate
-    if (m_acceleration != 0) {
-        m_internalState.pitch = qBound(-15.0f, static_cast<float>(m_acceleration * 5.0), 15.0f);
-    } else {
-        m_internalState.pitch = 0.0f;
-    }
-    
-    // Roll: related to bearing change rate (turning)
-    if (m_bearingChangeRate != 0) {
-        m_internalState.roll = qBound(-30.0f, static_cast<float>(m_bearingChangeRate * 3.0), 30.0f);
-    } else {
-        m_internalState.roll = 0.0f;
+    if (!m_bFilteredDynamics) {
+        m_internalState.groundSpeed = trackInfo.velocity;
     }
+    m_internalState.yaw = trackInfo.heading;
+    updateAttitude();
     
     // Update time since last update
     QDateTime currentTime = QDateTime::currentDateTime();
@@ -99,7 +124,7 @@ void CDrone::updateDynamics(const stTrackDisplayInfo &trackInfo)
     
     m_internalState.lastUpdateTime = currentTime;
     
-    emit internalStateChanged();
+    m_bStateDirty = true;
 }
 
 void CDrone::updateInternalState(const stDroneInternalState &state)
@@ -108,7 +133,43 @@ void CDrone::updateInternalState(const stDroneInternalState &state)
     m_internalState.lastUpdateTime = QDateTime::currentDateTime();
     
     checkSystemHealth();
-    emit internalStateChanged();
+    m_bStateDirty = true;
+}
+
+void CDrone::setFilteredDynamics(const stFilteredTrackState &state)
+{
+    m_bFilteredDynamics = true;
+    m_acceleration = state.acceleration;
+    // The filter's course is from North, clockwise; track headings are counter-clockwise
+    // from East, the convention differencing and the roll below use
+    m_bearingChangeRate = -state.turnRate;
+    m_climbRate = state.climbRate;
+    m_internalState.groundSpeed = state.groundSpeed;
+
+    updateAttitude();
+    m_bStateDirty = true;
+}
+
+void CDrone::updateAttitude()
+{
+    m_internalState.acceleration = m_acceleration;
+    m_internalState.turnRate = m_bearingChangeRate;
+    m_internalState.verticalSpeed = m_climbRate;
+
+    // Calculate pitch and roll based on dynamics
+    // Pitch: related to acceleration and climb rate
+    if (m_acceleration != 0) {
+        m_internalState.pitch = qBound(-15.0f, static_cast<float>(m_acceleration * 5.0), 15.0f);
+    } else {
+        m_internalState.pitch = 0.0f;
+    }
+    
+    // Roll: related to bearing change rate (turning)
+    if (m_bearingChangeRate != 0) {
+        m_internalState.roll = qBound(-30.0f, static_cast<float>(m_bearingChangeRate * 3.0), 30.0f);
+    } else {
+        m_internalState.roll = 0.0f;
+    }
 }
 
 void CDrone::calculateDynamics(const stTrackDisplayInfo &trackInfo)
@@ -116,6 +177,15 @@ void CDrone::calculateDynamics(const stTrackDisplayInfo &trackInfo)
     QDateTime currentTime = QDateTime::currentDateTime();
     double deltaTime = m_prevUpdateTime.msecsTo(currentTime) / 1000.0;
     
+    // The filter bank supplies smoothed dynamics, differencing would only add noise
+    if (m_bFilteredDynamics) {
+        m_prevHeading = trackInfo.heading;
+        m_prevVelocity = trackInfo.velocity;
+        m_prevAltitude = trackInfo.alt;
+        m_prevUpdateTime = currentTime;
+        return;
+    }
+    
     if (deltaTime <= 0.001) {
         deltaTime = 0.001; // Prevent division by zero
     }
@@ -187,9 +257,10 @@ void CDrone::checkSystemHealth()
         m_internalState.flightMode = FLIGHT_MODE_RETURN_TO_BASE;
         m_internalState.healthOk = false;
         m_internalState.statusMessage = "LOW BATTERY - RTB";
-        emit emergencyAlert(m_nTrackId, "Low Battery");
+        setEmergency("Low Battery");
         return;
     }
+    setEmergency(QString());
     
     if (m_internalState.batteryLevel < 25.0f) {
         m_internalState.healthOk = false;
@@ -242,6 +313,37 @@ void CDrone::checkSystemHealth()
     }
 }
 
+void CDrone::setEmergency(const QString &reason)
+{
+    if (reason == m_strActiveEmergency) {
+        return;
+    }
+
+    // Only the onset is published; a condition that clears before the flush is dropped
+    m_strActiveEmergency = reason;
+    m_strPendingEmergency = reason;
+}
+
+bool CDrone::collectNotifications(QString *pEmergency)
+{
+    *pEmergency = m_strPendingEmergency;
+    m_strPendingEmergency.clear();
+
+    bool stateChanged = m_bStateDirty;
+    m_bStateDirty = false;
+    return stateChanged;
+}
+
+void CDrone::publishNotifications(bool stateChanged, const QString &emergency)
+{
+    if (!emergency.isEmpty()) {
+        emit emergencyAlert(m_nTrackId, emergency);
+    }
+    if (stateChanged && isSignalConnected(QMetaMethod::fromSignal(&CDrone::internalStateChanged))) {
+        emit internalStateChanged();
+    }
+}
+
 double CDrone::getBearingChangeRate() const
 {
     return m_bearingChangeRate;
@@ -291,35 +393,66 @@ QColor CDrone::getHealthStatusColor() const
 }
 
 void CDrone::simulateRealisticBehavior()
+{
+    simulateStep(m_nSimSeed, m_nSimStep++);
+}
+
+void CDrone::simulateStep(quint64 seed, quint64 step)
 {
     // Simulate random variations in drone behavior for testing
-    QRandomGenerator *rng = QRandomGenerator::global();
+    stCounterRandom rng(seed, m_nTrackId, step);
     
     // Simulate battery drain
     m_internalState.batteryLevel = qMax(0.0f, m_internalState.batteryLevel - 0.1f);
     
     // Simulate sensor variations
-    m_internalState.sensors.gpsQuality = 85 + rng->bounded(15);
-    m_internalState.sensors.linkQuality = 90 + rng->bounded(10);
+    m_internalState.sensors.gpsQuality = 85 + rng.bounded(15);
+    m_internalState.sensors.linkQuality = 90 + rng.bounded(10);
     
     // Simulate environmental changes
-    m_internalState.temperature = 20.0f + rng->bounded(15);
-    m_internalState.windSpeed = rng->bounded(20);
-    m_internalState.windDirection = rng->bounded(360);
+    m_internalState.temperature = 20.0f + rng.bounded(15);
+    m_internalState.windSpeed = rng.bounded(20);
+    m_internalState.windDirection = rng.bounded(360);
     
     // Simulate mission progress
     if (m_internalState.waypointIndex < m_internalState.totalWaypoints) {
-        if (rng->bounded(100) < 5) { // 5% chance to advance waypoint
+        if (rng.bounded(100) < 5) { // 5% chance to advance waypoint
             m_internalState.waypointIndex++;
         }
     }
     
     // Randomly change flight mode (rarely)
-    if (rng->bounded(1000) < 2) { // 0.2% chance
-        int mode = rng->bounded(7);
+    if (rng.bounded(1000) < 2) { // 0.2% chance
+        int mode = rng.bounded(7);
         m_internalState.flightMode = static_cast<eDroneFlightMode>(mode);
     }
     
     checkSystemHealth();
-    emit internalStateChanged();
+    m_bStateDirty = true;
+}
+
+void CDrone::simulateBatch(const QVector<CDrone*> &drones, quint64 seed, quint64 step, bool bParallel)
+{
+    const int nDrones = drones.size();
+    if (!bParallel || nDrones <= kSimChunkSize) {
+        for (CDrone *pDrone : drones) {
+            pDrone->simulateStep(seed, step);
+        }
+        return;
+    }
+
+    // Drones touch only their own state, so chunks need no locking
+    QVector<int> vecChunkStart;
+    vecChunkStart.reserve(nDrones / kSimChunkSize + 1);
+    for (int i = 0; i < nDrones; i += kSimChunkSize) {
+        vecChunkStart.append(i);
+    }
+
+    CDrone *const *ppDrones = drones.constData();
+    QtConcurrent::blockingMap(vecChunkStart, [ppDrones, nDrones, seed, step](int start) {
+        const int end = qMin(start + kSimChunkSize, nDrones);
+        for (int i = start; i < end; ++i) {
+            ppDrones[i]->simulateStep(seed, step);
+        }
+    });
 }
@@ -4,7 +4,9 @@
 #include <QObject>
 #include <QString>
 #include <QDateTime>
+#include <QVector>
 #include "globalstructs.h"
+#include "ctrackfilterbank.h"
 
 /**
  * @brief Flight modes for the drone
@@ -49,6 +51,7 @@ struct stDroneInternalState {
     float verticalSpeed;     //!< Vertical speed in m/s
     float groundSpeed;       //!< Ground speed in m/s
     float acceleration;      //!< Current acceleration in m/s²
+    float turnRate;          //!< Turn rate in degrees per second, positive counter-clockwise like the track heading
     
     // Mission and status
     eDroneFlightMode flightMode;  //!< Current flight mode
@@ -108,6 +111,15 @@ public:
      * @param trackInfo Updated track display information
      */
     void updateDynamics(const stTrackDisplayInfo &trackInfo);
+
+    /**
+     * @brief Feed smoothed kinematics from the track filter bank
+     *
+     * Once called, updateDynamics() stops differencing raw track reports and the
+     * acceleration, turn rate and climb rate come from the filter instead.
+     * @param state Filtered state of this drone's track
+     */
+    void setFilteredDynamics(const stFilteredTrackState &state);
     
     /**
      * @brief Update drone internal state (battery, sensors, etc.)
@@ -141,17 +153,61 @@ public:
     
     /**
      * @brief Simulate realistic drone behavior (for testing)
+     *
+     * Advances simulateStep() with a per-drone seed and step counter.
      */
     void simulateRealisticBehavior();
 
+    /**
+     * @brief Simulation step driven by a counter-based random generator
+     *
+     * Every draw is a hash of (seed, track ID, step, draw index), so the outcome does
+     * not depend on the thread that runs the drone or on the order drones are run in.
+     * @param seed Run seed
+     * @param step Step number
+     */
+    void simulateStep(quint64 seed, quint64 step);
+
+    /**
+     * @brief Advances many drones by one simulation step in parallel chunks
+     *
+     * Equal seeds give bit-identical states at any thread count. Only marks the drones
+     * dirty, notifications go out with the next warehouse cycle.
+     * @param drones Drones to advance, each listed at most once
+     * @param seed Run seed
+     * @param step Step number
+     * @param bParallel Run the chunks on the global thread pool, or inline on the caller
+     */
+    static void simulateBatch(const QVector<CDrone*> &drones, quint64 seed, quint64 step,
+                              bool bParallel = true);
+
+    /**
+     * @brief Takes the notifications accumulated since the last call
+     *
+     * State updates only mark the drone dirty. The data warehouse collects once per
+     * processing cycle under its data lock and publishes after releasing it, so
+     * internalStateChanged() fires at most once per cycle and emergencyAlert() once
+     * per onset.
+     * @param pEmergency Set to the emergency that set in since the last call, else emptied
+     * @return true if the state changed since the last call
+     */
+    bool collectNotifications(QString *pEmergency);
+
+    /**
+     * @brief Emits what collectNotifications() returned, skipping unconnected signals
+     */
+    void publishNotifications(bool stateChanged, const QString &emergency);
+
 signals:
     /**
-     * @brief Emitted when drone internal state changes
+     * @brief Emitted from publishNotifications() when drone internal state changed
      */
     void internalStateChanged();
     
     /**
-     * @brief Emitted when drone enters emergency mode
+     * @brief Emitted from publishNotifications() when an emergency condition sets in
+     *
+     * Edge-triggered: it fires again only after the condition cleared or its reason changed.
      */
     void emergencyAlert(int trackId, QString reason);
 
@@ -169,12 +225,26 @@ private:
     double m_bearingChangeRate;          //!< Bearing change rate (deg/s)
     double m_acceleration;               //!< Acceleration (m/s²)
     double m_climbRate;                  //!< Climb rate (m/s)
+    bool m_bFilteredDynamics;            //!< Dynamics come from setFilteredDynamics()
+
+    // Coalesced notifications, taken by collectNotifications()
+    bool m_bStateDirty;                  //!< State changed since the last flush
+    QString m_strActiveEmergency;        //!< Emergency condition in force, empty when none
+    QString m_strPendingEmergency;       //!< Onset not yet published, empty when none
+
+    quint64 m_nSimSeed;                  //!< Seed of simulateRealisticBehavior()
+    quint64 m_nSimStep;                  //!< Steps taken by simulateRealisticBehavior()
     
     /**
      * @brief Calculate dynamics based on position updates
      * @param trackInfo Current track information
      */
     void calculateDynamics(const stTrackDisplayInfo &trackInfo);
+
+    /**
+     * @brief Derive pitch and roll from the current dynamics
+     */
+    void updateAttitude();
     
     /**
      * @brief Update battery level based on flight dynamics
@@ -186,6 +256,12 @@ private:
      * @brief Check system health and update status
      */
     void checkSystemHealth();
+
+    /**
+     * @brief Records the emergency condition found by checkSystemHealth()
+     * @param reason Condition in force, empty when none
+     */
+    void setEmergency(const QString &reason);
 };
 
 #endif // CDRONE_H
@@ -0,0 +1,816 @@
+#include "cperfbenchmark.h"
+#include "CoordinateConverter.h"
+#include "CoordinateConverterT.h"
+#include "smallmatrix.h"
+#include "ccoveragegrid.h"
+#include "ctrackfilterbank.h"
+#include "cdrone.h"
+#include "MapDisplay/ctracksymbolatlas.h"
+#include "MapDisplay/ctracklabelengine.h"
+#include "matrix.h"
+#include <QElapsedTimer>
+#include <QVector>
+#include <QThreadPool>
+#include <QHash>
+#include <QImage>
+#include <QPainter>
+#include <QDebug>
+#include <cmath>
+#include <cstring>
+
+namespace {
+
+// Keeps the optimiser from discarding benchmark loops
+volatile double g_dBenchmarkSink = 0.0;
+
+// Cmatrix and TMatrix results agree when their largest element difference stays within
+// this fraction of the largest element, i.e. a few thousand ULPs of rounding
+const double kMatrixAgreementRelTol = 1.0e-12;
+
+// Order-dependent hash of the simulated part of every drone's state, bit-exact
+quint64 droneStateChecksum(const QVector<CDrone*> &drones)
+{
+    quint64 h = 1469598103934665603ull;
+    for (const CDrone *pDrone : drones) {
+        stDroneInternalState state = pDrone->getInternalState();
+        float values[4] = { state.batteryLevel, state.temperature, state.windSpeed, state.windDirection };
+        quint32 bits[4];
+        std::memcpy(bits, values, sizeof(bits));
+        const quint64 words[8] = { bits[0], bits[1], bits[2], bits[3],
+                                   quint64(state.sensors.gpsQuality), quint64(state.sensors.linkQuality),
+                                   quint64(state.waypointIndex), quint64(state.flightMode) };
+        for (quint64 w : words) {
+            h = (h ^ w) * 1099511628211ull;
+        }
+    }
+    return h;
+}
+
+double roundTripError(CoordinateConverter &conv, double x, double y, double z,
+                      double lat, double lon, double alt)
+{
+    double xr, yr, zr;
+    conv.geodetic2ecef(lat, lon, alt, &xr, &yr, &zr, 0);
+    return std::sqrt((xr - x) * (xr - x) + (yr - y) * (yr - y) + (zr - z) * (zr - z));
+}
+
+// Geodetic -> ECEF -> ENV -> polar for every sample, returns ns per point
+template<typename T, typename AngleUnit>
+double timeConverterChain(const QVector<T> &vecLat, const QVector<T> &vecLon, const QVector<T> &vecAlt,
+                          T refLat, T refLon, QVector<T> *pVecEnvX)
+{
+    typedef TCoordinateConverter<T, AngleUnit> Conv;
+    const int n = vecLat.size();
+    double sink = 0.0;
+
+    QElapsedTimer timer;
+    timer.start();
+    for (int i = 0; i < n; ++i) {
+        T x, y, z, xe, ye, ze, r, azm, elv;
+        Conv::geodetic2ecef(vecLat[i], vecLon[i], vecAlt[i], &x, &y, &z);
+        Conv::ecef2env(&xe, &ye, &ze, x, y, z, refLat, refLon, T(0));
+        Conv::env2polar(&r, &azm, &elv, xe, ye, ze);
+        sink += r + azm + elv;
+        if (pVecEnvX) {
+            (*pVecEnvX)[i] = xe;
+        }
+    }
+    qint64 ns = timer.nsecsElapsed();
+    g_dBenchmarkSink = sink;
+
+    return n > 0 ? double(ns) / n : 0.0;
+}
+
+}
+
+void CPerfBenchmark::runAll(double lat, double lon, double alt)
+{
+    compareGeodeticSolvers(lat, lon, alt);
+    benchmarkConverterInstantiations();
+    benchmarkSmallMatrix();
+    benchmarkCovarianceBatch();
+    benchmarkCoverageGrid(lat, lon);
+    benchmarkFilterBank();
+    benchmarkDroneSimulation();
+    benchmarkTrackSymbols();
+    benchmarkTrackSymbols(10000, 10);
+    benchmarkLabelLayout();
+}
+
+stGeodeticSolverReport CPerfBenchmark::compareGeodeticSolvers(double lat, double lon, double alt,
+                                                              double maxRange, double maxElevation,
+                                                              int nSteps)
+{
+    stGeodeticSolverReport report = {};
+
+    CoordinateConverter conv;
+    conv.setlp(lat, lon, alt);
+
+    // Sample the coverage volume in polar coordinates and keep the ECEF points
+    QVector<double> vecX, vecY, vecZ;
+    for (int i = 1; i <= nSteps; ++i) {
+        double r = maxRange * i / nSteps;
+        for (int j = 0; j < nSteps; ++j) {
+            double azm = 360.0 * j / nSteps;
+            for (int k = 0; k < nSteps; ++k) {
+                double elv = maxElevation * k / (nSteps - 1 > 0 ? nSteps - 1 : 1);
+                double xe, ye, ze, x, y, z;
+                conv.polar2env(r, azm, elv, &xe, &ye, &ze, 0);
+                conv.env2ecef_lp(xe, ye, ze, &x, &y, &z);
+                vecX.append(x);
+                vecY.append(y);
+                vecZ.append(z);
+            }
+        }
+    }
+    report.nSamples = vecX.size();
+    if (report.nSamples == 0) {
+        return report;
+    }
+
+    // Accuracy
+    double sumSqB = 0.0, sumSqV = 0.0;
+    for (int i = 0; i < report.nSamples; ++i) {
+        double gLat, gLon, gAlt;
+
+        conv.ecef2geodetic_bowring(vecX[i], vecY[i], vecZ[i], &gLat, &gLon, &gAlt);
+        double errB = roundTripError(conv, vecX[i], vecY[i], vecZ[i], gLat, gLon, gAlt);
+
+        conv.ecef2geodetic_vermeille(vecX[i], vecY[i], vecZ[i], &gLat, &gLon, &gAlt);
+        double errV = roundTripError(conv, vecX[i], vecY[i], vecZ[i], gLat, gLon, gAlt);
+
+        report.maxErrBowring = qMax(report.maxErrBowring, errB);
+        report.maxErrVermeille = qMax(report.maxErrVermeille, errV);
+        sumSqB += errB * errB;
+        sumSqV += errV * errV;
+    }
+    report.rmsErrBowring = std::sqrt(sumSqB / report.nSamples);
+    report.rmsErrVermeille = std::sqrt(sumSqV / report.nSamples);
+
+    // Timing, several passes so the loop dominates timer overhead
+    const int nPasses = 20;
+    QElapsedTimer timer;
+    double sink = 0.0;
+
+    timer.start();
+    for (int pass = 0; pass < nPasses; ++pass) {
+        for (int i = 0; i < report.nSamples; ++i) {
+            double gLat, gLon, gAlt;
+            conv.ecef2geodetic_bowring(vecX[i], vecY[i], vecZ[i], &gLat, &gLon, &gAlt);
+            sink += gLat + gLon + gAlt;
+        }
+    }
+    report.nsPerConvBowring = double(timer.nsecsElapsed()) / (double(nPasses) * report.nSamples);
+
+    timer.restart();
+    for (int pass = 0; pass < nPasses; ++pass) {
+        for (int i = 0; i < report.nSamples; ++i) {
+            double gLat, gLon, gAlt;
+            conv.ecef2geodetic_vermeille(vecX[i], vecY[i], vecZ[i], &gLat, &gLon, &gAlt);
+            sink += gLat + gLon + gAlt;
+        }
+    }
+    report.nsPerConvVermeille = double(timer.nsecsElapsed()) / (double(nPasses) * report.nSamples);
+    g_dBenchmarkSink = sink;
+
+    qDebug() << "[CPerfBenchmark] ecef2geodetic over" << report.nSamples << "points,"
+             << maxRange << "m /" << maxElevation << "deg coverage";
+    qDebug() << "  Bowring   : max" << report.maxErrBowring << "m, rms" << report.rmsErrBowring
+             << "m," << report.nsPerConvBowring << "ns/conv";
+    qDebug() << "  Vermeille : max" << report.maxErrVermeille << "m, rms" << report.rmsErrVermeille
+             << "m," << report.nsPerConvVermeille << "ns/conv";
+
+    return report;
+}
+
+stConverterInstantiationReport CPerfBenchmark::benchmarkConverterInstantiations(int nSamples)
+{
+    stConverterInstantiationReport report = {};
+    report.nSamples = nSamples;
+    if (nSamples <= 0) {
+        return report;
+    }
+
+    const double refLat = 13.2716, refLon = 77.2946;
+    const double degToRad = 3.14159265358979323846 / 180.0;
+
+    // Points scattered over roughly +/-8 km around the radar, 0-3 km altitude
+    QVector<double> vecLatD(nSamples), vecLonD(nSamples), vecAltD(nSamples);
+    QVector<double> vecLatR(nSamples), vecLonR(nSamples);
+    QVector<float> vecLatF(nSamples), vecLonF(nSamples), vecAltF(nSamples);
+    QVector<float> vecLatFR(nSamples), vecLonFR(nSamples);
+    for (int i = 0; i < nSamples; ++i) {
+        double u = double(i) / nSamples;
+        vecLatD[i] = refLat + 0.07 * std::sin(u * 97.0);
+        vecLonD[i] = refLon + 0.07 * std::cos(u * 61.0);
+        vecAltD[i] = 3000.0 * u;
+        vecLatR[i] = vecLatD[i] * degToRad;
+        vecLonR[i] = vecLonD[i] * degToRad;
+        vecLatF[i] = float(vecLatD[i]);
+        vecLonF[i] = float(vecLonD[i]);
+        vecAltF[i] = float(vecAltD[i]);
+        vecLatFR[i] = float(vecLatR[i]);
+        vecLonFR[i] = float(vecLonR[i]);
+    }
+
+    // Legacy API, angle unit resolved at runtime on every call
+    CoordinateConverter conv;
+    double sink = 0.0;
+    QElapsedTimer timer;
+    timer.start();
+    for (int i = 0; i < nSamples; ++i) {
+        double x, y, z, xe, ye, ze, r, azm, elv;
+        conv.geodetic2ecef(vecLatD[i], vecLonD[i], vecAltD[i], &x, &y, &z, 0);
+        conv.ecef2env(&xe, &ye, &ze, x, y, z, refLat, refLon, 0.0, 0);
+        conv.env2polar(&r, &azm, &elv, xe, ye, ze);
+        sink += r + azm + elv;
+    }
+    report.nsLegacyRuntime = double(timer.nsecsElapsed()) / nSamples;
+    g_dBenchmarkSink = sink;
+
+    QVector<double> vecEnvD(nSamples);
+    QVector<float> vecEnvF(nSamples);
+    report.nsDoubleDegrees = timeConverterChain<double, AngleDegrees>(vecLatD, vecLonD, vecAltD, refLat, refLon, &vecEnvD);
+    report.nsDoubleRadians = timeConverterChain<double, AngleRadians>(vecLatR, vecLonR, vecAltD, refLat * degToRad, refLon * degToRad, nullptr);
+    report.nsFloatDegrees = timeConverterChain<float, AngleDegrees>(vecLatF, vecLonF, vecAltF, float(refLat), float(refLon), &vecEnvF);
+    report.nsFloatRadians = timeConverterChain<float, AngleRadians>(vecLatFR, vecLonFR, vecAltF, float(refLat * degToRad), float(refLon * degToRad), nullptr);
+
+    for (int i = 0; i < nSamples; ++i) {
+        report.maxErrFloat = qMax(report.maxErrFloat, std::fabs(vecEnvD[i] - double(vecEnvF[i])));
+    }
+
+    qDebug() << "[CPerfBenchmark] geodetic->ECEF->ENV->polar," << nSamples << "points (ns/point)";
+    qDebug() << "  legacy runtime angletype :" << report.nsLegacyRuntime;
+    qDebug() << "  <double, degrees>        :" << report.nsDoubleDegrees;
+    qDebug() << "  <double, radians>        :" << report.nsDoubleRadians;
+    qDebug() << "  <float, degrees>         :" << report.nsFloatDegrees;
+    qDebug() << "  <float, radians>         :" << report.nsFloatRadians
+             << "( max ENV deviation" << report.maxErrFloat << "m )";
+
+    return report;
+}
+
+stSmallMatrixReport CPerfBenchmark::benchmarkSmallMatrix(int nIterations)
+{
+    stSmallMatrixReport report = {};
+    report.nIterations = nIterations;
+    if (nIterations <= 0) {
+        return report;
+    }
+
+    CoordinateConverter conv;
+    Cmatrix mat;
+    QElapsedTimer timer;
+    double sink = 0.0;
+
+    // Polar measurement noise: 10 m range, 1 deg elevation, 0.5 deg azimuth
+    double varPlr[3][3] = {{100.0, 0.0, 0.0},
+                           {0.0, 3.0e-4, 0.0},
+                           {0.0, 0.0, 7.6e-5}};
+
+    // Covariance propagation, the Cmatrix way cov_pos_polar2env used to do it
+    timer.start();
+    for (int it = 0; it < nIterations; ++it) {
+        double r = 1000.0 + (it & 1023), ele = 0.1, azi = 0.001 * (it & 4095);
+        double J[3][3] = {{cos(ele)*sin(azi), -r*sin(ele)*sin(azi),  r*cos(ele)*cos(azi)},
+                          {cos(ele)*cos(azi), -r*sin(ele)*cos(azi), -r*cos(ele)*sin(azi)},
+                          {sin(ele),           r*cos(ele),           0.0}};
+        double JT[3][3], temp[3][3], varEnv[3][3];
+        mat.mat_transpose(*J, *JT, 3, 3);
+        mat.mat_mul(*varPlr, *JT, *temp, 3, 3, 3);
+        mat.mat_mul(*J, *temp, *varEnv, 3, 3, 3);
+        sink += varEnv[0][0] + varEnv[1][2];
+    }
+    report.nsCovPolarCmatrix = double(timer.nsecsElapsed()) / nIterations;
+
+    timer.restart();
+    for (int it = 0; it < nIterations; ++it) {
+        double r = 1000.0 + (it & 1023), ele = 0.1, azi = 0.001 * (it & 4095);
+        double varEnv[3][3];
+        conv.cov_pos_polar2env(varEnv, r, ele, azi, varPlr);
+        sink += varEnv[0][0] + varEnv[1][2];
+    }
+    report.nsCovPolarTMatrix = double(timer.nsecsElapsed()) / nIterations;
+
+    // Agreement of the two covariance paths on one representative point
+    double scaleCov = 0.0, scaleInverse6 = 0.0;
+    {
+        double r = 5000.0, ele = 0.1, azi = 1.2;
+        double J[3][3] = {{cos(ele)*sin(azi), -r*sin(ele)*sin(azi),  r*cos(ele)*cos(azi)},
+                          {cos(ele)*cos(azi), -r*sin(ele)*cos(azi), -r*cos(ele)*sin(azi)},
+                          {sin(ele),           r*cos(ele),           0.0}};
+        double JT[3][3], temp[3][3], varOld[3][3], varNew[3][3];
+        mat.mat_transpose(*J, *JT, 3, 3);
+        mat.mat_mul(*varPlr, *JT, *temp, 3, 3, 3);
+        mat.mat_mul(*J, *temp, *varOld, 3, 3, 3);
+        conv.cov_pos_polar2env(varNew, r, ele, azi, varPlr);
+        for (int i = 0; i < 3; ++i)
+            for (int j = 0; j < 3; ++j) {
+                report.maxDiffCov = qMax(report.maxDiffCov, std::fabs(varOld[i][j] - varNew[i][j]));
+                scaleCov = qMax(scaleCov, std::fabs(varOld[i][j]));
+            }
+    }
+
+    // A well-conditioned 6x6 SPD matrix, the size of a position/velocity covariance
+    Mat6d P6 = Mat6d::identity();
+    for (int i = 0; i < 6; ++i) {
+        for (int j = 0; j < 6; ++j) {
+            P6.m[i][j] += 0.1 / (1.0 + i + j);
+        }
+        P6.m[i][i] += i;
+    }
+    double a6[6][6];
+    P6.toArray(*a6);
+
+    timer.restart();
+    for (int it = 0; it < nIterations; ++it) {
+        double inv[6][6];
+        a6[0][0] = 1.1 + 1.0e-9 * (it & 255);
+        mat.mat_inverse(*a6, *inv, 6);
+        sink += inv[0][0];
+    }
+    report.nsInverse6Cmatrix = double(timer.nsecsElapsed()) / nIterations;
+
+    timer.restart();
+    for (int it = 0; it < nIterations; ++it) {
+        Mat6d inv;
+        P6.m[0][0] = 1.1 + 1.0e-9 * (it & 255);
+        if (inverse(P6, &inv)) {
+            sink += inv.m[0][0];
+        }
+    }
+    report.nsInverse6TMatrix = double(timer.nsecsElapsed()) / nIterations;
+
+    {
+        double invOld[6][6];
+        Mat6d invNew;
+        a6[0][0] = P6.m[0][0] = 1.1;
+        mat.mat_inverse(*a6, *invOld, 6);
+        inverse(P6, &invNew);
+        for (int i = 0; i < 6; ++i)
+            for (int j = 0; j < 6; ++j) {
+                report.maxDiffInverse6 = qMax(report.maxDiffInverse6, std::fabs(invOld[i][j] - invNew.m[i][j]));
+                scaleInverse6 = qMax(scaleInverse6, std::fabs(invOld[i][j]));
+            }
+    }
+    report.agree = report.maxDiffCov <= kMatrixAgreementRelTol * scaleCov &&
+                   report.maxDiffInverse6 <= kMatrixAgreementRelTol * scaleInverse6;
+
+    Mat3d P3 = {{{4.0, 1.0, 0.5}, {1.0, 3.0, 0.2}, {0.5, 0.2, 2.0}}};
+    timer.restart();
+    for (int it = 0; it < nIterations; ++it) {
+        Mat3d inv;
+        P3.m[0][0] = 4.0 + 1.0e-9 * (it & 255);
+        if (inverse3(P3, &inv)) {
+            sink += inv.m[0][0];
+        }
+    }
+    report.nsInverse3TMatrix = double(timer.nsecsElapsed()) / nIterations;
+
+    timer.restart();
+    for (int it = 0; it < nIterations; ++it) {
+        Mat6d L;
+        P6.m[0][0] = 1.1 + 1.0e-9 * (it & 255);
+        if (cholesky(P6, &L)) {
+            sink += L.m[5][5];
+        }
+    }
+    report.nsCholesky6TMatrix = double(timer.nsecsElapsed()) / nIterations;
+    g_dBenchmarkSink = sink;
+
+    qDebug() << "[CPerfBenchmark] small matrix," << nIterations << "iterations (ns/op)";
+    qDebug() << "  cov polar->env  Cmatrix :" << report.nsCovPolarCmatrix
+             << " TMatrix :" << report.nsCovPolarTMatrix << "( max diff" << report.maxDiffCov << ")";
+    qDebug() << "  6x6 inverse     Cmatrix :" << report.nsInverse6Cmatrix
+             << " TMatrix :" << report.nsInverse6TMatrix << "( max diff" << report.maxDiffInverse6 << ")";
+    qDebug() << "  3x3 closed-form inverse :" << report.nsInverse3TMatrix;
+    qDebug() << "  6x6 Cholesky            :" << report.nsCholesky6TMatrix;
+    qDebug() << "  results" << (report.agree ? "agree" : "DIFFER") << "within" << kMatrixAgreementRelTol
+             << "of the largest element";
+
+    return report;
+}
+
+stCovarianceBatchReport CPerfBenchmark::benchmarkCovarianceBatch(int nTracks, int nCycles)
+{
+    stCovarianceBatchReport report = {};
+    report.nTracks = nTracks;
+    report.nCycles = nCycles;
+    if (nTracks <= 0 || nCycles <= 0) {
+        return report;
+    }
+
+    CoordinateConverter conv;
+    conv.setlp(13.2716, 77.2946, 0.0);
+
+    // Tracks on a spiral through the coverage, up to 8 km range
+    QVector<double> vecX(nTracks), vecY(nTracks), vecZ(nTracks), vecAlt(nTracks);
+    for (int i = 0; i < nTracks; ++i) {
+        double r = 200.0 + 7800.0 * i / nTracks;
+        double azi = 0.37 * i, ele = 0.02 + 0.5 * (i % 17) / 17.0;
+        vecX[i] = r * cos(ele) * sin(azi);
+        vecY[i] = r * cos(ele) * cos(azi);
+        vecZ[i] = r * sin(ele);
+        vecAlt[i] = vecZ[i];
+    }
+
+    // 15 m range, 1 deg elevation, 0.5 deg azimuth, as the warehouse defaults
+    const double varR = 225.0, varEle = 3.0462e-4, varAzi = 7.6154e-5;
+    double varPlr[3][3] = {{varR, 0.0, 0.0}, {0.0, varEle, 0.0}, {0.0, 0.0, varAzi}};
+
+    QVector<double> vecCovScalar(6 * nTracks), vecCovEnv(6 * nTracks), vecCovGeo(6 * nTracks);
+    QElapsedTimer timer;
+    double sink = 0.0;
+
+    timer.start();
+    for (int c = 0; c < nCycles; ++c) {
+        for (int i = 0; i < nTracks; ++i) {
+            double r, azi, ele, varEnv[3][3];
+            conv.env2polar(&r, &azi, &ele, vecX[i], vecY[i], vecZ[i]);
+            conv.cov_pos_polar2env(varEnv, r, ele * PI / 180.0, azi * PI / 180.0, varPlr);
+            double *p = vecCovScalar.data() + 6 * i;
+            p[0] = varEnv[0][0]; p[1] = varEnv[0][1]; p[2] = varEnv[0][2];
+            p[3] = varEnv[1][1]; p[4] = varEnv[1][2]; p[5] = varEnv[2][2];
+        }
+        sink += vecCovScalar[0];
+    }
+    report.usPerCycleScalar = double(timer.nsecsElapsed()) / nCycles / 1000.0;
+
+    timer.restart();
+    for (int c = 0; c < nCycles; ++c) {
+        conv.cov_pos_polar2env_batch(nTracks, vecX.constData(), vecY.constData(), vecZ.constData(),
+                                     varR, varEle, varAzi, vecCovEnv.data());
+        conv.cov_pos_env2geodetic_lp_batch(nTracks, vecAlt.constData(), vecCovEnv.constData(),
+                                           vecCovGeo.data());
+        sink += vecCovGeo[0];
+    }
+    report.usPerCycleBatch = double(timer.nsecsElapsed()) / nCycles / 1000.0;
+    g_dBenchmarkSink = sink;
+
+    for (int i = 0; i < nTracks; ++i) {
+        const double *a = vecCovScalar.constData() + 6 * i;
+        const double *b = vecCovEnv.constData() + 6 * i;
+        double scale = a[0] + a[3] + a[5];
+        for (int k = 0; k < 6; ++k) {
+            report.maxRelDiff = qMax(report.maxRelDiff, std::fabs(a[k] - b[k]) / scale);
+        }
+    }
+
+    qDebug() << "[CPerfBenchmark] covariance cycle," << nTracks << "tracks," << nCycles << "cycles (us/cycle)";
+    qDebug() << "  per-track scalar :" << report.usPerCycleScalar;
+    qDebug() << "  batch ENV + geo  :" << report.usPerCycleBatch
+             << "( max rel diff" << report.maxRelDiff << ")";
+
+    return report;
+}
+
+stCoverageGridBenchReport CPerfBenchmark::benchmarkCoverageGrid(double lat, double lon, double maxRange,
+                                                               double maxError, int nSamples)
+{
+    stCoverageGridBenchReport report = {};
+    report.nSamples = nSamples;
+    if (nSamples <= 0) {
+        return report;
+    }
+
+    CCoverageGrid grid;
+    stCoverageGridReport gridReport = grid.build(lat, lon, 0.0, maxRange, maxRange, maxError);
+    report.cellSize = gridReport.cellSize;
+    report.memoryBytes = gridReport.memoryBytes;
+    report.buildMs = gridReport.buildMs;
+    report.maxErrHorizontal = gridReport.maxErrHorizontal;
+    report.maxErrAltitude = gridReport.maxErrAltitude;
+
+    // Plots scattered through the coverage with a cheap LCG, reproducible run to run
+    QVector<double> vecX(nSamples), vecY(nSamples), vecZ(nSamples);
+    quint32 state = 12345u;
+    for (int i = 0; i < nSamples; ++i) {
+        state = state * 1664525u + 1013904223u;
+        vecX[i] = maxRange * (2.0 * (state >> 8) / 16777216.0 - 1.0);
+        state = state * 1664525u + 1013904223u;
+        vecY[i] = maxRange * (2.0 * (state >> 8) / 16777216.0 - 1.0);
+        state = state * 1664525u + 1013904223u;
+        vecZ[i] = maxRange * ((state >> 8) / 16777216.0);
+    }
+
+    QVector<double> vecLat(nSamples), vecLon(nSamples), vecAlt(nSamples);
+    CoordinateConverter conv;
+    conv.setlp(lat, lon, 0.0);
+    QElapsedTimer timer;
+    double sink = 0.0;
+
+    timer.start();
+    for (int i = 0; i < nSamples; ++i) {
+        conv.env2geodetic_lp(vecX[i], vecY[i], vecZ[i], &vecLat[i], &vecLon[i], &vecAlt[i]);
+    }
+    report.nsPerPlotExact = double(timer.nsecsElapsed()) / nSamples;
+    sink += vecLat[nSamples / 2];
+
+    timer.restart();
+    grid.env2geodeticBatch(nSamples, vecX.constData(), vecY.constData(), vecZ.constData(),
+                           vecLat.data(), vecLon.data(), vecAlt.data());
+    report.nsPerPlotGrid = double(timer.nsecsElapsed()) / nSamples;
+    sink += vecLat[nSamples / 2];
+    g_dBenchmarkSink = sink;
+
+    qDebug() << "[CPerfBenchmark] coverage grid," << nSamples << "plots (ns/plot)";
+    qDebug() << "  exact env2geodetic_lp :" << report.nsPerPlotExact;
+    qDebug() << "  grid lookup           :" << report.nsPerPlotGrid;
+
+    return report;
+}
+
+stFilterBankReport CPerfBenchmark::benchmarkFilterBank(int nTracks, int nCycles)
+{
+    stFilterBankReport report = {};
+    report.nTracks = nTracks;
+    report.nCycles = nCycles;
+    if (nTracks <= 0 || nCycles <= 0) {
+        return report;
+    }
+
+    // Throughput: every track gets a measurement every cycle, 1 s apart
+    CTrackFilterBank bank;
+    QElapsedTimer timer;
+    qint64 nsProcess = 0;
+    for (int c = 0; c <= nCycles; ++c) {
+        qint64 timeMs = 1000 * qint64(c);
+        for (int i = 0; i < nTracks; ++i) {
+            double r = 500.0 + (i % 7500);
+            bank.addMeasurement(i, r + 20.0 * c, 0.5 * r - 5.0 * c, 100.0 + (i & 511), timeMs);
+        }
+        timer.start();
+        bank.process();
+        // The first cycle only initialises, leave it out
+        if (c > 0) {
+            nsProcess += timer.nsecsElapsed();
+        }
+    }
+    report.usPerCycle = nsProcess / 1000.0 / nCycles;
+    report.updatesPerSec = nsProcess > 0 ? double(nTracks) * nCycles * 1.0e9 / nsProcess : 0.0;
+
+    // Accuracy: 25 m/s coordinated turn at 6 deg/s, 15 m position noise, 1 s updates
+    const double speed = 25.0, turnRate = 6.0, sigma = 15.0, dt = 1.0;
+    const double omega = turnRate * PI / 180.0, radius = speed / omega;
+    const int nSteps = 300, nWarmup = 30;
+    CTrackFilterBank turnBank;
+    quint32 state = 4711u;
+    double prevX = 0.0, prevY = 0.0, prevHeading = 0.0;
+    double sumTurnRaw = 0.0, sumTurnFilt = 0.0, sumSpeedRaw = 0.0, sumSpeedFilt = 0.0;
+    int nCounted = 0;
+
+    for (int k = 0; k < nSteps; ++k) {
+        // Box-Muller noise from an LCG, reproducible run to run
+        double noise[2];
+        for (int j = 0; j < 2; ++j) {
+            state = state * 1664525u + 1013904223u;
+            double u1 = ((state >> 8) + 1.0) / 16777217.0;
+            state = state * 1664525u + 1013904223u;
+            double u2 = (state >> 8) / 16777216.0;
+            noise[j] = sigma * std::sqrt(-2.0 * std::log(u1)) * std::cos(2.0 * PI * u2);
+        }
+        // Clockwise circle as seen from above, heading increases at turnRate
+        double theta = omega * k * dt;
+        double x = radius * (1.0 - std::cos(theta)) + noise[0];
+        double y = radius * std::sin(theta) + noise[1];
+
+        turnBank.addMeasurement(1, x, y, 0.0, qint64(k * dt * 1000.0));
+        turnBank.process();
+
+        // The differencing CDrone used to do
+        double rawSpeed = std::sqrt((x - prevX) * (x - prevX) + (y - prevY) * (y - prevY)) / dt;
+        double rawHeading = std::atan2(x - prevX, y - prevY) * 180.0 / PI;
+        double headingDiff = rawHeading - prevHeading;
+        while (headingDiff > 180.0) headingDiff -= 360.0;
+        while (headingDiff < -180.0) headingDiff += 360.0;
+        double rawTurn = headingDiff / dt;
+
+        stFilteredTrackState filtered;
+        if (k >= nWarmup && turnBank.getState(1, &filtered)) {
+            sumTurnRaw += (rawTurn - turnRate) * (rawTurn - turnRate);
+            sumTurnFilt += (filtered.turnRate - turnRate) * (filtered.turnRate - turnRate);
+            sumSpeedRaw += (rawSpeed - speed) * (rawSpeed - speed);
+            sumSpeedFilt += (filtered.groundSpeed - speed) * (filtered.groundSpeed - speed);
+            nCounted++;
+        }
+        prevX = x;
+        prevY = y;
+        prevHeading = rawHeading;
+    }
+    if (nCounted > 0) {
+        report.rmsTurnRateRaw = std::sqrt(sumTurnRaw / nCounted);
+        report.rmsTurnRateFiltered = std::sqrt(sumTurnFilt / nCounted);
+        report.rmsSpeedRaw = std::sqrt(sumSpeedRaw / nCounted);
+        report.rmsSpeedFiltered = std::sqrt(sumSpeedFilt / nCounted);
+    }
+
+    qDebug() << "[CPerfBenchmark] filter bank," << nTracks << "tracks," << nCycles << "cycles";
+    qDebug() << "  process() per cycle :" << report.usPerCycle << "us,"
+             << report.updatesPerSec / 1.0e6 << "M updates/s";
+    qDebug() << "  turn rate rms (deg/s) raw :" << report.rmsTurnRateRaw
+             << " filtered :" << report.rmsTurnRateFiltered;
+    qDebug() << "  speed rms (m/s)       raw :" << report.rmsSpeedRaw
+             << " filtered :" << report.rmsSpeedFiltered;
+
+    return report;
+}
+
+stDroneSimulationReport CPerfBenchmark::benchmarkDroneSimulation(int nDrones, int nSteps, quint64 seed)
+{
+    stDroneSimulationReport report = {};
+    report.nDrones = nDrones;
+    report.nSteps = nSteps;
+    report.nThreads = QThreadPool::globalInstance()->maxThreadCount();
+    if (nDrones <= 0 || nSteps <= 0) {
+        return report;
+    }
+
+    // Two identical populations, one per run
+    QVector<CDrone*> vecInline, vecParallel;
+    for (int i = 0; i < nDrones; ++i) {
+        vecInline.append(new CDrone(i));
+        vecParallel.append(new CDrone(i));
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+    for (int step = 0; step < nSteps; ++step) {
+        CDrone::simulateBatch(vecInline, seed, step, false);
+    }
+    report.msSequential = timer.nsecsElapsed() / 1.0e6;
+
+    timer.start();
+    for (int step = 0; step < nSteps; ++step) {
+        CDrone::simulateBatch(vecParallel, seed, step, true);
+    }
+    report.msParallel = timer.nsecsElapsed() / 1.0e6;
+
+    report.reproducible = droneStateChecksum(vecInline) == droneStateChecksum(vecParallel);
+
+    qDeleteAll(vecInline);
+    qDeleteAll(vecParallel);
+
+    qDebug() << "[CPerfBenchmark] drone simulation," << nDrones << "drones," << nSteps << "steps";
+    qDebug() << "  inline   :" << report.msSequential << "ms";
+    qDebug() << "  parallel :" << report.msParallel << "ms on" << report.nThreads << "threads";
+    qDebug() << "  end states" << (report.reproducible ? "identical" : "DIFFER");
+
+    return report;
+}
+
+stTrackSymbolReport CPerfBenchmark::benchmarkTrackSymbols(int nTracks, int nFrames)
+{
+    stTrackSymbolReport report = {};
+    report.nTracks = nTracks;
+    report.nFrames = nFrames;
+
+    CTrackSymbolAtlas atlas;
+    report.atlasBuildMs = atlas.build();
+    if (nTracks <= 0 || nFrames <= 0) {
+        return report;
+    }
+
+    // Random symbols over a full HD view, every identity, state and heading
+    QVector<QPointF> vecPos(nTracks);
+    QVector<double> vecHeading(nTracks);
+    QVector<int> vecIdentity(nTracks), vecState(nTracks);
+    quint32 lcg = 12345u;
+    for (int i = 0; i < nTracks; ++i) {
+        lcg = lcg * 1664525u + 1013904223u;
+        double x = (lcg >> 8) % 1920;
+        lcg = lcg * 1664525u + 1013904223u;
+        double y = (lcg >> 8) % 1080;
+        lcg = lcg * 1664525u + 1013904223u;
+        vecPos[i] = QPointF(x, y);
+        vecHeading[i] = ((lcg >> 8) % 36000) / 100.0;
+        vecIdentity[i] = i % CTrackSymbolAtlas::kIdentityCount;
+        vecState[i] = (i % 50 == 0) ? CTrackSymbolAtlas::SYMBOL_HIGHLIGHTED : CTrackSymbolAtlas::SYMBOL_NORMAL;
+    }
+
+    QImage frame(1920, 1080, QImage::Format_ARGB32_Premultiplied);
+    QElapsedTimer timer;
+
+    // What CTrackLayer::paint did per track before the atlas
+    QHash<QString, QPixmap> rotatedCache;
+    QHash<QString, QPixmap> iconCache;
+    timer.start();
+    for (int f = 0; f < nFrames; ++f) {
+        frame.fill(Qt::black);
+        QPainter painter(&frame);
+        painter.setRenderHint(QPainter::Antialiasing, true);
+        for (int i = 0; i < nTracks; ++i) {
+            QColor clr = CTrackSymbolAtlas::identityColor(vecIdentity[i]);
+            int baseSize = CTrackSymbolAtlas::symbolSize(vecState[i]);
+            int roundedHeading = static_cast<int>(vecHeading[i] / 5.0) * 5;
+            QString cacheKey = QString("def_%1_%2_%3").arg(baseSize).arg(clr.name()).arg(roundedHeading);
+
+            QPixmap rotated;
+            if (rotatedCache.contains(cacheKey)) {
+                rotated = rotatedCache.value(cacheKey);
+            } else {
+                QString iconKey = QString("%1x%2_%3").arg(baseSize).arg(baseSize).arg(clr.name());
+                if (!iconCache.contains(iconKey)) {
+                    iconCache.insert(iconKey, CTrackSymbolAtlas::renderSymbol(baseSize, clr, Qt::white));
+                }
+                QPixmap icon = iconCache.value(iconKey);
+                QTransform transform;
+                transform.translate(icon.width() / 2.0, icon.height() / 2.0);
+                transform.rotate(-roundedHeading);
+                transform.translate(-icon.width() / 2.0, -icon.height() / 2.0);
+                rotated = icon.transformed(transform, Qt::SmoothTransformation);
+                if (rotatedCache.size() > 500) {
+                    rotatedCache.clear();
+                }
+                rotatedCache.insert(cacheKey, rotated);
+            }
+            painter.drawPixmap(QPointF(vecPos[i].x() - rotated.width() / 2.0,
+                                       vecPos[i].y() - rotated.height() / 2.0), rotated);
+        }
+    }
+    report.msPerFrameLegacy = timer.nsecsElapsed() / 1.0e6 / nFrames;
+
+    timer.start();
+    for (int f = 0; f < nFrames; ++f) {
+        frame.fill(Qt::black);
+        QPainter painter(&frame);
+        painter.setRenderHint(QPainter::Antialiasing, true);
+        for (int i = 0; i < nTracks; ++i) {
+            atlas.addSymbol(vecPos[i], vecIdentity[i], vecState[i], vecHeading[i]);
+        }
+        atlas.drawPending(&painter);
+    }
+    report.msPerFrameAtlas = timer.nsecsElapsed() / 1.0e6 / nFrames;
+
+    qDebug() << "[CPerfBenchmark] track symbols," << nTracks << "tracks," << nFrames << "frames";
+    qDebug() << "  atlas build    :" << report.atlasBuildMs << "ms";
+    qDebug() << "  per-track draw :" << report.msPerFrameLegacy << "ms/frame";
+    qDebug() << "  atlas batch    :" << report.msPerFrameAtlas << "ms/frame";
+
+    return report;
+}
+
+stLabelLayoutReport CPerfBenchmark::benchmarkLabelLayout(int nTracks, int nFrames)
+{
+    stLabelLayoutReport report = {};
+    report.nTracks = nTracks;
+    report.nFrames = nFrames;
+    if (nTracks <= 0 || nFrames <= 0) {
+        return report;
+    }
+
+    // Same random spread as benchmarkTrackSymbols(), a few hostile tracks first in priority
+    QVector<QPointF> vecPos(nTracks);
+    quint32 lcg = 12345u;
+    for (int i = 0; i < nTracks; ++i) {
+        lcg = lcg * 1664525u + 1013904223u;
+        double x = (lcg >> 8) % 1920;
+        lcg = lcg * 1664525u + 1013904223u;
+        double y = (lcg >> 8) % 1080;
+        lcg = lcg * 1664525u + 1013904223u;
+        vecPos[i] = QPointF(x, y);
+    }
+
+    QImage frame(1920, 1080, QImage::Format_ARGB32_Premultiplied);
+    QElapsedTimer timer;
+
+    // What CTrackLayer::paint did per label before the engine
+    timer.start();
+    for (int f = 0; f < nFrames; ++f) {
+        frame.fill(Qt::black);
+        QPainter painter(&frame);
+        painter.setRenderHint(QPainter::Antialiasing, true);
+        for (int i = 0; i < nTracks; ++i) {
+            painter.setFont(QFont("century", 11, 80, true));
+            painter.setPen(Qt::white);
+            painter.drawText(vecPos[i] + QPointF(6, -6), QString::number(1000 + i));
+        }
+    }
+    report.msPerFrameLegacy = timer.nsecsElapsed() / 1.0e6 / nFrames;
+
+    CTrackLabelEngine engine;
+    engine.setMaxLabels(nTracks);
+    double layoutMs = 0.0;
+    timer.start();
+    for (int f = 0; f < nFrames; ++f) {
+        frame.fill(Qt::black);
+        QPainter painter(&frame);
+        painter.setRenderHint(QPainter::Antialiasing, true);
+        engine.begin(frame.size());
+        for (int i = 0; i < nTracks; ++i) {
+            engine.addLabel(1000 + i, vecPos[i], (i % 20 == 0) ? 1 : 0);
+        }
+        layoutMs += engine.layout();
+        engine.draw(&painter, Qt::white);
+    }
+    report.msPerFrameEngine = timer.nsecsElapsed() / 1.0e6 / nFrames;
+    report.msPerFrameLayout = layoutMs / nFrames;
+    report.nPlaced = engine.placedCount();
+
+    qDebug() << "[CPerfBenchmark] track labels," << nTracks << "tracks," << nFrames << "frames";
+    qDebug() << "  per-track drawText :" << report.msPerFrameLegacy << "ms/frame";
+    qDebug() << "  engine layout      :" << report.msPerFrameLayout << "ms/frame,"
+             << report.nPlaced << "placed";
+    qDebug() << "  engine total       :" << report.msPerFrameEngine << "ms/frame";
+
+    return report;
+}
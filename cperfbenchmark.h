@@ -0,0 +1,229 @@
+#ifndef CPERFBENCHMARK_H
+#define CPERFBENCHMARK_H
+
+#include <QtGlobal>
+
+/**
+ * @brief Result of comparing the ecef2geodetic() solvers over a coverage volume
+ *
+ * Errors are round-trip position errors in meters: the solver output is fed back
+ * through geodetic2ecef() and compared with the ECEF input.
+ */
+struct stGeodeticSolverReport {
+    int nSamples;               //!< Number of points sampled in the coverage volume
+    double maxErrBowring;       //!< Max round-trip error, Bowring (m)
+    double rmsErrBowring;       //!< RMS round-trip error, Bowring (m)
+    double maxErrVermeille;     //!< Max round-trip error, Vermeille (m)
+    double rmsErrVermeille;     //!< RMS round-trip error, Vermeille (m)
+    double nsPerConvBowring;    //!< Cost per conversion, Bowring (ns)
+    double nsPerConvVermeille;  //!< Cost per conversion, Vermeille (ns)
+};
+
+/**
+ * @brief Cost of a geodetic -> ECEF -> ENV -> polar chain per converter instantiation (ns/point)
+ */
+struct stConverterInstantiationReport {
+    int nSamples;               //!< Points converted per pass
+    double nsLegacyRuntime;     //!< CoordinateConverter API with runtime angletype
+    double nsDoubleDegrees;     //!< TCoordinateConverter<double, AngleDegrees>
+    double nsDoubleRadians;     //!< TCoordinateConverter<double, AngleRadians>
+    double nsFloatDegrees;      //!< TCoordinateConverter<float, AngleDegrees>
+    double nsFloatRadians;      //!< TCoordinateConverter<float, AngleRadians>
+    double maxErrFloat;         //!< Max ENV deviation of the float chain from double (m)
+};
+
+/**
+ * @brief Cmatrix versus the fixed-size TMatrix templates (ns/operation)
+ */
+struct stSmallMatrixReport {
+    int nIterations;            //!< Operations timed per case
+    double nsCovPolarCmatrix;   //!< 3x3 J*P*J^T through Cmatrix
+    double nsCovPolarTMatrix;   //!< 3x3 J*P*J^T through TMatrix (cov_pos_polar2env)
+    double nsInverse6Cmatrix;   //!< 6x6 inverse, Cmatrix::mat_inverse
+    double nsInverse6TMatrix;   //!< 6x6 inverse, Gauss-Jordan inverse<6>
+    double nsInverse3TMatrix;   //!< 3x3 inverse, closed form inverse3
+    double nsCholesky6TMatrix;  //!< 6x6 Cholesky factorisation
+    double maxDiffCov;          //!< Max element difference of the two covariance paths
+    double maxDiffInverse6;     //!< Max element difference of the two 6x6 inverses
+    bool agree;                 //!< Both differences within 1e-12 of the largest element
+};
+
+/**
+ * @brief Per-track covariance loop versus the batch kernels (time per cycle)
+ */
+struct stCovarianceBatchReport {
+    int nTracks;                //!< Tracks propagated per cycle
+    int nCycles;                //!< Cycles timed
+    double usPerCycleScalar;    //!< env2polar + cov_pos_polar2env per track (us)
+    double usPerCycleBatch;     //!< cov_pos_polar2env_batch + cov_pos_env2geodetic_lp_batch (us)
+    double maxRelDiff;          //!< Max relative difference of the ENV covariances
+};
+
+/**
+ * @brief Coverage grid lookup versus the exact bound-origin conversion
+ */
+struct stCoverageGridBenchReport {
+    double cellSize;            //!< Cell size chosen for the error bound (m)
+    qint64 memoryBytes;         //!< Node storage
+    double buildMs;             //!< Grid build time
+    double maxErrHorizontal;    //!< Max horizontal error at cell centres (m)
+    double maxErrAltitude;      //!< Max altitude error at cell centres (m)
+    int nSamples;               //!< Plots converted per pass
+    double nsPerPlotExact;      //!< env2geodetic_lp per plot
+    double nsPerPlotGrid;       //!< CCoverageGrid::env2geodeticBatch per plot
+};
+
+/**
+ * @brief Throughput of the track filter bank and its smoothing on a turning target
+ */
+struct stFilterBankReport {
+    int nTracks;                //!< Tracks measured every cycle
+    int nCycles;                //!< Cycles timed
+    double usPerCycle;          //!< process() time per cycle (us)
+    double updatesPerSec;       //!< Track updates per second of process() time
+    double rmsTurnRateRaw;      //!< Turn rate error from differencing raw positions (deg/s)
+    double rmsTurnRateFiltered; //!< Turn rate error of the filter (deg/s)
+    double rmsSpeedRaw;         //!< Speed error from differencing raw positions (m/s)
+    double rmsSpeedFiltered;    //!< Speed error of the filter (m/s)
+};
+
+/**
+ * @brief Batched drone simulation, inline versus on the thread pool
+ */
+struct stDroneSimulationReport {
+    int nDrones;                //!< Simulated drones
+    int nSteps;                 //!< Steps timed
+    int nThreads;               //!< Global thread pool size
+    double msSequential;        //!< All steps inline on the caller
+    double msParallel;          //!< All steps in parallel chunks
+    bool reproducible;          //!< Both runs ended in bit-identical states
+};
+
+/**
+ * @brief Default track symbol painting, per-track cached pixmaps versus the atlas batch
+ */
+struct stTrackSymbolReport {
+    int nTracks;                //!< Symbols per frame
+    int nFrames;                //!< Frames timed per path
+    double atlasBuildMs;        //!< CTrackSymbolAtlas::build()
+    double msPerFrameLegacy;    //!< String-keyed rotated pixmap cache and one drawPixmap per track
+    double msPerFrameAtlas;     //!< Atlas rectangles and one drawPixmapFragments per frame
+};
+
+/**
+ * @brief Track number labels on a 1920x1080 raster, per-track drawText against CTrackLabelEngine
+ */
+struct stLabelLayoutReport {
+    int nTracks;                //!< Label candidates per frame
+    int nFrames;                //!< Frames timed per path
+    int nPlaced;                //!< Labels the engine placed without overlap
+    double msPerFrameLegacy;    //!< QFont and QString::number per track, every label drawn
+    double msPerFrameLayout;    //!< Engine layout alone
+    double msPerFrameEngine;    //!< Engine layout and static text draw
+};
+
+/**
+ * @brief CPerfBenchmark - Accuracy harnesses and micro-benchmarks for the hot paths
+ *
+ * Each harness logs a summary through qDebug() in addition to returning the figures.
+ * Starting the application with --benchmark runs them all through runAll() and exits
+ * before any window is created.
+ */
+class CPerfBenchmark
+{
+public:
+    /**
+     * @brief Run every harness with its default sizes around the given radar position
+     * @param lat Radar latitude in degrees
+     * @param lon Radar longitude in degrees
+     * @param alt Radar altitude in meters
+     */
+    static void runAll(double lat, double lon, double alt);
+
+    /**
+     * @brief Compare the geodetic solvers over a radar coverage volume
+     * @param lat Radar latitude in degrees
+     * @param lon Radar longitude in degrees
+     * @param alt Radar altitude in meters
+     * @param maxRange Coverage range in meters
+     * @param maxElevation Coverage elevation in degrees
+     * @param nSteps Samples per axis (range, azimuth, elevation)
+     * @return Accuracy and timing figures for both solvers
+     */
+    static stGeodeticSolverReport compareGeodeticSolvers(double lat, double lon, double alt,
+                                                         double maxRange = 8000.0,
+                                                         double maxElevation = 60.0,
+                                                         int nSteps = 40);
+
+    /**
+     * @brief Time the same conversion chain through each TCoordinateConverter instantiation
+     * @param nSamples Number of points around the default radar position
+     * @return Timing per instantiation and the float precision loss
+     */
+    static stConverterInstantiationReport benchmarkConverterInstantiations(int nSamples = 100000);
+
+    /**
+     * @brief Compare the legacy Cmatrix routines with the TMatrix templates
+     * @param nIterations Operations per case
+     * @return Timing per case and the numerical agreement between the two
+     */
+    static stSmallMatrixReport benchmarkSmallMatrix(int nIterations = 200000);
+
+    /**
+     * @brief Time one covariance cycle over a track population, scalar versus batch
+     * @param nTracks Tracks spread over the radar coverage
+     * @param nCycles Cycles to average over
+     * @return Timing per cycle and the agreement of the two paths
+     */
+    static stCovarianceBatchReport benchmarkCovarianceBatch(int nTracks = 1000, int nCycles = 200);
+
+    /**
+     * @brief Build a coverage grid and time plot conversion through it
+     * @param lat Radar latitude in degrees
+     * @param lon Radar longitude in degrees
+     * @param maxRange Coverage half extent in meters
+     * @param maxError Error bound requested from the grid in meters
+     * @param nSamples Random plots inside the coverage
+     * @return Grid build figures and per-plot cost of both paths
+     */
+    static stCoverageGridBenchReport benchmarkCoverageGrid(double lat, double lon,
+                                                           double maxRange = 8000.0,
+                                                           double maxError = 0.01,
+                                                           int nSamples = 100000);
+
+    /**
+     * @brief Time the filter bank at a track population and check it on a coordinated turn
+     * @param nTracks Tracks, each measured once per cycle
+     * @param nCycles Cycles to average over
+     * @return Throughput and the smoothing against raw differencing
+     */
+    static stFilterBankReport benchmarkFilterBank(int nTracks = 10000, int nCycles = 100);
+
+    /**
+     * @brief Run the same seeded drone simulation inline and in parallel
+     * @param nDrones Drones simulated
+     * @param nSteps Steps per run
+     * @param seed Run seed, shared by both runs
+     * @return Timing of both runs and whether their end states match
+     */
+    static stDroneSimulationReport benchmarkDroneSimulation(int nDrones = 5000, int nSteps = 100,
+                                                            quint64 seed = 20251019);
+
+    /**
+     * @brief Time a frame of default track symbols on a 1920x1080 raster, both paths
+     * @param nTracks Symbols per frame, the figures of interest are 1000 and 10000
+     * @param nFrames Frames per path
+     * @return Atlas build time and time per frame of both paths
+     */
+    static stTrackSymbolReport benchmarkTrackSymbols(int nTracks = 1000, int nFrames = 50);
+
+    /**
+     * @brief Time the track number labels of a frame, both paths
+     * @param nTracks Labels per frame; the layout target is under 2 ms at 1000
+     * @param nFrames Frames per path
+     * @return Time per frame of both paths and the engine's layout share
+     */
+    static stLabelLayoutReport benchmarkLabelLayout(int nTracks = 1000, int nFrames = 50);
+};
+
+#endif // CPERFBENCHMARK_H
@@ -0,0 +1,268 @@
+#include "ctrackfilterbank.h"
+#include <cmath>
+
+namespace {
+
+// Initial uncertainty of the unobserved velocity and acceleration
+const double kInitVarVelocity = 50.0 * 50.0;
+const double kInitVarAcceleration = 10.0 * 10.0;
+
+const double kRadToDeg = 57.295779513082321;
+
+/*
+ * One axis of the constant-acceleration filter for n slots.
+ * Predict: x = F x, P = F P F^T + Q with F = [1 t t²/2; 0 1 t; 0 0 1] and the
+ * white-noise-jerk Q. Update with H = [1 0 0], the gain scaled by g (0 or 1).
+ * Everything is per element and branch-free, and the pointers are restrict
+ * so the loop vectorises without runtime alias checks.
+ */
+void kalmanAxis(int n, const double *__restrict dt, const double *__restrict g,
+                const double *__restrict z, double q, double r,
+                double *__restrict p, double *__restrict v, double *__restrict a,
+                double *__restrict P00, double *__restrict P01, double *__restrict P02,
+                double *__restrict P11, double *__restrict P12, double *__restrict P22)
+{
+    for (int i = 0; i < n; ++i) {
+        double t = dt[i];
+        double h = 0.5 * t * t;
+        double t3 = t * t * t;
+
+        // State prediction
+        double pp = p[i] + t * v[i] + h * a[i];
+        double vp = v[i] + t * a[i];
+        double ap = a[i];
+
+        // Covariance prediction
+        double p00 = P00[i], p01 = P01[i], p02 = P02[i];
+        double p11 = P11[i], p12 = P12[i], p22 = P22[i];
+        double f00 = p00 + 2.0 * t * p01 + 2.0 * h * p02 + t * t * p11 + 2.0 * t * h * p12 + h * h * p22
+                     + q * t3 * t * t / 20.0;
+        double f01 = p01 + t * p02 + t * p11 + (t * t + h) * p12 + t * h * p22 + q * t3 * t / 8.0;
+        double f02 = p02 + t * p12 + h * p22 + q * t3 / 6.0;
+        double f11 = p11 + 2.0 * t * p12 + t * t * p22 + q * t3 / 3.0;
+        double f12 = p12 + t * p22 + q * h;
+        double f22 = p22 + q * t;
+
+        // Measurement update
+        double sInv = g[i] / (f00 + r);
+        double k0 = f00 * sInv, k1 = f01 * sInv, k2 = f02 * sInv;
+        double y = z[i] - pp;
+
+        p[i] = pp + k0 * y;
+        v[i] = vp + k1 * y;
+        a[i] = ap + k2 * y;
+        P00[i] = f00 - k0 * f00;
+        P01[i] = f01 - k0 * f01;
+        P02[i] = f02 - k0 * f02;
+        P11[i] = f11 - k1 * f01;
+        P12[i] = f12 - k1 * f02;
+        P22[i] = f22 - k2 * f02;
+    }
+}
+
+} // namespace
+
+CTrackFilterBank::CTrackFilterBank()
+    : m_dJerkDensity(1.0), m_dMaxCoastSec(10.0)
+{
+    setMeasurementNoise(15.0, 30.0);
+}
+
+void CTrackFilterBank::setProcessNoise(double jerkDensity)
+{
+    m_dJerkDensity = jerkDensity;
+}
+
+void CTrackFilterBank::setMeasurementNoise(double sigmaHorizontal, double sigmaVertical)
+{
+    m_dVar[0] = m_dVar[1] = sigmaHorizontal * sigmaHorizontal;
+    m_dVar[2] = sigmaVertical * sigmaVertical;
+}
+
+void CTrackFilterBank::setMaxCoastTime(double seconds)
+{
+    m_dMaxCoastSec = seconds;
+}
+
+int CTrackFilterBank::allocSlot(int trackId)
+{
+    int slot;
+    if (!m_vecFreeSlots.isEmpty()) {
+        slot = m_vecFreeSlots.takeLast();
+    } else {
+        // Append one slot to every array, zeroed so the kernel leaves it alone
+        slot = m_vecSlotTrackId.size();
+        for (int k = 0; k < 3; ++k) {
+            stAxisArrays &ax = m_axis[k];
+            ax.z.append(0.0);
+            ax.p.append(0.0); ax.v.append(0.0); ax.a.append(0.0);
+            ax.P00.append(0.0); ax.P01.append(0.0); ax.P02.append(0.0);
+            ax.P11.append(0.0); ax.P12.append(0.0); ax.P22.append(0.0);
+        }
+        m_vecDt.append(0.0);
+        m_vecGain.append(0.0);
+        m_vecLastTimeMs.append(0);
+        m_vecMeasTimeMs.append(0);
+        m_vecUpdates.append(0);
+        m_vecSlotTrackId.append(-1);
+        m_vecPending.append(0);
+    }
+
+    m_vecSlotTrackId[slot] = trackId;
+    m_vecUpdates[slot] = 0;
+    m_vecPending[slot] = 0;
+    m_hashSlots.insert(trackId, slot);
+    return slot;
+}
+
+void CTrackFilterBank::initSlot(int slot)
+{
+    for (int k = 0; k < 3; ++k) {
+        stAxisArrays &ax = m_axis[k];
+        ax.p[slot] = ax.z[slot];
+        ax.v[slot] = 0.0;
+        ax.a[slot] = 0.0;
+        ax.P00[slot] = m_dVar[k];
+        ax.P11[slot] = kInitVarVelocity;
+        ax.P22[slot] = kInitVarAcceleration;
+        ax.P01[slot] = ax.P02[slot] = ax.P12[slot] = 0.0;
+    }
+    m_vecLastTimeMs[slot] = m_vecMeasTimeMs[slot];
+    m_vecUpdates[slot] = 1;
+}
+
+void CTrackFilterBank::addMeasurement(int trackId, double x, double y, double z, qint64 timeMs)
+{
+    int slot = m_hashSlots.value(trackId, -1);
+    if (slot < 0) {
+        slot = allocSlot(trackId);
+    }
+
+    m_axis[0].z[slot] = x;
+    m_axis[1].z[slot] = y;
+    m_axis[2].z[slot] = z;
+    m_vecMeasTimeMs[slot] = timeMs;
+
+    if (!m_vecPending[slot]) {
+        m_vecPending[slot] = 1;
+        m_vecPendingSlots.append(slot);
+    }
+}
+
+int CTrackFilterBank::process()
+{
+    m_vecUpdatedIds.resize(0);
+    if (m_vecPendingSlots.isEmpty()) {
+        return 0;
+    }
+
+    // Arm the slots with a measurement; first contacts and long gaps start over
+    bool anyFiltered = false;
+    for (int slot : m_vecPendingSlots) {
+        double dt = (m_vecMeasTimeMs[slot] - m_vecLastTimeMs[slot]) / 1000.0;
+        if (m_vecUpdates[slot] == 0 || dt < 0.0 || dt > m_dMaxCoastSec) {
+            initSlot(slot);
+        } else {
+            m_vecDt[slot] = dt;
+            m_vecGain[slot] = 1.0;
+            anyFiltered = true;
+        }
+    }
+
+    if (anyFiltered) {
+        const int n = m_vecSlotTrackId.size();
+        for (int k = 0; k < 3; ++k) {
+            stAxisArrays &ax = m_axis[k];
+            kalmanAxis(n, m_vecDt.constData(), m_vecGain.constData(), ax.z.constData(),
+                       m_dJerkDensity, m_dVar[k],
+                       ax.p.data(), ax.v.data(), ax.a.data(),
+                       ax.P00.data(), ax.P01.data(), ax.P02.data(),
+                       ax.P11.data(), ax.P12.data(), ax.P22.data());
+        }
+    }
+
+    // Disarm, so the next pass leaves these slots alone unless measured again
+    for (int slot : m_vecPendingSlots) {
+        if (m_vecGain[slot] != 0.0) {
+            m_vecUpdates[slot]++;
+            m_vecLastTimeMs[slot] = m_vecMeasTimeMs[slot];
+        }
+        m_vecDt[slot] = 0.0;
+        m_vecGain[slot] = 0.0;
+        m_vecPending[slot] = 0;
+        m_vecUpdatedIds.append(m_vecSlotTrackId[slot]);
+    }
+    m_vecPendingSlots.resize(0);
+
+    return m_vecUpdatedIds.size();
+}
+
+bool CTrackFilterBank::getState(int trackId, stFilteredTrackState *pState) const
+{
+    int slot = m_hashSlots.value(trackId, -1);
+    if (slot < 0 || m_vecUpdates[slot] == 0) {
+        return false;
+    }
+
+    for (int k = 0; k < 3; ++k) {
+        pState->pos[k] = m_axis[k].p[slot];
+        pState->vel[k] = m_axis[k].v[slot];
+        pState->acc[k] = m_axis[k].a[slot];
+    }
+
+    double vE = pState->vel[0], vN = pState->vel[1];
+    double aE = pState->acc[0], aN = pState->acc[1];
+    double speed2 = vE * vE + vN * vN;
+
+    pState->groundSpeed = std::sqrt(speed2);
+    pState->heading = std::atan2(vE, vN) * kRadToDeg;
+    if (pState->heading < 0.0) pState->heading += 360.0;
+    pState->climbRate = pState->vel[2];
+
+    // Along-track and turning components of the horizontal acceleration; below
+    // walking speed the heading is noise, so no turn is reported
+    if (speed2 > 1.0) {
+        pState->acceleration = (vE * aE + vN * aN) / pState->groundSpeed;
+        pState->turnRate = (vN * aE - vE * aN) / speed2 * kRadToDeg;
+    } else {
+        pState->acceleration = 0.0;
+        pState->turnRate = 0.0;
+    }
+    pState->nUpdates = m_vecUpdates[slot];
+    return true;
+}
+
+void CTrackFilterBank::removeTrack(int trackId)
+{
+    int slot = m_hashSlots.value(trackId, -1);
+    if (slot < 0) {
+        return;
+    }
+
+    m_hashSlots.remove(trackId);
+    m_vecSlotTrackId[slot] = -1;
+    m_vecUpdates[slot] = 0;
+    if (m_vecPending[slot]) {
+        m_vecPending[slot] = 0;
+        m_vecPendingSlots.removeOne(slot);
+    }
+    m_vecFreeSlots.append(slot);
+}
+
+void CTrackFilterBank::clear()
+{
+    for (int k = 0; k < 3; ++k) {
+        m_axis[k] = stAxisArrays();
+    }
+    m_vecDt.clear();
+    m_vecGain.clear();
+    m_vecLastTimeMs.clear();
+    m_vecMeasTimeMs.clear();
+    m_vecUpdates.clear();
+    m_vecSlotTrackId.clear();
+    m_vecPending.clear();
+    m_hashSlots.clear();
+    m_vecFreeSlots.clear();
+    m_vecPendingSlots.clear();
+    m_vecUpdatedIds.clear();
+}
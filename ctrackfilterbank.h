@@ -0,0 +1,120 @@
+#ifndef CTRACKFILTERBANK_H
+#define CTRACKFILTERBANK_H
+
+#include <QHash>
+#include <QVector>
+
+/**
+ * @brief Smoothed kinematics of one track, ENV frame (X East, Y North, Z Vertical)
+ */
+struct stFilteredTrackState {
+    double pos[3];              //!< Position (m)
+    double vel[3];              //!< Velocity (m/s)
+    double acc[3];              //!< Acceleration (m/s²)
+    double groundSpeed;         //!< Horizontal speed (m/s)
+    double heading;             //!< Course over ground, degrees from North [0, 360)
+    double acceleration;        //!< Along-track horizontal acceleration (m/s²)
+    double turnRate;            //!< Rate of change of heading (deg/s), positive clockwise as heading is from North
+    double climbRate;           //!< Vertical speed (m/s)
+    int nUpdates;               //!< Measurements absorbed since (re)initialisation
+};
+
+/**
+ * @brief CTrackFilterBank - Kalman filters for every track, batched across tracks
+ *
+ * Each track runs a constant-acceleration (white-noise jerk) Kalman filter per ENV
+ * axis. The state and covariance of all tracks live in per-axis arrays indexed by a
+ * slot, so predict and update are one branch-free loop over contiguous memory that
+ * the compiler vectorises. Tracks without a new measurement take part with a zero
+ * time step and a zero gain, which leaves them unchanged.
+ *
+ * Turn rate comes from the smoothed horizontal velocity and acceleration
+ * (heading rate = (vN aE - vE aN) / |v|²), which follows coordinated turns without
+ * the coupled non-linear model a constant-turn filter would need.
+ *
+ * Measurements are staged with addMeasurement() as they arrive and absorbed by
+ * process(), once per processing cycle. Not thread-safe, the owner serialises access.
+ */
+class CTrackFilterBank
+{
+public:
+    CTrackFilterBank();
+
+    /**
+     * @brief Sets the process noise
+     * @param jerkDensity Spectral density of the jerk ((m/s³)²/Hz), higher follows manoeuvres faster
+     */
+    void setProcessNoise(double jerkDensity);
+
+    /**
+     * @brief Sets the 1-sigma position measurement noise
+     * @param sigmaHorizontal East and North noise (m)
+     * @param sigmaVertical Vertical noise (m)
+     */
+    void setMeasurementNoise(double sigmaHorizontal, double sigmaVertical);
+
+    /**
+     * @brief Sets the gap after which a track is re-initialised instead of predicted
+     * @param seconds Longest time between two measurements that is still filtered
+     */
+    void setMaxCoastTime(double seconds);
+
+    /**
+     * @brief Stages an ENV position measurement, the latest per track wins until process()
+     * @param trackId Track ID
+     * @param x East (m)
+     * @param y North (m)
+     * @param z Vertical (m)
+     * @param timeMs Measurement time, milliseconds since epoch
+     */
+    void addMeasurement(int trackId, double x, double y, double z, qint64 timeMs);
+
+    /**
+     * @brief Runs predict and update for every staged measurement
+     * @return Number of tracks updated, their IDs are in updatedTracks()
+     */
+    int process();
+
+    const QVector<int> &updatedTracks() const { return m_vecUpdatedIds; }
+
+    /**
+     * @brief Smoothed state of a track
+     * @return false if the track is unknown or has not absorbed a measurement yet
+     */
+    bool getState(int trackId, stFilteredTrackState *pState) const;
+
+    void removeTrack(int trackId);
+    void clear();
+    int trackCount() const { return m_hashSlots.size(); }
+
+private:
+    // Per-axis filter arrays, indexed by slot
+    struct stAxisArrays {
+        QVector<double> z;                      //!< Staged measurement
+        QVector<double> p, v, a;                //!< State
+        QVector<double> P00, P01, P02, P11, P12, P22; //!< Covariance, upper triangle
+    };
+
+    stAxisArrays m_axis[3];
+    QVector<double> m_vecDt;                    //!< Time step of the pending update, 0 otherwise
+    QVector<double> m_vecGain;                  //!< 1 for slots with a measurement to absorb, 0 otherwise
+    QVector<qint64> m_vecLastTimeMs;            //!< Time of the last absorbed measurement
+    QVector<qint64> m_vecMeasTimeMs;            //!< Time of the staged measurement
+    QVector<int> m_vecUpdates;                  //!< Measurements absorbed per slot
+    QVector<int> m_vecSlotTrackId;              //!< Track in each slot, -1 when free
+    QVector<char> m_vecPending;                 //!< Slot has a staged measurement
+
+    QHash<int, int> m_hashSlots;                //!< Track ID -> slot
+    QVector<int> m_vecFreeSlots;
+    QVector<int> m_vecPendingSlots;
+    QVector<int> m_vecUpdatedIds;
+
+    double m_dJerkDensity;
+    double m_dVar[3];                           //!< Measurement variance per axis (m²)
+    double m_dMaxCoastSec;
+
+    int allocSlot(int trackId);
+    void initSlot(int slot);
+};
+
+#endif // CTRACKFILTERBANK_H
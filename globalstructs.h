@@ -51,11 +51,20 @@ struct stTrackDisplayInfo {
     double snr;                 //!< SNR
     int nTrackIden;
     long long nTrackTime;
+    long long nUpdateTimeMs;    //!< Time of the last report, milliseconds since epoch
+    double lonRate;             //!< Longitude rate from velocity and heading (deg/s)
+    double latRate;             //!< Latitude rate from velocity and heading (deg/s)
     QString tooltip;  // ADD THIS LINE
     QString imagePath;          //!< Optional image path for custom track/drone icon
     QList<stTrackHistoryPoint> historyPoints;  //!< Track history points
     bool showHistory;           //!< Flag to show/hide history trail
     CDrone* pDrone;             //!< Pointer to associated drone object (nullptr if not a drone)
+    bool hasCovariance;         //!< True when the fields below are valid for this update
+    double covEnv[6];           //!< ENV position covariance (m^2), upper triangle EE EN EV NN NV VV
+    double covGeo[6];           //!< Geodetic covariance, lon/lat in deg, alt in m, same ordering
+    double ellipseMajor;        //!< 1-sigma semi-major axis of the horizontal ellipse (deg)
+    double ellipseMinor;        //!< 1-sigma semi-minor axis of the horizontal ellipse (deg)
+    double ellipseAngle;        //!< Major axis orientation, degrees counter-clockwise from East
 
     // Equality operator
     bool operator==(const stTrackDisplayInfo &other) const {
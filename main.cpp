@@ -13,6 +13,8 @@
 #include "qgsapplication.h"
 #include "MapDisplay/cgismapcontroller.h"
 #include "globalmacros.h"
+#include "cperfbenchmark.h"
+#include "cdatawarehouse.h"
 
 int main(int argc, char *argv[])
 {
@@ -35,6 +37,13 @@ int main(int argc, char *argv[])
     qDebug() << "©️  COPYRIGHT: Zoppler Systems";
     qDebug() << "🖥️  DUAL MONITOR SUPPORT: ENABLED";
 
+    // Performance harnesses only, no window is created
+    if (app.arguments().contains("--benchmark")) {
+        QPointF radarPos = CDataWarehouse::getInstance()->getRadarPos();
+        CPerfBenchmark::runAll(radarPos.y(), radarPos.x(), 0.0);
+        return 0;
+    }
+
     // Create splash screen with Zoppler branding
     QPixmap splashPixmap(600, 400);
     splashPixmap.fill(Qt::black);
@@ -0,0 +1,253 @@
+#ifndef SMALLMATRIX_H
+#define SMALLMATRIX_H
+
+#include <cmath>
+
+/*
+ * Fixed-size matrix and vector templates for the 3x3 and 6x6 work in covariance
+ * propagation and filtering.
+ *
+ * Dimensions are template parameters, so every loop has compile-time bounds and is
+ * unrolled/vectorised by the compiler. All operations are free functions on values:
+ * there is no scratch state, so unlike Cmatrix they are reentrant and thread-safe.
+ * Storage is row-major, element (i, j) is m[i][j].
+ *
+ * Results agree with the Cmatrix routines to within floating-point rounding, not bit
+ * for bit: CPerfBenchmark::benchmarkSmallMatrix() checks that the covariance and 6x6
+ * inverse paths differ by at most 1e-12 of the largest element.
+ */
+
+template<typename T, int R, int C>
+struct TMatrix
+{
+    T m[R][C];
+
+    inline T &operator()(int i, int j) { return m[i][j]; }
+    inline const T &operator()(int i, int j) const { return m[i][j]; }
+
+    static inline TMatrix zero()
+    {
+        TMatrix a;
+        for (int i = 0; i < R; ++i)
+            for (int j = 0; j < C; ++j)
+                a.m[i][j] = T(0);
+        return a;
+    }
+
+    static inline TMatrix identity()
+    {
+        TMatrix a = zero();
+        for (int i = 0; i < R && i < C; ++i)
+            a.m[i][i] = T(1);
+        return a;
+    }
+
+    /** @brief Copy from a row-major array such as double[R][C] */
+    static inline TMatrix fromArray(const T *p)
+    {
+        TMatrix a;
+        for (int i = 0; i < R; ++i)
+            for (int j = 0; j < C; ++j)
+                a.m[i][j] = p[i*C + j];
+        return a;
+    }
+
+    /** @brief Copy to a row-major array such as double[R][C] */
+    inline void toArray(T *p) const
+    {
+        for (int i = 0; i < R; ++i)
+            for (int j = 0; j < C; ++j)
+                p[i*C + j] = m[i][j];
+    }
+};
+
+template<typename T, int N>
+using TVector = TMatrix<T, N, 1>;
+
+typedef TMatrix<double, 3, 3> Mat3d;
+typedef TMatrix<double, 6, 6> Mat6d;
+typedef TVector<double, 3> Vec3d;
+typedef TVector<double, 6> Vec6d;
+
+template<typename T, int R, int N, int C>
+inline TMatrix<T, R, C> operator*(const TMatrix<T, R, N> &a, const TMatrix<T, N, C> &b)
+{
+    TMatrix<T, R, C> c;
+    for (int i = 0; i < R; ++i) {
+        for (int j = 0; j < C; ++j) {
+            T sum = T(0);
+            for (int k = 0; k < N; ++k)
+                sum += a.m[i][k] * b.m[k][j];
+            c.m[i][j] = sum;
+        }
+    }
+    return c;
+}
+
+template<typename T, int R, int C>
+inline TMatrix<T, R, C> operator+(const TMatrix<T, R, C> &a, const TMatrix<T, R, C> &b)
+{
+    TMatrix<T, R, C> c;
+    for (int i = 0; i < R; ++i)
+        for (int j = 0; j < C; ++j)
+            c.m[i][j] = a.m[i][j] + b.m[i][j];
+    return c;
+}
+
+template<typename T, int R, int C>
+inline TMatrix<T, R, C> operator-(const TMatrix<T, R, C> &a, const TMatrix<T, R, C> &b)
+{
+    TMatrix<T, R, C> c;
+    for (int i = 0; i < R; ++i)
+        for (int j = 0; j < C; ++j)
+            c.m[i][j] = a.m[i][j] - b.m[i][j];
+    return c;
+}
+
+template<typename T, int R, int C>
+inline TMatrix<T, R, C> operator*(T s, const TMatrix<T, R, C> &a)
+{
+    TMatrix<T, R, C> c;
+    for (int i = 0; i < R; ++i)
+        for (int j = 0; j < C; ++j)
+            c.m[i][j] = s * a.m[i][j];
+    return c;
+}
+
+template<typename T, int R, int C>
+inline TMatrix<T, C, R> transpose(const TMatrix<T, R, C> &a)
+{
+    TMatrix<T, C, R> t;
+    for (int i = 0; i < R; ++i)
+        for (int j = 0; j < C; ++j)
+            t.m[j][i] = a.m[i][j];
+    return t;
+}
+
+/** @brief J * P * J^T, the covariance propagation through a Jacobian J */
+template<typename T, int R, int N>
+inline TMatrix<T, R, R> propagate(const TMatrix<T, R, N> &J, const TMatrix<T, N, N> &P)
+{
+    return J * (P * transpose(J));
+}
+
+/** @brief J^T * P * J, propagation through the transpose (e.g. ECEF -> ENV with an ENV -> ECEF rotation) */
+template<typename T, int N, int R>
+inline TMatrix<T, R, R> propagateTransposed(const TMatrix<T, N, R> &J, const TMatrix<T, N, N> &P)
+{
+    return transpose(J) * (P * J);
+}
+
+/** @brief Closed-form 2x2 inverse, returns false if singular */
+template<typename T>
+inline bool inverse2(const TMatrix<T, 2, 2> &a, TMatrix<T, 2, 2> *pInv)
+{
+    T det = a.m[0][0]*a.m[1][1] - a.m[0][1]*a.m[1][0];
+    if (det == T(0)) return false;
+    T r = T(1) / det;
+    pInv->m[0][0] =  a.m[1][1]*r;  pInv->m[0][1] = -a.m[0][1]*r;
+    pInv->m[1][0] = -a.m[1][0]*r;  pInv->m[1][1] =  a.m[0][0]*r;
+    return true;
+}
+
+/** @brief Closed-form 3x3 inverse (adjugate / determinant), returns false if singular */
+template<typename T>
+inline bool inverse3(const TMatrix<T, 3, 3> &a, TMatrix<T, 3, 3> *pInv)
+{
+    T c00 = a.m[1][1]*a.m[2][2] - a.m[1][2]*a.m[2][1];
+    T c01 = a.m[1][2]*a.m[2][0] - a.m[1][0]*a.m[2][2];
+    T c02 = a.m[1][0]*a.m[2][1] - a.m[1][1]*a.m[2][0];
+    T det = a.m[0][0]*c00 + a.m[0][1]*c01 + a.m[0][2]*c02;
+    if (det == T(0)) return false;
+    T r = T(1) / det;
+
+    pInv->m[0][0] = c00*r;
+    pInv->m[0][1] = (a.m[0][2]*a.m[2][1] - a.m[0][1]*a.m[2][2])*r;
+    pInv->m[0][2] = (a.m[0][1]*a.m[1][2] - a.m[0][2]*a.m[1][1])*r;
+    pInv->m[1][0] = c01*r;
+    pInv->m[1][1] = (a.m[0][0]*a.m[2][2] - a.m[0][2]*a.m[2][0])*r;
+    pInv->m[1][2] = (a.m[0][2]*a.m[1][0] - a.m[0][0]*a.m[1][2])*r;
+    pInv->m[2][0] = c02*r;
+    pInv->m[2][1] = (a.m[0][1]*a.m[2][0] - a.m[0][0]*a.m[2][1])*r;
+    pInv->m[2][2] = (a.m[0][0]*a.m[1][1] - a.m[0][1]*a.m[1][0])*r;
+    return true;
+}
+
+/** @brief General NxN inverse by Gauss-Jordan with partial pivoting, returns false if singular */
+template<typename T, int N>
+inline bool inverse(const TMatrix<T, N, N> &a, TMatrix<T, N, N> *pInv)
+{
+    TMatrix<T, N, N> w = a;
+    TMatrix<T, N, N> inv = TMatrix<T, N, N>::identity();
+
+    for (int k = 0; k < N; ++k) {
+        int piv = k;
+        T best = std::fabs(w.m[k][k]);
+        for (int i = k + 1; i < N; ++i) {
+            T v = std::fabs(w.m[i][k]);
+            if (v > best) { best = v; piv = i; }
+        }
+        if (best == T(0)) return false;
+
+        if (piv != k) {
+            for (int j = 0; j < N; ++j) {
+                T t = w.m[k][j];   w.m[k][j] = w.m[piv][j];     w.m[piv][j] = t;
+                t = inv.m[k][j];   inv.m[k][j] = inv.m[piv][j]; inv.m[piv][j] = t;
+            }
+        }
+
+        T r = T(1) / w.m[k][k];
+        for (int j = 0; j < N; ++j) {
+            w.m[k][j] *= r;
+            inv.m[k][j] *= r;
+        }
+        for (int i = 0; i < N; ++i) {
+            if (i == k) continue;
+            T f = w.m[i][k];
+            for (int j = 0; j < N; ++j) {
+                w.m[i][j] -= f * w.m[k][j];
+                inv.m[i][j] -= f * inv.m[k][j];
+            }
+        }
+    }
+
+    *pInv = inv;
+    return true;
+}
+
+template<typename T>
+inline bool inverse(const TMatrix<T, 2, 2> &a, TMatrix<T, 2, 2> *pInv) { return inverse2(a, pInv); }
+
+template<typename T>
+inline bool inverse(const TMatrix<T, 3, 3> &a, TMatrix<T, 3, 3> *pInv) { return inverse3(a, pInv); }
+
+/**
+ * @brief Cholesky factorisation P = L * L^T of a symmetric positive-definite matrix
+ * @return false if P is not positive definite
+ */
+template<typename T, int N>
+inline bool cholesky(const TMatrix<T, N, N> &P, TMatrix<T, N, N> *pL)
+{
+    TMatrix<T, N, N> L = TMatrix<T, N, N>::zero();
+
+    for (int j = 0; j < N; ++j) {
+        T d = P.m[j][j];
+        for (int k = 0; k < j; ++k)
+            d -= L.m[j][k] * L.m[j][k];
+        if (d <= T(0)) return false;
+        L.m[j][j] = std::sqrt(d);
+
+        T r = T(1) / L.m[j][j];
+        for (int i = j + 1; i < N; ++i) {
+            T s = P.m[i][j];
+            for (int k = 0; k < j; ++k)
+                s -= L.m[i][k] * L.m[j][k];
+            L.m[i][j] = s * r;
+        }
+    }
+
+    *pL = L;
+    return true;
+}
+
+#endif // SMALLMATRIX_H